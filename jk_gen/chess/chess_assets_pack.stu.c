@@ -0,0 +1,8 @@
+#define JK_PUBLIC static
+#define JK_GLOBAL_DECLARE static
+#define JK_GLOBAL_DEFINE static
+#include <jk_src/chess/chess_assets_pack.c>
+#include <jk_src/jk_lib/platform/platform.c>
+#include <jk_src/jk_shapes/jk_shapes.c>
+#include <jk_src/stb/stb_truetype.c>
+#include <jk_src/jk_lib/jk_lib.c>
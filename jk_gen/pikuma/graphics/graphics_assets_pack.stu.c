@@ -0,0 +1,11 @@
+#define JK_PUBLIC static
+#define JK_GLOBAL_DECLARE static
+#define JK_GLOBAL_DEFINE static
+#include <jk_src/pikuma/graphics/graphics_assets_pack.c>
+#include <jk_src/jk_lib/gzip/gzip.c>
+#include <jk_src/jk_lib/hash_table/hash_table.c>
+#include <jk_src/jk_lib/platform/platform.c>
+#include <jk_src/jk_shapes/jk_shapes.c>
+#include <jk_src/pikuma/graphics/graphics.c>
+#include <jk_src/stb/stb_truetype.c>
+#include <jk_src/jk_lib/jk_lib.c>
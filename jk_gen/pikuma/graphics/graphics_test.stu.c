@@ -0,0 +1,8 @@
+#define JK_PUBLIC static
+#define JK_GLOBAL_DECLARE static
+#define JK_GLOBAL_DEFINE static
+#include <jk_src/pikuma/graphics/graphics_test.c>
+#include <jk_src/jk_lib/platform/platform.c>
+#include <jk_src/pikuma/graphics/graphics.c>
+#include <jk_src/jk_lib/jk_lib.c>
+#include <jk_src/jk_shapes/jk_shapes.c>
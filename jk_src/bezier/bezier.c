@@ -44,16 +44,6 @@ static JkColor blend(JkColor a, JkColor b) {
     return (JkColor){.r = a.r / 2 + b.r / 2, .g = a.g / 2 + b.g / 2, .b = a.b / 2 + b.b / 2};
 }
 
-static JkColor blend_alpha(JkColor foreground, JkColor background, uint8_t alpha) {
-    JkColor result = {0, 0, 0, 255};
-    for (uint8_t i = 0; i < 3; i++) {
-        result.v[i] = ((int32_t)foreground.v[i] * (int32_t)alpha
-                              + background.v[i] * (255 - (int32_t)alpha))
-                / 255;
-    }
-    return result;
-}
-
 void bezier_render(JkContext *context, ChessAssets *assets, Bezier *bezier) {
     jk_context = context;
 
@@ -98,41 +88,25 @@ void bezier_render(JkContext *context, ChessAssets *assets, Bezier *bezier) {
                     color_light_squares);
         }
 
-        JkShapesDrawCommandArray draw_commands = jk_shapes_draw_commands_get(&renderer);
-
-        JkIntVec2 pos;
-        int32_t cs = 0;
-        int32_t ce = 0;
-        for (pos.y = 0; pos.y < bezier->draw_square_side_length; pos.y++) {
-            while (ce < draw_commands.count && draw_commands.e[ce].rect.min.y <= pos.y) {
-                ce++;
-            }
-            while (cs < draw_commands.count && !(pos.y < draw_commands.e[cs].rect.max.y)) {
-                cs++;
+        JkShapesTiles tiles = jk_shapes_tiles_get(&renderer,
+                (JkIntVec2){bezier->draw_square_side_length, bezier->draw_square_side_length});
+        b32 tile_hashes_valid = jk_int_vec2_equal(tiles.dimensions, bezier->tile_dimensions);
+        bezier->tile_dimensions = tiles.dimensions;
+        for (int64_t i = 0; i < (int64_t)tiles.counts.x * tiles.counts.y; i++) {
+            // The background never changes, so a tile only needs redrawing when its commands do
+            if (tile_hashes_valid && bezier->tile_hashes[i] == tiles.hashes[i]) {
+                continue;
             }
+            bezier->tile_hashes[i] = tiles.hashes[i];
 
-            for (pos.x = 0; pos.x < bezier->draw_square_side_length; pos.x++) {
-                JkColor color = color_dark_squares;
-                for (int32_t i = cs; i < ce; i++) {
-                    JkShapesDrawCommand *command = draw_commands.e + i;
-                    if (command->rect.min.x <= pos.x && pos.x < command->rect.max.x
-                            && pos.y < command->rect.max.y) {
-                        uint8_t alpha;
-                        if (command->alpha_map) {
-                            JkIntVec2 bitmap_pos =
-                                    jk_int_vec2_sub(pos, draw_commands.e[i].rect.min);
-                            int32_t width = command->rect.max.x - command->rect.min.x;
-                            int32_t index = bitmap_pos.y * width + bitmap_pos.x;
-                            alpha = command->alpha_map[index];
-                        } else {
-                            alpha = command->color.a;
-                        }
-                        color = blend_alpha(command->color, color_dark_squares, alpha);
-                        break;
-                    }
+            JkIntRect rect = jk_shapes_tile_rect_get(&tiles, i);
+            for (JkIntVec2 pos = rect.min; pos.y < rect.max.y; pos.y++) {
+                for (pos.x = rect.min.x; pos.x < rect.max.x; pos.x++) {
+                    bezier->draw_buffer[pos.y * DRAW_BUFFER_SIDE_LENGTH + pos.x] =
+                            color_dark_squares;
                 }
-                bezier->draw_buffer[pos.y * DRAW_BUFFER_SIDE_LENGTH + pos.x] = color;
             }
+            jk_shapes_tile_composite(&tiles, i, bezier->draw_buffer, DRAW_BUFFER_SIDE_LENGTH);
         }
     }
 }
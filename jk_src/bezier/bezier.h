@@ -12,6 +12,9 @@
 #define CLEAR_COLOR_G 0x20
 #define CLEAR_COLOR_R 0x16
 
+#define TILES_PER_SIDE_MAX (DRAW_BUFFER_SIDE_LENGTH / JK_SHAPES_TILE_SIDE_LENGTH)
+#define TILE_COUNT_MAX (TILES_PER_SIDE_MAX * TILES_PER_SIDE_MAX)
+
 typedef struct Bezier {
     uint64_t time;
     int32_t draw_square_side_length;
@@ -19,6 +22,11 @@ typedef struct Bezier {
     int64_t cpu_timer_frequency;
     uint64_t (*cpu_timer_get)(void);
     void (*debug_print)(char *);
+
+    // What each tile of the draw buffer was last drawn with, so unchanged tiles can be skipped
+    JkIntVec2 tile_dimensions;
+    uint64_t tile_hashes[TILE_COUNT_MAX];
+
     uint8_t memory[512ll * 1024 * 1024];
 } Bezier;
 
@@ -1533,7 +1533,7 @@ static TextLayout text_layout_get(ChessAssets *assets, JkBuffer text, float scal
 static void draw_text(
         JkShapesRenderer *renderer, JkBuffer text, JkVec2 cursor, float scale, JkColor color) {
     for (int64_t i = 0; i < text.size; i++) {
-        cursor.x += jk_shapes_draw(
+        cursor.x += jk_shapes_sdf_draw(
                 renderer, text.data[i] + CHARACTER_SHAPE_OFFSET, cursor, scale, color);
     }
 }
@@ -1804,6 +1804,7 @@ void render(ChessAssets *assets, Chess *chess) {
             == 0) {
         return;
     }
+    b32 resized = state.square_side_length != chess->render_state_prev.square_side_length;
     chess->render_state_prev = state;
 
     JkIntVec2 pos;
@@ -1848,6 +1849,35 @@ void render(ChessAssets *assets, Chess *chess) {
     float square_size = 64.0f;
     float pixels_per_unit = (float)state.square_side_length / square_size;
     jk_shapes_renderer_init(&renderer, pixels_per_unit, assets, shapes, &arena);
+    if (chess->atlas_memory.size) {
+        if (!chess->atlas.pixels) {
+            jk_shapes_atlas_init(&chess->atlas,
+                    (JkIntVec2){ATLAS_SIDE_LENGTH, ATLAS_SIDE_LENGTH},
+                    chess->atlas_memory);
+        }
+        jk_shapes_renderer_atlas_attach(&renderer, &chess->atlas);
+
+        // A new square size misses on every cached piece bitmap, so rasterize the pieces at their
+        // usual scales as one batch instead of one at a time as they get drawn. Text is drawn from
+        // SDF glyphs that serve every scale, so those only miss if they were never generated or
+        // got evicted.
+        if (resized) {
+            float piece_scales[] = {1.0f, 0.5f};
+            JkShapesBitmapRequest requests[JK_ARRAY_COUNT(piece_scales) * PIECE_TYPE_COUNT + 95];
+            JkShapesBitmapRequestArray request_array = {.e = requests};
+            for (int64_t i = 0; i < JK_ARRAY_COUNT(piece_scales); i++) {
+                for (int64_t piece_type = 1; piece_type < PIECE_TYPE_COUNT; piece_type++) {
+                    requests[request_array.count++] = (JkShapesBitmapRequest){
+                        .shape_index = piece_type, .scale = piece_scales[i]};
+                }
+            }
+            for (int64_t glyph = 0; glyph < 95; glyph++) {
+                requests[request_array.count++] =
+                        (JkShapesBitmapRequest){.shape_index = PIECE_TYPE_COUNT + glyph, .sdf = 1};
+            }
+            jk_shapes_prewarm(&renderer, request_array);
+        }
+    }
 
     JkColor square_colors[10][10];
 
@@ -1923,7 +1953,7 @@ void render(ChessAssets *assets, Chess *chess) {
                 (square_size * 9.0f) + padding_bottom,
             };
             for (int64_t i = 0; i < JK_ARRAY_COUNT(cursor_ys); i++) {
-                jk_shapes_draw(&renderer,
+                jk_shapes_sdf_draw(&renderer,
                         shape_id,
                         (JkVec2){cursor_x, cursor_ys[i]},
                         coords_scale,
@@ -1947,7 +1977,7 @@ void render(ChessAssets *assets, Chess *chess) {
             JkColor color = color_light_squares;
             color.a = 200;
             for (int64_t i = 0; i < JK_ARRAY_COUNT(cursor_xs); i++) {
-                jk_shapes_draw(&renderer,
+                jk_shapes_sdf_draw(&renderer,
                         shape_id,
                         (JkVec2){cursor_xs[i], cursor_y},
                         coords_scale,
@@ -1993,7 +2023,7 @@ void render(ChessAssets *assets, Chess *chess) {
                     JkShape *shape = assets->shapes + shape_index;
                     digit_pos.x = raw_x + 0.5f * (width - timer_scale * shape->dimensions.x)
                             - timer_scale * shape->offset.x;
-                    jk_shapes_draw(
+                    jk_shapes_sdf_draw(
                             &renderer, shape_index, digit_pos, timer_scale, color_light_squares);
                     raw_x += width;
                 }
@@ -2288,22 +2318,12 @@ void render(ChessAssets *assets, Chess *chess) {
     } break;
     }
 
-    JkShapesDrawCommandArray draw_commands = jk_shapes_draw_commands_get(&renderer);
-
-    int64_t cs = 0;
-    int64_t ce = 0;
+    // Fill in the squares, then composite the vector drawing over them
     JkIntVec2 pos_in_square;
     JkIntVec2 square_pos;
     JkIntVec2 mouse_square_pos = jk_int_vec2_div(state.square_side_length, state.mouse_pos);
     for (pos.y = 0, pos_in_square.y = 0, square_pos.y = 0; pos.y < state.square_side_length * 10;
             pos.y++) {
-        while (ce < draw_commands.count && draw_commands.e[ce].rect.min.y <= pos.y) {
-            ce++;
-        }
-        while (cs < draw_commands.count && !(pos.y < draw_commands.e[cs].rect.max.y)) {
-            cs++;
-        }
-
         for (pos.x = 0, pos_in_square.x = 0, square_pos.x = 0;
                 pos.x < state.square_side_length * 10;
                 pos.x++) {
@@ -2325,25 +2345,6 @@ void render(ChessAssets *assets, Chess *chess) {
                 }
             }
 
-            for (int64_t i = cs; i < ce; i++) {
-                JkShapesDrawCommand *command = draw_commands.e + i;
-                if (command->rect.min.x <= pos.x && pos.x < command->rect.max.x
-                        && pos.y < command->rect.max.y) {
-                    uint8_t alpha;
-                    if (command->alpha_map) {
-                        JkIntVec2 pos_in_rect = jk_int_vec2_sub(pos, command->rect.min);
-                        int32_t width = (command->rect.max.x - command->rect.min.x);
-                        uint8_t bitmap_alpha =
-                                command->alpha_map[pos_in_rect.y * width + pos_in_rect.x];
-                        alpha = color_multiply(command->color.a, bitmap_alpha);
-                    } else {
-                        alpha = command->color.a;
-                    }
-                    color = blend_alpha(command->color, color, alpha);
-                    break;
-                }
-            }
-
             color.a = 255;
             chess->draw_buffer[pos.y * DRAW_BUFFER_SIDE_LENGTH + pos.x] = color;
 
@@ -2359,20 +2360,26 @@ void render(ChessAssets *assets, Chess *chess) {
         }
     }
 
+    JkShapesTiles tiles = jk_shapes_tiles_get(&renderer,
+            (JkIntVec2){state.square_side_length * 10, state.square_side_length * 10});
+    for (int64_t i = 0; i < (int64_t)tiles.counts.x * tiles.counts.y; i++) {
+        jk_shapes_tile_composite(&tiles, i, chess->draw_buffer, DRAW_BUFFER_SIDE_LENGTH);
+    }
+
     if (holding_piece) {
         Piece piece = board_piece_get_index(state.board, state.selected_index);
         JkShapesBitmap bitmap = jk_shapes_bitmap_get(&renderer, piece.type, 1.0f);
         if (bitmap.data) {
             JkIntVec2 held_piece_offset = jk_int_vec2_sub(state.mouse_pos,
                     (JkIntVec2){state.square_side_length / 2, state.square_side_length / 2});
-            for (pos.y = 0; pos.y < bitmap.dimensions.x; pos.y++) {
-                for (pos.x = 0; pos.x < bitmap.dimensions.y; pos.x++) {
+            for (pos.y = 0; pos.y < bitmap.dimensions.y; pos.y++) {
+                for (pos.x = 0; pos.x < bitmap.dimensions.x; pos.x++) {
                     JkIntVec2 screen_pos = jk_int_vec2_add(pos, held_piece_offset);
                     if (screen_in_bounds(state.square_side_length, screen_pos)) {
                         int32_t index = screen_pos.y * DRAW_BUFFER_SIDE_LENGTH + screen_pos.x;
                         JkColor color_piece = color_teams[piece.team];
                         JkColor color_bg = chess->draw_buffer[index];
-                        uint8_t alpha = bitmap.data[pos.y * bitmap.dimensions.x + pos.x];
+                        uint8_t alpha = bitmap.data[pos.y * bitmap.stride + pos.x];
                         chess->draw_buffer[index] = blend_alpha(color_piece, color_bg, alpha);
                     }
                 }
@@ -2402,8 +2409,8 @@ void render(ChessAssets *assets, Chess *chess) {
         JkRandomGeneratorU64 generator = jk_random_generator_new_u64(0x516950f73ccfff53);
 
         int32_t skip = 1 + (state.square_side_length * 2 / 100);
-        for (pos.y = 0; pos.y < bitmap.dimensions.x; pos.y += skip) {
-            for (pos.x = 0; pos.x < bitmap.dimensions.y; pos.x += skip) {
+        for (pos.y = 0; pos.y < bitmap.dimensions.y; pos.y += skip) {
+            for (pos.x = 0; pos.x < bitmap.dimensions.x; pos.x += skip) {
                 uint64_t rand64 = jk_random_u64(&generator);
                 JkIntVec2 rand_offset_i = {
                     (int32_t)(rand64 % 256) - 128, (uint32_t)((rand64 >> 32) % 256) - 128};
@@ -2418,7 +2425,7 @@ void render(ChessAssets *assets, Chess *chess) {
                 JkVec2 pixel_dest = jk_vec2_add(pixel_pos, delta);
                 JkVec2 prev_dest = jk_vec2_add(pixel_pos, prev_delta);
 
-                piece_color.a = bitmap.data[pos.y * bitmap.dimensions.x + pos.x];
+                piece_color.a = bitmap.data[pos.y * bitmap.stride + pos.x];
                 if (piece_color.a) {
                     draw_line(chess,
                             piece_color,
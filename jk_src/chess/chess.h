@@ -144,6 +144,11 @@ typedef enum ChessFlag {
 #define DRAW_BUFFER_SIDE_LENGTH 4096ll
 #define DRAW_BUFFER_SIZE (JK_SIZEOF(JkColor) * DRAW_BUFFER_SIDE_LENGTH * DRAW_BUFFER_SIDE_LENGTH)
 
+// Piece and glyph bitmaps are cached across frames in an atlas of this size. Memory past the
+// atlas pixels holds its shelves and hash table.
+#define ATLAS_SIDE_LENGTH 2048
+#define ATLAS_MEMORY_SIZE (ATLAS_SIDE_LENGTH * ATLAS_SIDE_LENGTH + 1 * JK_MEGABYTE)
+
 #define CLEAR_COLOR_B 0x27
 #define CLEAR_COLOR_G 0x20
 #define CLEAR_COLOR_R 0x16
@@ -274,6 +279,7 @@ typedef struct Chess {
     int32_t square_side_length;
     JkColor *draw_buffer;
     JkBuffer render_memory;
+    JkBuffer atlas_memory; // Optional, ATLAS_MEMORY_SIZE
     AiResponse ai_response;
     int64_t time;
     uint64_t audio_time;
@@ -304,6 +310,7 @@ typedef struct Chess {
     AudioState audio_state;
     JkRandomGeneratorU64 generator;
     RenderState render_state_prev;
+    JkShapesAtlas atlas;
 } Chess;
 
 typedef void AiInitFunction(
@@ -7,6 +7,7 @@
 
 // #jk_build dependencies_begin
 #include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/jk_shapes/jk_shapes.h>
 #include <jk_src/stb/stb_truetype.h>
 // #jk_build dependencies_end
 
@@ -181,6 +182,12 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
 
             assets->shapes[piece_index].commands.size =
                     storage.pos - assets->shapes[piece_index].commands.offset;
+
+            // Pieces get drawn as large as a board square, so they get every edge level
+            jk_shapes_edges_pack(&storage,
+                    storage.memory.data,
+                    assets->shapes + piece_index,
+                    JK_SHAPES_EDGE_LEVEL_COUNT);
         }
     }
 
@@ -281,6 +288,9 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
                 } break;
                 }
             }
+
+            // Text is drawn from SDF glyphs, which the first two levels are already fine enough for
+            jk_shapes_edges_pack(&storage, storage.memory.data, shape, 2);
         }
     }
 
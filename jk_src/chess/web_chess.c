@@ -69,14 +69,17 @@ static b32 ensure_memory(int64_t required_memory) {
 
 uint8_t *init_main(void) {
     g_chess.render_memory.size = 2 * JK_MEGABYTE;
+    g_chess.atlas_memory.size = ATLAS_MEMORY_SIZE;
     JkBuffer log_memory = {.size = 1 * JK_MEGABYTE};
-    if (ensure_memory(DRAW_BUFFER_SIZE + g_chess.render_memory.size + log_memory.size)) {
+    if (ensure_memory(DRAW_BUFFER_SIZE + g_chess.render_memory.size + g_chess.atlas_memory.size
+                + log_memory.size)) {
         g_chess.draw_buffer = (JkColor *)__heap_base;
         g_chess.render_memory.data = __heap_base + DRAW_BUFFER_SIZE;
+        g_chess.atlas_memory.data = g_chess.render_memory.data + g_chess.render_memory.size;
         g_chess.os_timer_frequency = 1000;
 
         // Setup context
-        log_memory.data = __heap_base + DRAW_BUFFER_SIZE + g_chess.render_memory.size;
+        log_memory.data = g_chess.atlas_memory.data + g_chess.atlas_memory.size;
         static JkContext c;
         c.log = jk_log_init(debug_print, log_memory);
         jk_context = &c;
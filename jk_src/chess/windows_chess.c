@@ -725,9 +725,11 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
     g_audio_buffer_size =
             jk_round_up_to_power_of_2(2 * SAMPLES_PER_SECOND * JK_SIZEOF(AudioSample));
     g_chess.render_memory.size = 2 * JK_MEGABYTE;
+    g_chess.atlas_memory.size = ATLAS_MEMORY_SIZE;
     g_ai_memory.size = 1 * JK_GIGABYTE;
     uint8_t *memory = VirtualAlloc(0,
-            g_audio_buffer_size + DRAW_BUFFER_SIZE + g_chess.render_memory.size + g_ai_memory.size,
+            g_audio_buffer_size + DRAW_BUFFER_SIZE + g_chess.render_memory.size
+                    + g_chess.atlas_memory.size + g_ai_memory.size,
             MEM_COMMIT,
             PAGE_READWRITE);
     if (!memory) {
@@ -739,6 +741,8 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
     memory += DRAW_BUFFER_SIZE;
     g_chess.render_memory.data = memory;
     memory += g_chess.render_memory.size;
+    g_chess.atlas_memory.data = memory;
+    memory += g_chess.atlas_memory.size;
     g_ai_memory.data = memory;
 
     g_chess.os_timer_frequency = jk_platform_os_timer_frequency();
@@ -29,6 +29,11 @@ JK_PUBLIC int32_t jk_atomic_add(int32_t volatile *pointer, int32_t value) {
     return _InterlockedExchangeAdd((long volatile *)pointer, value);
 }
 
+JK_PUBLIC int64_t jk_atomic_compare_exchange_64(
+        int64_t volatile *pointer, int64_t expected, int64_t desired) {
+    return _InterlockedCompareExchange64((__int64 volatile *)pointer, desired, expected);
+}
+
 #elif defined(__GNUC__) || defined(__clang__)
 
 JK_PUBLIC int64_t jk_count_leading_zeros(uint64_t value) {
@@ -59,6 +64,11 @@ JK_PUBLIC int32_t jk_atomic_add(int32_t volatile *pointer, int32_t value) {
     return __sync_fetch_and_add(pointer, value);
 }
 
+JK_PUBLIC int64_t jk_atomic_compare_exchange_64(
+        int64_t volatile *pointer, int64_t expected, int64_t desired) {
+    return __sync_val_compare_and_swap(pointer, expected, desired);
+}
+
 #endif
 
 // ---- Compiler-specific implementations end ----------------------------------
@@ -99,6 +109,14 @@ JK_PUBLIC JkI256 jk_i256_sub_i32(JkI256 a, JkI256 b) {
     return (JkI256){_mm256_sub_epi32(a.v, b.v)};
 }
 
+JK_PUBLIC JkI256 jk_i256_mul_i32(JkI256 a, JkI256 b) {
+    return (JkI256){_mm256_mullo_epi32(a.v, b.v)};
+}
+
+JK_PUBLIC JkI256 jk_i32x8_load_u8(void *pointer) {
+    return (JkI256){_mm256_cvtepu8_epi32(_mm_loadl_epi64(pointer))};
+}
+
 JK_PUBLIC JkI256 __jk_i256_shift_left_i32(JkI256 x, int32_t bit_count) {
     return (JkI256){_mm256_slli_epi32(x.v, bit_count)};
 }
@@ -148,6 +166,10 @@ JK_PUBLIC JkF32x8 jk_f32x8_div(JkF32x8 a, JkF32x8 b) {
     return (JkF32x8){_mm256_div_ps(a.v, b.v)};
 }
 
+JK_PUBLIC JkF32x8 jk_f32x8_sqrt(JkF32x8 x) {
+    return (JkF32x8){_mm256_sqrt_ps(x.v)};
+}
+
 JK_PUBLIC JkF32x8 jk_f32x8_reciprocal_approx(JkF32x8 x) {
     return (JkF32x8){_mm256_rcp_ps(x.v)};
 }
@@ -173,6 +195,15 @@ JK_PUBLIC JkF32x8 jk_f32x8_lerp(JkF32x8 a, JkF32x8 b, JkF32x8 t) {
             jk_f32x8_mul(jk_f32x8_sub(jk_f32x8_broadcast(1), t), a), jk_f32x8_mul(t, b));
 }
 
+// Scans each 128-bit half with two shift-and-adds, then adds the low half's total to the high half
+JK_PUBLIC JkF32x8 jk_f32x8_prefix_sum(JkF32x8 x) {
+    __m256 v = x.v;
+    v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 4)));
+    v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 8)));
+    __m256 half_totals = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+    return (JkF32x8){_mm256_add_ps(v, _mm256_permute2f128_ps(half_totals, half_totals, 0x08))};
+}
+
 JK_PUBLIC JkF32x8 jk_f32x8_and(JkF32x8 a, JkF32x8 b) {
     return (JkF32x8){_mm256_and_ps(a.v, b.v)};
 }
@@ -222,20 +253,220 @@ JK_PUBLIC JkI256 jk_i32x8_from_f32x8_truncate(JkF32x8 x) {
     return (JkI256){_mm256_cvttps_epi32(x.v)};
 }
 
+// Masks are kept as full vectors with the sign bit deciding each lane, matching JkF32x8, rather
+// than as AVX-512 mask registers. Everything here sticks to AVX-512F.
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_and(JkI512 a, JkI512 b) {
+    return (JkI512){_mm512_and_si512(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_or(JkI512 a, JkI512 b) {
+    return (JkI512){_mm512_or_si512(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_broadcast_i32(int32_t value) {
+    return (JkI512){_mm512_set1_epi32(value)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_add_i32(JkI512 a, JkI512 b) {
+    return (JkI512){_mm512_add_epi32(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_sub_i32(JkI512 a, JkI512 b) {
+    return (JkI512){_mm512_sub_epi32(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_left_i32(JkI512 x, int32_t bit_count) {
+    return (JkI512){_mm512_slli_epi32(x.v, bit_count)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_right_zero_fill_i32(JkI512 x, int32_t bit_count) {
+    return (JkI512){_mm512_srli_epi32(x.v, bit_count)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_right_sign_fill_i32(JkI512 x, int32_t bit_count) {
+    return (JkI512){_mm512_srai_epi32(x.v, bit_count)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_zero(void) {
+    return (JkF32x16){_mm512_setzero_ps()};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_broadcast(float value) {
+    return (JkF32x16){_mm512_set1_ps(value)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_load(void *pointer) {
+    return (JkF32x16){_mm512_loadu_ps(pointer)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC void jk_f32x16_store(void *pointer, JkF32x16 x) {
+    _mm512_storeu_ps(pointer, x.v);
+}
+
+// Truncates offset
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_gather(void *pointer, JkI512 offsets) {
+    return (JkF32x16){_mm512_i32gather_ps(offsets.v, pointer, 4)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_add(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_add_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_sub(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_sub_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_mul(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_mul_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_div(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_div_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_reciprocal_approx(JkF32x16 x) {
+    return (JkF32x16){_mm512_rcp14_ps(x.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_floor(JkF32x16 x) {
+    return (JkF32x16){_mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_min(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_min_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_max(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_max_ps(a.v, b.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_abs(JkF32x16 x) {
+    return (JkF32x16){_mm512_abs_ps(x.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_lerp(JkF32x16 a, JkF32x16 b, JkF32x16 t) {
+    return jk_f32x16_add(
+            jk_f32x16_mul(jk_f32x16_sub(jk_f32x16_broadcast(1), t), a), jk_f32x16_mul(t, b));
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_and(JkF32x16 a, JkF32x16 b) {
+    return jk_f32x16_from_i512_reinterpret(
+            jk_i512_and(jk_i512_from_f32x16_reinterpret(a), jk_i512_from_f32x16_reinterpret(b)));
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_or(JkF32x16 a, JkF32x16 b) {
+    return jk_f32x16_from_i512_reinterpret(
+            jk_i512_or(jk_i512_from_f32x16_reinterpret(a), jk_i512_from_f32x16_reinterpret(b)));
+}
+
+// ~a & b
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_andnot(JkF32x16 a, JkF32x16 b) {
+    return (JkF32x16){_mm512_castsi512_ps(
+            _mm512_andnot_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v)))};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_less_than(JkF32x16 a, JkF32x16 b) {
+    __mmask16 mask = _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ);
+    return (JkF32x16){_mm512_castsi512_ps(_mm512_maskz_mov_epi32(mask, _mm512_set1_epi32(-1)))};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_to_mask(JkF32x16 x) {
+    return x;
+}
+
+static JK_TARGET_AVX512 __mmask16 jk_f32x16_sign_bits(JkF32x16 x) {
+    return _mm512_cmplt_epi32_mask(_mm512_castps_si512(x.v), _mm512_setzero_si512());
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_blend(
+        JkF32x16 false_value, JkF32x16 true_value, JkF32x16 mask) {
+    return (JkF32x16){
+        _mm512_mask_blend_ps(jk_f32x16_sign_bits(mask), false_value.v, true_value.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC b32 jk_f32x16_any(JkF32x16 x) {
+    return jk_f32x16_sign_bits(x) != 0;
+}
+
+JK_TARGET_AVX512 JK_PUBLIC b32 jk_f32x16_all(JkF32x16 x) {
+    return jk_f32x16_sign_bits(x) == 0xffff;
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_from_i32x16(JkI512 x) {
+    return (JkF32x16){_mm512_cvtepi32_ps(x.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_from_i512_reinterpret(JkI512 x) {
+    return (JkF32x16){_mm512_castsi512_ps(x.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_from_f32x16_reinterpret(JkF32x16 x) {
+    return (JkI512){_mm512_castps_si512(x.v)};
+}
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i32x16_from_f32x16_truncate(JkF32x16 x) {
+    return (JkI512){_mm512_cvttps_epi32(x.v)};
+}
+
 #if defined(_MSC_VER) && !defined(__clang__)
 
+static void jk_cpuid(uint32_t regs[4], uint32_t leaf, uint32_t subleaf) {
+    __cpuidex((int *)regs, leaf, subleaf);
+}
+
+static uint64_t jk_xcr0_get(void) {
+    return _xgetbv(0);
+}
+
 JK_PUBLIC uint64_t jk_cpu_timer_get(void) {
     return __rdtsc();
 }
 
 #elif defined(__GNUC__) || defined(__clang__)
 
+static void jk_cpuid(uint32_t regs[4], uint32_t leaf, uint32_t subleaf) {
+    __asm__ volatile("cpuid"
+                     : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                     : "a"(leaf), "c"(subleaf));
+}
+
+// Inline assembly rather than _xgetbv, which needs XSAVE enabled at compile time
+static uint64_t jk_xcr0_get(void) {
+    uint32_t low;
+    uint32_t high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return ((uint64_t)high << 32) | low;
+}
+
 JK_PUBLIC uint64_t jk_cpu_timer_get(void) {
     return __builtin_ia32_rdtsc();
 }
 
 #endif
 
+JK_PUBLIC b32 jk_cpu_supports_avx512(void) {
+    uint32_t regs[4];
+    jk_cpuid(regs, 0, 0);
+    if (regs[0] < 7) {
+        return 0;
+    }
+
+    // The OS must have enabled XGETBV and saving the SSE, AVX, opmask, and both halves of the ZMM
+    // register state
+    jk_cpuid(regs, 1, 0);
+    if (!(regs[2] & (1u << 27))) {
+        return 0;
+    }
+    uint64_t zmm_state = 0xe6;
+    if ((jk_xcr0_get() & zmm_state) != zmm_state) {
+        return 0;
+    }
+
+    jk_cpuid(regs, 7, 0);
+    return (regs[1] >> 16) & 1; // AVX512F
+}
+
 #elif __arm64__
 
 JK_PUBLIC uint64_t jk_cpu_timer_get(void) {
@@ -244,6 +475,10 @@ JK_PUBLIC uint64_t jk_cpu_timer_get(void) {
     return timebase;
 }
 
+JK_PUBLIC b32 jk_cpu_supports_avx512(void) {
+    return 0;
+}
+
 JK_PUBLIC JkI256 jk_i256_zero(void) {
     return (int32x4x2_t){vdupq_n_s32(0), vdupq_n_s32(0)};
 }
@@ -276,6 +511,18 @@ JK_PUBLIC JkI256 jk_i256_sub_i32(JkI256 a, JkI256 b) {
     return (int32x4x2_t){vsubq_s32(a.val[0], b.val[0]), vsubq_s32(a.val[1], b.val[1])};
 }
 
+JK_PUBLIC JkI256 jk_i256_mul_i32(JkI256 a, JkI256 b) {
+    return (int32x4x2_t){vmulq_s32(a.val[0], b.val[0]), vmulq_s32(a.val[1], b.val[1])};
+}
+
+JK_PUBLIC JkI256 jk_i32x8_load_u8(void *pointer) {
+    uint16x8_t x = vmovl_u8(vld1_u8(pointer));
+    return (int32x4x2_t){
+        vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(x))),
+        vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(x))),
+    };
+}
+
 JK_PUBLIC JkF32x8 jk_f32x8_zero(void) {
     return (float32x4x2_t){vdupq_n_f32(0), vdupq_n_f32(0)};
 }
@@ -327,10 +574,24 @@ JK_PUBLIC JkF32x8 jk_f32x8_div(JkF32x8 a, JkF32x8 b) {
     return (float32x4x2_t){vdivq_f32(a.val[0], b.val[0]), vdivq_f32(a.val[1], b.val[1])};
 }
 
+JK_PUBLIC JkF32x8 jk_f32x8_sqrt(JkF32x8 x) {
+    return (float32x4x2_t){vsqrtq_f32(x.val[0]), vsqrtq_f32(x.val[1])};
+}
+
 JK_PUBLIC JkF32x8 jk_f32x8_floor(JkF32x8 x) {
     return (float32x4x2_t){vrndmq_f32(x.val[0]), vrndmq_f32(x.val[1])};
 }
 
+JK_PUBLIC JkF32x8 jk_f32x8_prefix_sum(JkF32x8 x) {
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    for (int32_t i = 0; i < 2; i++) {
+        x.val[i] = vaddq_f32(x.val[i], vextq_f32(zero, x.val[i], 3));
+        x.val[i] = vaddq_f32(x.val[i], vextq_f32(zero, x.val[i], 2));
+    }
+    x.val[1] = vaddq_f32(x.val[1], vdupq_laneq_f32(x.val[0], 3));
+    return x;
+}
+
 JK_PUBLIC JkF32x8 jk_f32x8_and(JkF32x8 a, JkF32x8 b) {
     return jk_f32x8_from_i256_reinterpret(
             jk_i256_and(jk_i256_from_f32x8_reinterpret(a), jk_i256_from_f32x8_reinterpret(b)));
@@ -389,6 +650,273 @@ JK_PUBLIC JkI256 jk_i32x8_from_f32x8_truncate(JkF32x8 x) {
     return (JkI256){vcvtq_s32_f32(x.val[0]), vcvtq_s32_f32(x.val[1])};
 }
 
+#else
+
+// Portable fallback that loops over the lanes. Masks follow the x86 convention, where only the
+// sign bit of each lane matters.
+
+#define JK_FOR_EACH_LANE(result, expression)   \
+    for (int64_t lane = 0; lane < 8; lane++) { \
+        (result).v[lane] = (expression);       \
+    }
+
+JK_PUBLIC b32 jk_cpu_supports_avx512(void) {
+    return 0;
+}
+
+JK_PUBLIC JkI256 jk_i256_zero(void) {
+    return (JkI256){0};
+}
+
+JK_PUBLIC JkI256 jk_i256_load(void *pointer) {
+    JkI256 result;
+    jk_memcpy(result.v, pointer, sizeof(result.v));
+    return result;
+}
+
+JK_PUBLIC void jk_i256_store(void *pointer, JkI256 x) {
+    jk_memcpy(pointer, x.v, sizeof(x.v));
+}
+
+JK_PUBLIC JkI256 jk_i256_and(JkI256 a, JkI256 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] & b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_or(JkI256 a, JkI256 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] | b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_broadcast_i32(int32_t value) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, value);
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_add_i32(JkI256 a, JkI256 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)((uint32_t)a.v[lane] + (uint32_t)b.v[lane]));
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_sub_i32(JkI256 a, JkI256 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)((uint32_t)a.v[lane] - (uint32_t)b.v[lane]));
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_mul_i32(JkI256 a, JkI256 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)((uint32_t)a.v[lane] * (uint32_t)b.v[lane]));
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i32x8_load_u8(void *pointer) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, ((uint8_t *)pointer)[lane]);
+    return result;
+}
+
+JK_PUBLIC JkI256 __jk_i256_shift_left_i32(JkI256 x, int32_t bit_count) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)((uint32_t)x.v[lane] << bit_count));
+    return result;
+}
+
+JK_PUBLIC JkI256 __jk_i256_shift_right_zero_fill_i32(JkI256 x, int32_t bit_count) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)((uint32_t)x.v[lane] >> bit_count));
+    return result;
+}
+
+JK_PUBLIC JkI256 __jk_i256_shift_right_sign_fill_i32(JkI256 x, int32_t bit_count) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, x.v[lane] < 0 ? ~(~x.v[lane] >> bit_count) : x.v[lane] >> bit_count);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_zero(void) {
+    return (JkF32x8){0};
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_broadcast(float value) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, value);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_load(void *pointer) {
+    JkF32x8 result;
+    jk_memcpy(result.v, pointer, sizeof(result.v));
+    return result;
+}
+
+JK_PUBLIC void jk_f32x8_store(void *pointer, JkF32x8 x) {
+    jk_memcpy(pointer, x.v, sizeof(x.v));
+}
+
+// Truncates offset
+JK_PUBLIC JkF32x8 jk_f32x8_gather(void *pointer, JkI256 offsets) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, ((float *)pointer)[offsets.v[lane]]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_add(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] + b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_sub(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] - b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_mul(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] * b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_div(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] / b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_sqrt(JkF32x8 x) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, jk_sqrt_f32(x.v[lane]));
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_reciprocal_approx(JkF32x8 x) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, 1.0f / x.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_floor(JkF32x8 x) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, jk_floor_f32(x.v[lane]));
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_min(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] < b.v[lane] ? a.v[lane] : b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_max(JkF32x8 a, JkF32x8 b) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] > b.v[lane] ? a.v[lane] : b.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_abs(JkF32x8 x) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, x.v[lane] < 0 ? -x.v[lane] : x.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_lerp(JkF32x8 a, JkF32x8 b, JkF32x8 t) {
+    return jk_f32x8_add(
+            jk_f32x8_mul(jk_f32x8_sub(jk_f32x8_broadcast(1), t), a), jk_f32x8_mul(t, b));
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_prefix_sum(JkF32x8 x) {
+    for (int64_t lane = 1; lane < 8; lane++) {
+        x.v[lane] += x.v[lane - 1];
+    }
+    return x;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_and(JkF32x8 a, JkF32x8 b) {
+    return jk_f32x8_from_i256_reinterpret(
+            jk_i256_and(jk_i256_from_f32x8_reinterpret(a), jk_i256_from_f32x8_reinterpret(b)));
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_or(JkF32x8 a, JkF32x8 b) {
+    return jk_f32x8_from_i256_reinterpret(
+            jk_i256_or(jk_i256_from_f32x8_reinterpret(a), jk_i256_from_f32x8_reinterpret(b)));
+}
+
+// ~a & b
+JK_PUBLIC JkF32x8 jk_f32x8_andnot(JkF32x8 a, JkF32x8 b) {
+    JkI256 ai = jk_i256_from_f32x8_reinterpret(a);
+    JkI256 bi = jk_i256_from_f32x8_reinterpret(b);
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, ~ai.v[lane] & bi.v[lane]);
+    return jk_f32x8_from_i256_reinterpret(result);
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_less_than(JkF32x8 a, JkF32x8 b) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, a.v[lane] < b.v[lane] ? -1 : 0);
+    return jk_f32x8_from_i256_reinterpret(result);
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_to_mask(JkF32x8 x) {
+    return x;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_blend(JkF32x8 false_value, JkF32x8 true_value, JkF32x8 mask) {
+    JkI256 mask_i = jk_i256_from_f32x8_reinterpret(mask);
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, mask_i.v[lane] < 0 ? true_value.v[lane] : false_value.v[lane]);
+    return result;
+}
+
+JK_PUBLIC b32 jk_f32x8_any(JkF32x8 x) {
+    JkI256 x_i = jk_i256_from_f32x8_reinterpret(x);
+    for (int64_t lane = 0; lane < 8; lane++) {
+        if (x_i.v[lane] < 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+JK_PUBLIC b32 jk_f32x8_all(JkF32x8 x) {
+    JkI256 x_i = jk_i256_from_f32x8_reinterpret(x);
+    for (int64_t lane = 0; lane < 8; lane++) {
+        if (0 <= x_i.v[lane]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_from_i32x8(JkI256 x) {
+    JkF32x8 result;
+    JK_FOR_EACH_LANE(result, (float)x.v[lane]);
+    return result;
+}
+
+JK_PUBLIC JkF32x8 jk_f32x8_from_i256_reinterpret(JkI256 x) {
+    JkF32x8 result;
+    jk_memcpy(result.v, x.v, sizeof(result.v));
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i256_from_f32x8_reinterpret(JkF32x8 x) {
+    JkI256 result;
+    jk_memcpy(result.v, x.v, sizeof(result.v));
+    return result;
+}
+
+JK_PUBLIC JkI256 jk_i32x8_from_f32x8_truncate(JkF32x8 x) {
+    JkI256 result;
+    JK_FOR_EACH_LANE(result, (int32_t)x.v[lane]);
+    return result;
+}
+
 #endif
 
 // ---- ISA-specific implementations end ---------------------------------------
@@ -2633,7 +3161,8 @@ JK_PUBLIC void jk_profile_frame_begin(void) {
     jk_profile.start = jk_cpu_timer_get();
 }
 
-JK_PUBLIC void jk_profile_frame_end(void) {
+// Returns the frame's elapsed CPU timer ticks
+JK_PUBLIC int64_t jk_profile_frame_end(void) {
     int64_t elapsed = jk_cpu_timer_get() - jk_profile.start;
 
     jk_profile.frame_elapsed[JK_PROFILE_FRAME_TOTAL] += elapsed;
@@ -2666,6 +3195,8 @@ JK_PUBLIC void jk_profile_frame_end(void) {
         }
     }
 #endif
+
+    return elapsed;
 }
 
 static void jk_profile_report_frame_build(JkArena *arena,
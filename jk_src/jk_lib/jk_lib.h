@@ -16,6 +16,7 @@ typedef uint32_t b32;
 #pragma section("jk_readonly", read)
 #define JK_READONLY __declspec(allocate("jk_readonly"))
 #define JK_NOINLINE __declspec(noinline)
+#define JK_FORCE_INLINE __forceinline
 #elif defined(__GNUC__) || defined(__clang__)
 #ifdef __MACH__
 #define JK_READONLY __attribute__((section("__DATA_CONST,jk_readonly")))
@@ -23,9 +24,11 @@ typedef uint32_t b32;
 #define JK_READONLY __attribute__((section(".rodata")))
 #endif
 #define JK_NOINLINE __attribute__((noinline))
+#define JK_FORCE_INLINE inline __attribute__((always_inline))
 #else
 #define JK_READONLY
 #define JK_NOINLINE
+#define JK_FORCE_INLINE inline
 #endif
 
 // define JK_THREAD_LOCAL
@@ -71,6 +74,40 @@ JK_PUBLIC JkI256 __jk_i256_shift_right_sign_fill_i32(JkI256 x, int32_t bit_count
 #define JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(x, bit_count) \
     __jk_i256_shift_right_sign_fill_i32(x, bit_count)
 
+// AVX-512 types are always available on x86-64, but the functions operating on them are compiled
+// for AVX-512 regardless of the build's baseline. Only call them after jk_cpu_supports_avx512()
+// returns true, and only from functions marked JK_TARGET_AVX512 so they can be inlined. Your own
+// functions that take or return AVX-512 vectors should be JK_FORCE_INLINE too. When gcc keeps one
+// out of line in a build whose baseline is AVX2, it can end it with a vzeroupper that clears lanes
+// 4 through 15 of the returned vector.
+#if defined(__GNUC__) || defined(__clang__)
+#define JK_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define JK_TARGET_AVX512
+#endif
+
+typedef struct JkI512 {
+    __m512i v;
+} JkI512;
+
+typedef struct JkF32x16 {
+    __m512 v;
+} JkF32x16;
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_left_i32(JkI512 x, int32_t bit_count);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_right_zero_fill_i32(JkI512 x, int32_t bit_count);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 __jk_i512_shift_right_sign_fill_i32(JkI512 x, int32_t bit_count);
+
+#define JK_I512_SHIFT_LEFT_I32(x, bit_count) __jk_i512_shift_left_i32(x, bit_count)
+
+#define JK_I512_SHIFT_RIGHT_ZERO_FILL_I32(x, bit_count) \
+    __jk_i512_shift_right_zero_fill_i32(x, bit_count)
+
+#define JK_I512_SHIFT_RIGHT_SIGN_FILL_I32(x, bit_count) \
+    __jk_i512_shift_right_sign_fill_i32(x, bit_count)
+
 #elif defined(__arm64__)
 
 #include <arm_neon.h>
@@ -105,6 +142,20 @@ typedef struct JkF32x8 {
     float v[8];
 } JkF32x8;
 
+JK_PUBLIC JkI256 __jk_i256_shift_left_i32(JkI256 x, int32_t bit_count);
+
+JK_PUBLIC JkI256 __jk_i256_shift_right_zero_fill_i32(JkI256 x, int32_t bit_count);
+
+JK_PUBLIC JkI256 __jk_i256_shift_right_sign_fill_i32(JkI256 x, int32_t bit_count);
+
+#define JK_I256_SHIFT_LEFT_I32(x, bit_count) __jk_i256_shift_left_i32(x, bit_count)
+
+#define JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(x, bit_count) \
+    __jk_i256_shift_right_zero_fill_i32(x, bit_count)
+
+#define JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(x, bit_count) \
+    __jk_i256_shift_right_sign_fill_i32(x, bit_count)
+
 #endif
 
 // ---- ISA-specific definitions end -------------------------------------------
@@ -560,6 +611,12 @@ JK_PUBLIC JkI256 jk_i256_add_i32(JkI256 a, JkI256 b);
 
 JK_PUBLIC JkI256 jk_i256_sub_i32(JkI256 a, JkI256 b);
 
+// Keeps the low 32 bits of each product
+JK_PUBLIC JkI256 jk_i256_mul_i32(JkI256 a, JkI256 b);
+
+// Loads 8 bytes and zero-extends each one into a 32-bit lane
+JK_PUBLIC JkI256 jk_i32x8_load_u8(void *pointer);
+
 JK_PUBLIC JkF32x8 jk_f32x8_zero(void);
 
 JK_PUBLIC JkF32x8 jk_f32x8_broadcast(float value);
@@ -579,6 +636,9 @@ JK_PUBLIC JkF32x8 jk_f32x8_mul(JkF32x8 a, JkF32x8 b);
 
 JK_PUBLIC JkF32x8 jk_f32x8_div(JkF32x8 a, JkF32x8 b);
 
+JK_PUBLIC JkF32x8 jk_f32x8_sqrt(JkF32x8 x);
+
+// About 12 bits of precision on AVX2, and exact in the portable fallback
 JK_PUBLIC JkF32x8 jk_f32x8_reciprocal_approx(JkF32x8 x);
 
 JK_PUBLIC JkF32x8 jk_f32x8_remap_approx(
@@ -594,6 +654,9 @@ JK_PUBLIC JkF32x8 jk_f32x8_abs(JkF32x8 x);
 
 JK_PUBLIC JkF32x8 jk_f32x8_lerp(JkF32x8 a, JkF32x8 b, JkF32x8 t);
 
+// Inclusive scan, so lane i of the result is the sum of lanes 0 through i
+JK_PUBLIC JkF32x8 jk_f32x8_prefix_sum(JkF32x8 x);
+
 JK_PUBLIC JkF32x8 jk_f32x8_and(JkF32x8 a, JkF32x8 b);
 
 JK_PUBLIC JkF32x8 jk_f32x8_or(JkF32x8 a, JkF32x8 b);
@@ -619,6 +682,82 @@ JK_PUBLIC JkI256 jk_i256_from_f32x8_reinterpret(JkF32x8 x);
 
 JK_PUBLIC JkI256 jk_i32x8_from_f32x8_truncate(JkF32x8 x);
 
+// Checks CPUID and whether the OS saves the AVX-512 register state. Always false off x86-64.
+JK_PUBLIC b32 jk_cpu_supports_avx512(void);
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_and(JkI512 a, JkI512 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_or(JkI512 a, JkI512 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_broadcast_i32(int32_t value);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_add_i32(JkI512 a, JkI512 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_sub_i32(JkI512 a, JkI512 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_zero(void);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_broadcast(float value);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_load(void *pointer);
+
+JK_TARGET_AVX512 JK_PUBLIC void jk_f32x16_store(void *pointer, JkF32x16 x);
+
+// Truncates offset
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_gather(void *pointer, JkI512 offsets);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_add(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_sub(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_mul(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_div(JkF32x16 a, JkF32x16 b);
+
+// About 14 bits of precision, so it disagrees with jk_f32x8_reciprocal_approx. Divide instead
+// where the two widths have to give the same results.
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_reciprocal_approx(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_floor(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_min(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_max(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_abs(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_lerp(JkF32x16 a, JkF32x16 b, JkF32x16 t);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_and(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_or(JkF32x16 a, JkF32x16 b);
+
+// ~a & b
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_andnot(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_less_than(JkF32x16 a, JkF32x16 b);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_to_mask(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_blend(
+        JkF32x16 false_value, JkF32x16 true_value, JkF32x16 mask);
+
+JK_TARGET_AVX512 JK_PUBLIC b32 jk_f32x16_any(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC b32 jk_f32x16_all(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_from_i32x16(JkI512 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkF32x16 jk_f32x16_from_i512_reinterpret(JkI512 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i512_from_f32x16_reinterpret(JkF32x16 x);
+
+JK_TARGET_AVX512 JK_PUBLIC JkI512 jk_i32x16_from_f32x16_truncate(JkF32x16 x);
+
+#endif
+
 // ---- SIMD end ---------------------------------------------------------------
 
 // ---- Fixed-point begin ------------------------------------------------------
@@ -1510,7 +1649,8 @@ JK_PUBLIC void jk_profile_zone_end(JkProfileTiming *timing);
 
 JK_PUBLIC void jk_profile_frame_begin(void);
 
-JK_PUBLIC void jk_profile_frame_end(void);
+// Returns the frame's elapsed CPU timer ticks
+JK_PUBLIC int64_t jk_profile_frame_end(void);
 
 JK_PUBLIC JkBuffer jk_profile_report(JkArena *arena, int64_t frequency);
 
@@ -1806,4 +1946,9 @@ JK_PUBLIC b32 jk_float64_equal(double a, double b, double tolerance);
 
 JK_PUBLIC int32_t jk_atomic_add(int32_t volatile *pointer, int32_t value);
 
+// Returns the value *pointer held before the operation. The exchange happened if that equals
+// expected.
+JK_PUBLIC int64_t jk_atomic_compare_exchange_64(
+        int64_t volatile *pointer, int64_t expected, int64_t desired);
+
 #endif
@@ -119,6 +119,48 @@ JK_PUBLIC void jk_platform_memory_free(JkBuffer memory) {
     }
 }
 
+JK_PUBLIC JkBuffer jk_platform_file_map(JkBuffer path) {
+    JkBuffer result = {0};
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+    JK_ARENA_SCRATCH(scratch) {
+        file = CreateFileA(jk_null_terminated_from_buffer(scratch.arena, path),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                0,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL,
+                0);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && 0 < size.QuadPart) {
+            HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+            if (mapping) {
+                // The view keeps the mapping alive after its handle is closed
+                result.data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (result.data) {
+                    result.size = size.QuadPart;
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+
+    if (!result.data) {
+        JK_LOGF(JK_LOG_ERROR, jkfn("Failed to map file '"), jkfs(path), jkfn("'"));
+    }
+
+    return result;
+}
+
+JK_PUBLIC void jk_platform_file_unmap(JkBuffer file) {
+    if (file.data) {
+        UnmapViewOfFile(file.data);
+    }
+}
+
 typedef struct _PROCESS_MEMORY_COUNTERS {
     DWORD cb;
     DWORD PageFaultCount;
@@ -457,6 +499,7 @@ JK_PUBLIC void jk_platform_barrier_destroy(JkPlatformBarrier *b) {
 
 #else
 
+#include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
 #include <sys/mman.h>
@@ -541,6 +584,43 @@ JK_PUBLIC void jk_platform_memory_free(JkBuffer memory) {
     }
 }
 
+JK_PUBLIC JkBuffer jk_platform_file_map(JkBuffer path) {
+    JkBuffer result = {0};
+
+    int file = -1;
+    JK_ARENA_SCRATCH(scratch) {
+        file = open(jk_null_terminated_from_buffer(scratch.arena, path), O_RDONLY);
+    }
+    if (file != -1) {
+        struct stat stat_struct = {0};
+        if (!fstat(file, &stat_struct) && 0 < stat_struct.st_size) {
+            void *data = mmap(NULL, stat_struct.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED) {
+                result.data = data;
+                result.size = (int64_t)stat_struct.st_size;
+            }
+        }
+        // The mapping stays valid after the descriptor is closed
+        close(file);
+    }
+
+    if (!result.data) {
+        JK_LOGF(JK_LOG_ERROR,
+                jkfn("Failed to map file '"),
+                jkfs(path),
+                jkfn("': "),
+                jkfn(strerror(errno)));
+    }
+
+    return result;
+}
+
+JK_PUBLIC void jk_platform_file_unmap(JkBuffer file) {
+    if (file.data) {
+        munmap(file.data, file.size);
+    }
+}
+
 typedef struct JkPlatformOsMetrics {
     b32 initialized;
 } JkPlatformOsMetrics;
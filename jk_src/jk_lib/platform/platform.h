@@ -52,6 +52,12 @@ JK_PUBLIC b32 jk_platform_memory_commit(void *address, int64_t size);
 
 JK_PUBLIC void jk_platform_memory_free(JkBuffer memory);
 
+// Maps the file read-only into memory, so pages are only read from disk once touched. Returns an
+// empty buffer on failure.
+JK_PUBLIC JkBuffer jk_platform_file_map(JkBuffer path);
+
+JK_PUBLIC void jk_platform_file_unmap(JkBuffer file);
+
 JK_PUBLIC uint64_t jk_platform_page_fault_count_get(void);
 
 JK_PUBLIC uint64_t jk_platform_os_timer_get(void);
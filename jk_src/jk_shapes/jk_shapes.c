@@ -21,10 +21,14 @@ JK_PUBLIC JkShapesHashTable *jk_shapes_hash_table_init(JkShapesHashTable *t, JkB
     return t;
 }
 
+// Hash and mask off bits to get a result in the range 0..capacity-1. Assumes capacity is a power
+// if 2.
+static int64_t jk_shapes_hash_table_home(JkShapesHashTable *t, int64_t key) {
+    return jk_hash_uint32((uint32_t)(key >> 32) ^ (uint32_t)key) & (t->capacity - 1);
+}
+
 JK_PUBLIC JkShapesHashTableSlot *jk_shapes_hash_table_probe(JkShapesHashTable *t, int64_t key) {
-    // Hash and mask off bits to get a result in the range 0..capacity-1. Assumes capacity is a
-    // power if 2.
-    int64_t slot_i = jk_hash_uint32((uint32_t)(key >> 32) ^ (uint32_t)key) & (t->capacity - 1);
+    int64_t slot_i = jk_shapes_hash_table_home(t, key);
 
 #if JK_BUILD_MODE != JK_RELEASE
     int64_t iterations = 0;
@@ -59,8 +63,177 @@ JK_PUBLIC void jk_shapes_hash_table_set(
     slot->value = value;
 }
 
+JK_PUBLIC void jk_shapes_hash_table_remove(JkShapesHashTable *t, JkShapesHashTableSlot *slot) {
+    JK_DEBUG_ASSERT(slot->filled);
+
+    // Shift back any later slots in the cluster that would no longer be reachable from their home
+    // slot with this one empty
+    int64_t hole_i = slot - t->slots;
+    for (int64_t slot_i = (hole_i + 1) & (t->capacity - 1); t->slots[slot_i].filled;
+            slot_i = (slot_i + 1) & (t->capacity - 1)) {
+        int64_t home_i = jk_shapes_hash_table_home(t, t->slots[slot_i].key);
+        b32 reachable = hole_i <= slot_i ? hole_i < home_i && home_i <= slot_i
+                                         : hole_i < home_i || home_i <= slot_i;
+        if (!reachable) {
+            t->slots[hole_i] = t->slots[slot_i];
+            hole_i = slot_i;
+        }
+    }
+
+    t->slots[hole_i].filled = 0;
+    t->count--;
+}
+
 // ---- Hash table end ---------------------------------------------------------
 
+// ---- Atlas begin ------------------------------------------------------------
+
+JK_PUBLIC int64_t jk_shapes_atlas_memory_size(JkIntVec2 dimensions, int64_t bitmap_capacity) {
+    int64_t pixels_size = (int64_t)dimensions.x * dimensions.y;
+    int64_t shelves_size =
+            (dimensions.y / JK_SHAPES_ATLAS_SHELF_ALIGNMENT + 1) * JK_SIZEOF(JkShapesAtlasShelf);
+    int64_t slot_count =
+            jk_round_up_to_power_of_2(bitmap_capacity * 10 / JK_SHAPES_HASH_TABLE_LOAD_FACTOR + 1);
+    return pixels_size + shelves_size + slot_count * JK_SIZEOF(JkShapesHashTableSlot);
+}
+
+// Memory should be at least jk_shapes_atlas_memory_size bytes for the given dimensions. Anything
+// beyond what the pixels and shelves need goes to the hash table.
+JK_PUBLIC void jk_shapes_atlas_init(JkShapesAtlas *atlas, JkIntVec2 dimensions, JkBuffer memory) {
+    atlas->dimensions = dimensions;
+    atlas->pixels = memory.data;
+    int64_t pixels_size = (int64_t)dimensions.x * dimensions.y;
+
+    atlas->shelf_count = 0;
+    atlas->shelf_capacity = dimensions.y / JK_SHAPES_ATLAS_SHELF_ALIGNMENT + 1;
+    atlas->shelves = (JkShapesAtlasShelf *)(memory.data + pixels_size);
+    int64_t shelves_size = atlas->shelf_capacity * JK_SIZEOF(JkShapesAtlasShelf);
+
+    JK_ASSERT(pixels_size + shelves_size < memory.size);
+    JkBuffer hash_table_memory = {
+        .size = memory.size - (pixels_size + shelves_size),
+        .data = memory.data + (pixels_size + shelves_size),
+    };
+    jk_shapes_hash_table_init(&atlas->hash_table, hash_table_memory);
+
+    atlas->frame = 0;
+    atlas->stats = (JkShapesAtlasStats){0};
+    atlas->shapes = 0;
+}
+
+static JkShapesAtlasShelf *jk_shapes_atlas_shelf_find(JkShapesAtlas *atlas, uint8_t *data) {
+    // Shelves are never removed, only emptied, so they stay sorted by y
+    int32_t y = (int32_t)((data - atlas->pixels) / atlas->dimensions.x);
+    int64_t low = 0;
+    int64_t high = atlas->shelf_count - 1;
+    while (low < high) {
+        int64_t mid = (low + high + 1) / 2;
+        if (atlas->shelves[mid].y <= y) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return atlas->shelves + low;
+}
+
+static void jk_shapes_atlas_shelf_evict(JkShapesAtlas *atlas, JkShapesAtlasShelf *shelf) {
+    uint8_t *start = atlas->pixels + (int64_t)shelf->y * atlas->dimensions.x;
+    uint8_t *end = start + (int64_t)shelf->height * atlas->dimensions.x;
+
+    // Removal shifts later slots back into the current one, so only advance past slots we keep
+    JkShapesHashTable *t = &atlas->hash_table;
+    for (int64_t i = 0; i < t->capacity;) {
+        JkShapesHashTableSlot *slot = t->slots + i;
+        if (slot->filled && start <= slot->value.data && slot->value.data < end) {
+            jk_shapes_hash_table_remove(t, slot);
+            atlas->stats.eviction_count++;
+        } else {
+            i++;
+        }
+    }
+
+    shelf->cursor_x = 0;
+}
+
+// Returns the least recently used nonempty shelf of at least the given height that wasn't used this
+// frame, or null if there isn't one
+static JkShapesAtlasShelf *jk_shapes_atlas_shelf_lru(JkShapesAtlas *atlas, int32_t height) {
+    JkShapesAtlasShelf *result = 0;
+    for (int64_t i = 0; i < atlas->shelf_count; i++) {
+        JkShapesAtlasShelf *shelf = atlas->shelves + i;
+        if (height <= shelf->height && shelf->cursor_x && shelf->frame_used < atlas->frame
+                && (!result || shelf->frame_used < result->frame_used)) {
+            result = shelf;
+        }
+    }
+    return result;
+}
+
+// Reserves space for a bitmap and returns a pointer to its top-left pixel, or null if there's no
+// room even after evicting everything not used this frame
+static uint8_t *jk_shapes_atlas_allocate(JkShapesAtlas *atlas, JkIntVec2 dimensions) {
+    if (atlas->dimensions.x < dimensions.x || atlas->dimensions.y < dimensions.y) {
+        return 0;
+    }
+
+    // Make room in the hash table first, since a full one can't take the new bitmap anywhere
+    JkShapesHashTable *t = &atlas->hash_table;
+    while (jk_shapes_is_load_factor_exceeded(t->count + 1, t->capacity)) {
+        JkShapesAtlasShelf *lru = jk_shapes_atlas_shelf_lru(atlas, 0);
+        if (!lru) {
+            return 0;
+        }
+        jk_shapes_atlas_shelf_evict(atlas, lru);
+    }
+
+    int32_t height = JK_MIN(JK_ALIGN_UP(dimensions.y, JK_SHAPES_ATLAS_SHELF_ALIGNMENT),
+            atlas->dimensions.y);
+
+    // Use the shortest shelf with room that doesn't waste more than half its height
+    JkShapesAtlasShelf *shelf = 0;
+    for (int64_t i = 0; i < atlas->shelf_count; i++) {
+        JkShapesAtlasShelf *candidate = atlas->shelves + i;
+        if (height <= candidate->height && candidate->height < 2 * height
+                && dimensions.x <= atlas->dimensions.x - candidate->cursor_x
+                && (!shelf || candidate->height < shelf->height)) {
+            shelf = candidate;
+        }
+    }
+
+    // Otherwise open a new shelf below the last one
+    if (!shelf) {
+        int32_t y = 0;
+        if (atlas->shelf_count) {
+            JkShapesAtlasShelf *last = atlas->shelves + atlas->shelf_count - 1;
+            y = last->y + last->height;
+        }
+        if (height <= atlas->dimensions.y - y) {
+            JK_ASSERT(atlas->shelf_count < atlas->shelf_capacity);
+            shelf = atlas->shelves + atlas->shelf_count++;
+            shelf->y = y;
+            shelf->height = height;
+            shelf->cursor_x = 0;
+        }
+    }
+
+    // Otherwise evict the least recently used shelf that's tall enough
+    if (!shelf) {
+        shelf = jk_shapes_atlas_shelf_lru(atlas, dimensions.y);
+        if (!shelf) {
+            return 0;
+        }
+        jk_shapes_atlas_shelf_evict(atlas, shelf);
+    }
+
+    uint8_t *result = atlas->pixels + (int64_t)shelf->y * atlas->dimensions.x + shelf->cursor_x;
+    shelf->cursor_x += dimensions.x;
+    shelf->frame_used = atlas->frame;
+    return result;
+}
+
+// ---- Atlas end --------------------------------------------------------------
+
 #define JK_SHAPES_CAPACITY 1024
 
 JK_PUBLIC void jk_shapes_renderer_init(JkShapesRenderer *renderer,
@@ -78,13 +251,46 @@ JK_PUBLIC void jk_shapes_renderer_init(JkShapesRenderer *renderer,
     hash_table_memory.data = jk_arena_push_zero(arena, hash_table_memory.size);
     jk_shapes_hash_table_init(&renderer->hash_table, hash_table_memory);
 
+    renderer->atlas = 0;
     renderer->draw_commands_head = 0;
 }
 
+JK_PUBLIC void jk_shapes_renderer_atlas_attach(JkShapesRenderer *renderer, JkShapesAtlas *atlas) {
+    if (atlas->shapes != renderer->shapes.e) {
+        // Cached bitmaps are keyed by shape index, so they belong to the old shape table
+        atlas->shelf_count = 0;
+        JkBuffer hash_table_memory = {
+            .size = atlas->hash_table.capacity * JK_SIZEOF(JkShapesHashTableSlot),
+            .data = (uint8_t *)atlas->hash_table.slots,
+        };
+        jk_shapes_hash_table_init(&atlas->hash_table, hash_table_memory);
+        atlas->shapes = renderer->shapes.e;
+    }
+    renderer->atlas = atlas;
+    atlas->frame++;
+}
+
 static int64_t jk_shapes_bitmap_key_get(int64_t shape_index, float scale) {
     return (shape_index << 32) | *(uint32_t *)&scale;
 }
 
+// SDF glyphs don't depend on scale, so they take the key of a scale no bitmap can have
+static int64_t jk_shapes_sdf_key_get(int64_t shape_index) {
+    return jk_shapes_bitmap_key_get(shape_index, -1.0f);
+}
+
+// Pixels per unit of a shape's SDF glyph
+static float jk_shapes_sdf_pixel_scale_get(JkShape shape) {
+    return (JK_SHAPES_SDF_SIDE_LENGTH - 2 * JK_SHAPES_SDF_SPREAD)
+            / JK_MAX(shape.dimensions.x, shape.dimensions.y);
+}
+
+// Where the shape's origin lands in its SDF glyph, in texels
+static JkVec2 jk_shapes_sdf_offset_get(JkShape shape, float sdf_pixel_scale) {
+    return jk_vec2_sub((JkVec2){JK_SHAPES_SDF_SPREAD, JK_SHAPES_SDF_SPREAD},
+            jk_vec2_mul(sdf_pixel_scale, shape.offset));
+}
+
 static JkVec2 jk_shapes_evaluate_bezier_quadratic(float t, JkVec2 p0, JkVec2 p1, JkVec2 p2) {
     float t_squared = t * t;
     float one_minus_t = 1.0f - t;
@@ -217,59 +423,21 @@ static JkVec2 jk_shapes_evaluate_arc(float t, JkShapesArcByCenter arc) {
             arc.center);
 }
 
-typedef struct JkShapesLinearizer {
-    JkArena *arena;
-    float tolerance_squared;
-    JkShapesPointListNode **current_node;
-    JkShapesPointListNode *start_node;
-
-    float t;
-} JkShapesLinearizer;
-
-static void jk_shapes_linearizer_init(JkShapesLinearizer *l,
-        JkArena *arena,
-        JkShapesPointListNode **current_node,
-        JkVec2 target,
-        float tolerance) {
-    l->arena = arena;
-    l->current_node = current_node;
-    l->tolerance_squared = tolerance * tolerance;
-
-    JkShapesPointListNode *end_node = jk_arena_push(l->arena, JK_SIZEOF(*end_node));
-    end_node->next = 0;
-    end_node->point = target;
-    end_node->t = 1.0f;
-    end_node->is_cursor_movement = 0;
-
-    l->start_node = *l->current_node;
-    l->start_node->next = end_node;
-    l->start_node->t = 0.0f;
-}
-
-static b32 jk_shapes_linearizer_running(JkShapesLinearizer *l) {
-    if ((*l->current_node)->next) {
-        l->t = ((*l->current_node)->t + (*l->current_node)->next->t) / 2.0f;
-        return 1;
-    } else {
-        return 0;
-    }
+// Flattens curves into a fixed number of segments computed up front. A curve whose second
+// derivative never exceeds second_derivative_max strays at most second_derivative_max / (8 n^2)
+// from its chords when split into n even steps of its parameter, so solve that for the smallest n
+// within tolerance.
+static int64_t jk_shapes_segment_count_get(float second_derivative_max, float tolerance) {
+    float count = jk_ceil_f32(jk_sqrt_f32(second_derivative_max / (8.0f * tolerance)));
+    return JK_MAX(1, (int64_t)count);
 }
 
-static void jk_shapes_linearizer_evaluate(JkShapesLinearizer *l, JkVec2 point) {
-    JkShapesPointListNode *next = (*l->current_node)->next;
-    JkVec2 approx_point = jk_vec2_lerp((*l->current_node)->point, next->point, 0.5f);
-
-    if (jk_vec2_distance_sqr(approx_point, point) <= l->tolerance_squared) {
-        *l->current_node = next;
-    } else {
-        JkShapesPointListNode *new_node = jk_arena_push(l->arena, JK_SIZEOF(*new_node));
-        new_node->next = next;
-        new_node->point = point;
-        new_node->t = l->t;
-        new_node->is_cursor_movement = 0;
-
-        (*l->current_node)->next = new_node;
+static void jk_shapes_edge_push(JkArena *arena, JkVec2 a, JkVec2 b, b32 skip_horizontal) {
+    if (skip_horizontal && a.y == b.y) {
+        return;
     }
+    JkEdge *new_edge = jk_arena_push(arena, JK_SIZEOF(*new_edge));
+    *new_edge = jk_edge_from_points(a, b);
 }
 
 JK_PUBLIC JkEdgeArray jk_shapes_edges_get(JkArena *arena,
@@ -278,93 +446,175 @@ JK_PUBLIC JkEdgeArray jk_shapes_edges_get(JkArena *arena,
         float scale,
         float tolerance,
         b32 skip_horizontal) {
-    JkShapesPointListNode *start_node = jk_arena_push(arena, JK_SIZEOF(*start_node));
-    start_node->next = 0;
-    start_node->point = (JkVec2){0};
-    start_node->is_cursor_movement = 0;
-
-    JkShapesPointListNode *current_node = start_node;
+    // Edges are pushed one after another as the commands are flattened, so nothing else may be
+    // pushed to the arena until this returns
+    JkEdgeArray edges = {.e = jk_arena_pointer_current(arena)};
+    JkVec2 point = {0};
 
     for (int64_t i = 0; i < commands.count; i++) {
         JkShapesPenCommand *command = commands.e + i;
 
         switch (command->type) {
         case JK_SHAPES_PEN_COMMAND_MOVE: {
-            JkShapesPointListNode *previous_node = current_node;
-            current_node = jk_arena_push(arena, JK_SIZEOF(*current_node));
-            previous_node->next = current_node;
-            current_node->next = 0;
-            current_node->point = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
-            current_node->is_cursor_movement = 1;
+            point = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
         } break;
 
         case JK_SHAPES_PEN_COMMAND_LINE: {
-            JkShapesPointListNode *previous_node = current_node;
-            current_node = jk_arena_push(arena, JK_SIZEOF(*current_node));
-            previous_node->next = current_node;
-            current_node->next = 0;
-            current_node->point = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
-            current_node->is_cursor_movement = 0;
+            JkVec2 p1 = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
+            jk_shapes_edge_push(arena, point, p1, skip_horizontal);
+            point = p1;
         } break;
 
         case JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC: {
-            JkVec2 p0 = current_node->point;
+            JkVec2 p0 = point;
             JkVec2 p1 = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
             JkVec2 p2 = jk_vec2_add(jk_vec2_mul(scale, command->v[1]), offset);
 
-            JkShapesLinearizer l;
-            jk_shapes_linearizer_init(&l, arena, &current_node, p2, tolerance);
+            // B''(t) = 2 (p0 - 2 p1 + p2)
+            float second_derivative_max = 2.0f
+                    * jk_vec2_magnitude(jk_vec2_add(jk_vec2_sub(p0, jk_vec2_mul(2.0f, p1)), p2));
+            int64_t segment_count = jk_shapes_segment_count_get(second_derivative_max, tolerance);
 
-            while (jk_shapes_linearizer_running(&l)) {
-                jk_shapes_linearizer_evaluate(
-                        &l, jk_shapes_evaluate_bezier_quadratic(l.t, p0, p1, p2));
+            for (int64_t j = 1; j < segment_count; j++) {
+                JkVec2 next = jk_shapes_evaluate_bezier_quadratic(
+                        (float)j / (float)segment_count, p0, p1, p2);
+                jk_shapes_edge_push(arena, point, next, skip_horizontal);
+                point = next;
             }
+            jk_shapes_edge_push(arena, point, p2, skip_horizontal);
+            point = p2;
         } break;
 
         case JK_SHAPES_PEN_COMMAND_CURVE_CUBIC: {
-            JkVec2 p0 = current_node->point;
+            JkVec2 p0 = point;
             JkVec2 p1 = jk_vec2_add(jk_vec2_mul(scale, command->v[0]), offset);
             JkVec2 p2 = jk_vec2_add(jk_vec2_mul(scale, command->v[1]), offset);
             JkVec2 p3 = jk_vec2_add(jk_vec2_mul(scale, command->v[2]), offset);
 
-            JkShapesLinearizer l;
-            jk_shapes_linearizer_init(&l, arena, &current_node, p3, tolerance);
-
-            while (jk_shapes_linearizer_running(&l)) {
-                jk_shapes_linearizer_evaluate(
-                        &l, jk_shapes_evaluate_bezier_cubic(l.t, p0, p1, p2, p3));
+            // B''(t) = 6 ((1 - t) (p0 - 2 p1 + p2) + t (p1 - 2 p2 + p3)), which peaks at an end
+            float second_derivative_max = 6.0f
+                    * JK_MAX(jk_vec2_magnitude(
+                                     jk_vec2_add(jk_vec2_sub(p0, jk_vec2_mul(2.0f, p1)), p2)),
+                            jk_vec2_magnitude(
+                                    jk_vec2_add(jk_vec2_sub(p1, jk_vec2_mul(2.0f, p2)), p3)));
+            int64_t segment_count = jk_shapes_segment_count_get(second_derivative_max, tolerance);
+
+            for (int64_t j = 1; j < segment_count; j++) {
+                JkVec2 next = jk_shapes_evaluate_bezier_cubic(
+                        (float)j / (float)segment_count, p0, p1, p2, p3);
+                jk_shapes_edge_push(arena, point, next, skip_horizontal);
+                point = next;
             }
+            jk_shapes_edge_push(arena, point, p3, skip_horizontal);
+            point = p3;
         } break;
 
         case JK_SHAPES_PEN_COMMAND_ARC: {
-            JkShapesArcByCenter arc = jk_shapes_arc_endpoint_to_center(
-                    offset, scale, current_node->point, command->arc);
-
-            JkShapesLinearizer l;
-            jk_shapes_linearizer_init(&l, arena, &current_node, arc.point_end, tolerance);
-
-            while (jk_shapes_linearizer_running(&l)) {
-                jk_shapes_linearizer_evaluate(&l, jk_shapes_evaluate_arc(l.t, arc));
+            JkShapesArcByCenter arc =
+                    jk_shapes_arc_endpoint_to_center(offset, scale, point, command->arc);
+
+            if (!arc.treat_as_line) {
+                // The second derivative of an elliptical arc is at most its larger radius times
+                // the square of its angular speed
+                float radius_max = JK_MAX(arc.dimensions.x, arc.dimensions.y);
+                float second_derivative_max = radius_max * arc.angle_delta * arc.angle_delta;
+                int64_t segment_count =
+                        jk_shapes_segment_count_get(second_derivative_max, tolerance);
+
+                for (int64_t j = 1; j < segment_count; j++) {
+                    JkVec2 next =
+                            jk_shapes_evaluate_arc((float)j / (float)segment_count, arc);
+                    jk_shapes_edge_push(arena, point, next, skip_horizontal);
+                    point = next;
+                }
             }
+            jk_shapes_edge_push(arena, point, arc.point_end, skip_horizontal);
+            point = arc.point_end;
         } break;
         }
     }
 
-    // The linearization is finished. Create an array of edges from the point list.
-    JkEdgeArray edges = {.e = jk_arena_pointer_current(arena)};
-    for (JkShapesPointListNode *node = start_node; node && node->next; node = node->next) {
-        if (node->next->is_cursor_movement) {
-            continue;
+    edges.count = (JkEdge *)jk_arena_pointer_current(arena) - edges.e;
+
+    return edges;
+}
+
+// Tolerance of each edge level as a fraction of the shape's largest dimension. The middle level is
+// exactly what SDF glyphs need, and the others are 4 times coarser and finer. Rasterizing coverage
+// bitmaps to within a quarter pixel, they cover shapes up to 26, 104, and 416 pixels across.
+#define JK_SHAPES_EDGE_LEVEL_SDF_TOLERANCE \
+    (JK_SHAPES_SDF_TOLERANCE / (JK_SHAPES_SDF_SIDE_LENGTH - 2.0f * JK_SHAPES_SDF_SPREAD))
+static float jk_shapes_edge_level_tolerances[JK_SHAPES_EDGE_LEVEL_COUNT] = {
+    4.0f * JK_SHAPES_EDGE_LEVEL_SDF_TOLERANCE,
+    JK_SHAPES_EDGE_LEVEL_SDF_TOLERANCE,
+    JK_SHAPES_EDGE_LEVEL_SDF_TOLERANCE / 4.0f,
+};
+
+static JkShapesPenCommandArray jk_shapes_commands_get(uint8_t *base_pointer, JkShape *shape) {
+    JkShapesPenCommandArray commands;
+    commands.count = shape->commands.size / JK_SIZEOF(commands.e[0]);
+    commands.e = (JkShapesPenCommand *)(base_pointer + shape->commands.offset);
+    return commands;
+}
+
+JK_PUBLIC void jk_shapes_edges_pack(
+        JkArena *arena, void *base_pointer, JkShape *shape, int64_t level_count) {
+    JkShapesPenCommandArray commands = jk_shapes_commands_get(base_pointer, shape);
+    float dimension_max = JK_MAX(shape->dimensions.x, shape->dimensions.y);
+    for (int64_t level = 0; level < JK_SHAPES_EDGE_LEVEL_COUNT; level++) {
+        shape->edges[level] = (JkSpan){0};
+        if (level < level_count && commands.count && 0.0f < dimension_max) {
+            JkEdgeArray edges = jk_shapes_edges_get(arena,
+                    commands,
+                    (JkVec2){0},
+                    1.0f,
+                    jk_shapes_edge_level_tolerances[level] * dimension_max,
+                    0);
+            shape->edges[level].size = JK_SIZEOF(*edges.e) * edges.count;
+            shape->edges[level].offset = (uint8_t *)edges.e - (uint8_t *)base_pointer;
         }
-        if (skip_horizontal && node->point.y == node->next->point.y) {
-            continue;
+    }
+}
+
+// Returns the shape's edges in pixel space, flattened to within tolerance pixels. Uses the coarsest
+// packed edge level that's fine enough and only falls back to flattening the pen commands when
+// none is.
+static JkEdgeArray jk_shapes_shape_edges_get(JkShapesRenderer *renderer,
+        JkArena *arena,
+        JkShape *shape,
+        JkVec2 offset,
+        float scale,
+        float tolerance,
+        b32 skip_horizontal) {
+    // In shape units, with room for rounding so the level made for SDF glyphs qualifies for them
+    float unit_tolerance = 1.0001f * tolerance / scale;
+    float dimension_max = JK_MAX(shape->dimensions.x, shape->dimensions.y);
+    for (int64_t level = 0; level < JK_SHAPES_EDGE_LEVEL_COUNT; level++) {
+        if (shape->edges[level].size
+                && jk_shapes_edge_level_tolerances[level] * dimension_max <= unit_tolerance) {
+            JkEdge *packed = (JkEdge *)(renderer->base_pointer + shape->edges[level].offset);
+            int64_t packed_count = shape->edges[level].size / JK_SIZEOF(*packed);
+
+            JkEdgeArray edges = {.e = jk_arena_push(arena, JK_SIZEOF(*edges.e) * packed_count)};
+            for (int64_t i = 0; i < packed_count; i++) {
+                JkEdge edge = packed[i];
+                for (int32_t j = 0; j < 2; j++) {
+                    edge.segment.e[j] = jk_vec2_add(jk_vec2_mul(scale, edge.segment.e[j]), offset);
+                }
+                if (!(skip_horizontal && edge.segment.p0.y == edge.segment.p1.y)) {
+                    edges.e[edges.count++] = edge;
+                }
+            }
+            return edges;
         }
-        JkEdge *new_edge = jk_arena_push(arena, JK_SIZEOF(*new_edge));
-        *new_edge = jk_edge_from_points(node->point, node->next->point);
     }
-    edges.count = (JkEdge *)jk_arena_pointer_current(arena) - edges.e;
 
-    return edges;
+    return jk_shapes_edges_get(arena,
+            jk_shapes_commands_get(renderer->base_pointer, shape),
+            offset,
+            scale,
+            tolerance,
+            skip_horizontal);
 }
 
 // No bounds checking so they return the intersection as if the segment was an infinite line
@@ -382,6 +632,8 @@ JK_PUBLIC void jk_shapes_pixel_rect_draw(
     node->command.color = color;
     node->command.rect = pixel_rect;
     node->command.alpha_map = 0;
+    node->command.alpha_map_key = 0;
+    node->command.sdf_step = 0;
     node->next = renderer->draw_commands_head;
     renderer->draw_commands_head = node;
 }
@@ -396,6 +648,8 @@ JK_PUBLIC void jk_shapes_pixel_rect_draw_outline(
         node->command.rect = pixel_rect;
         node->command.rect.max.y = pixel_rect.min.y + thickness_i;
         node->command.alpha_map = 0;
+        node->command.alpha_map_key = 0;
+        node->command.sdf_step = 0;
         node->next = renderer->draw_commands_head;
         renderer->draw_commands_head = node;
     }
@@ -406,6 +660,8 @@ JK_PUBLIC void jk_shapes_pixel_rect_draw_outline(
         node->command.rect = pixel_rect;
         node->command.rect.min.y = pixel_rect.max.y - thickness_i;
         node->command.alpha_map = 0;
+        node->command.alpha_map_key = 0;
+        node->command.sdf_step = 0;
         node->next = renderer->draw_commands_head;
         renderer->draw_commands_head = node;
     }
@@ -418,6 +674,8 @@ JK_PUBLIC void jk_shapes_pixel_rect_draw_outline(
         node->command.rect.max.x = pixel_rect.min.x + thickness_i;
         node->command.rect.max.y = pixel_rect.max.y - thickness_i;
         node->command.alpha_map = 0;
+        node->command.alpha_map_key = 0;
+        node->command.sdf_step = 0;
         node->next = renderer->draw_commands_head;
         renderer->draw_commands_head = node;
     }
@@ -430,6 +688,8 @@ JK_PUBLIC void jk_shapes_pixel_rect_draw_outline(
         node->command.rect.max.x = pixel_rect.max.x;
         node->command.rect.max.y = pixel_rect.max.y - thickness_i;
         node->command.alpha_map = 0;
+        node->command.alpha_map_key = 0;
+        node->command.sdf_step = 0;
         node->next = renderer->draw_commands_head;
         renderer->draw_commands_head = node;
     }
@@ -448,140 +708,473 @@ JK_PUBLIC JkIntRect jk_shapes_rect_draw_outline(
     return pixel_rect;
 }
 
-JK_PUBLIC JkShapesBitmap jk_shapes_bitmap_get(
-        JkShapesRenderer *renderer, int64_t shape_index, float scale) {
-    JkShapesBitmap bitmap = {0};
-    float pixel_scale = scale * renderer->pixels_per_unit;
+// Returns the first bitmap row an edge touches, or row_count if it starts below the bitmap
+static int32_t jk_shapes_edge_first_row(JkEdge edge, int32_t row_count) {
+    return JK_MIN(JK_MAX((int32_t)edge.segment.p0.y, 0), row_count);
+}
 
+// Looks the bitmap up in the cache, reserving space for it on a miss. Returns whether the bitmap's
+// pixels still need to be rasterized. When sdf is set, the bitmap is the shape's SDF glyph and
+// pixel_scale is ignored.
+static b32 jk_shapes_bitmap_reserve(JkShapesRenderer *renderer,
+        int64_t shape_index,
+        float pixel_scale,
+        b32 sdf,
+        JkShapesBitmap *bitmap) {
     JkShape shape = renderer->shapes.e[shape_index];
-    if (shape.dimensions.x && shape.dimensions.y) {
-        int64_t bitmap_key = jk_shapes_bitmap_key_get(shape_index, pixel_scale);
-        JkShapesHashTableSlot *bitmap_slot =
-                jk_shapes_hash_table_probe(&renderer->hash_table, bitmap_key);
-        if (bitmap_slot->filled) {
-            bitmap = bitmap_slot->value;
+    int64_t bitmap_key = sdf ? jk_shapes_sdf_key_get(shape_index)
+                             : jk_shapes_bitmap_key_get(shape_index, pixel_scale);
+    JkShapesAtlas *atlas = renderer->atlas;
+    JkShapesHashTable *hash_table = atlas ? &atlas->hash_table : &renderer->hash_table;
+    JkShapesHashTableSlot *bitmap_slot = jk_shapes_hash_table_probe(hash_table, bitmap_key);
+    if (bitmap_slot->filled) {
+        *bitmap = bitmap_slot->value;
+        if (atlas) {
+            atlas->stats.hit_count++;
+            jk_shapes_atlas_shelf_find(atlas, bitmap->data)->frame_used = atlas->frame;
+        }
+        return 0;
+    }
+
+    if (sdf) {
+        JkVec2 spread = {JK_SHAPES_SDF_SPREAD, JK_SHAPES_SDF_SPREAD};
+        JkIntVec2 dimensions = jk_vec2_ceil_i(jk_vec2_add(
+                jk_vec2_mul(jk_shapes_sdf_pixel_scale_get(shape), shape.dimensions),
+                jk_vec2_mul(2, spread)));
+        bitmap->offset = (JkIntVec2){0};
+        bitmap->dimensions.x = JK_MIN(dimensions.x, JK_SHAPES_SDF_SIDE_LENGTH);
+        bitmap->dimensions.y = JK_MIN(dimensions.y, JK_SHAPES_SDF_SIDE_LENGTH);
+    } else {
+        JkVec2 negative_offset = jk_vec2_mul(-pixel_scale, shape.offset);
+        JkVec2 negative_offset_ceil = jk_vec2_ceil(negative_offset);
+        JkVec2 negative_offset_delta = jk_vec2_sub(negative_offset_ceil, negative_offset);
+
+        bitmap->offset =
+                (JkIntVec2){-(int32_t)negative_offset_ceil.x, -(int32_t)negative_offset_ceil.y};
+        bitmap->dimensions = jk_vec2_ceil_i(
+                jk_vec2_add(jk_vec2_mul(pixel_scale, shape.dimensions), negative_offset_delta));
+    }
+    bitmap->data = 0;
+    if (atlas) {
+        atlas->stats.miss_count++;
+        bitmap->stride = atlas->dimensions.x;
+        bitmap->data = jk_shapes_atlas_allocate(atlas, bitmap->dimensions);
+        if (bitmap->data) {
+            // Eviction may have shifted slots around, so probe for the key again
+            bitmap_slot = jk_shapes_hash_table_probe(hash_table, bitmap_key);
+            jk_shapes_hash_table_set(hash_table, bitmap_slot, bitmap_key, *bitmap);
         } else {
-            JkVec2 negative_offset = jk_vec2_mul(-pixel_scale, shape.offset);
-            JkVec2 negative_offset_ceil = jk_vec2_ceil(negative_offset);
-            JkVec2 negative_offset_delta = jk_vec2_sub(negative_offset_ceil, negative_offset);
-
-            bitmap.offset =
-                    (JkIntVec2){-(int32_t)negative_offset_ceil.x, -(int32_t)negative_offset_ceil.y};
-            bitmap.dimensions = jk_vec2_ceil_i(
-                    jk_vec2_add(jk_vec2_mul(pixel_scale, shape.dimensions), negative_offset_delta));
-            bitmap.data = jk_arena_push(renderer->arena,
-                    bitmap.dimensions.x * bitmap.dimensions.y * JK_SIZEOF(bitmap.data[0]));
-            jk_shapes_hash_table_set(&renderer->hash_table, bitmap_slot, bitmap_key, bitmap);
-
-            JkArenaScope rasterize_scope = jk_arena_scope_begin(renderer->arena);
-
-            int64_t coverage_size = JK_SIZEOF(float) * (bitmap.dimensions.x + 1);
-            float *coverage = jk_arena_push(renderer->arena, coverage_size);
-            float *fill = jk_arena_push(renderer->arena, coverage_size);
-
-            JkShapesPenCommandArray commands;
-            commands.count = shape.commands.size / JK_SIZEOF(commands.e[0]);
-            commands.e = (JkShapesPenCommand *)(renderer->base_pointer + shape.commands.offset);
-            JkEdgeArray edges = jk_shapes_edges_get(
-                    renderer->arena, commands, negative_offset_ceil, pixel_scale, 0.25f, 1);
-
-            for (int32_t y = 0; y < bitmap.dimensions.y; y++) {
-                jk_memset(coverage, 0, coverage_size * 2);
-
-                float scan_y_top = (float)y;
-                float scan_y_bottom = scan_y_top + 1.0f;
-                for (int64_t i = 0; i < edges.count; i++) {
-                    float y_top = JK_MAX(edges.e[i].segment.p0.y, scan_y_top);
-                    float y_bottom = JK_MIN(edges.e[i].segment.p1.y, scan_y_bottom);
-                    if (y_top < y_bottom) {
-                        float height = y_bottom - y_top;
-                        float x_top = jk_segment_y_intersection(edges.e[i].segment, y_top);
-                        float x_bottom = jk_segment_y_intersection(edges.e[i].segment, y_bottom);
-
-                        float y_start;
-                        float y_end;
-                        float x_start;
-                        float x_end;
-                        if (x_top < x_bottom) {
-                            y_start = y_top;
-                            y_end = y_bottom;
-                            x_start = x_top;
-                            x_end = x_bottom;
-                        } else {
-                            y_start = y_bottom;
-                            y_end = y_top;
-                            x_start = x_bottom;
-                            x_end = x_top;
-                        }
-
-                        int32_t first_pixel_index = (int32_t)x_start;
-                        float first_pixel_right = (float)(first_pixel_index + 1);
-
-                        if (first_pixel_index == (int32_t)x_end) {
-                            // Edge only covers one pixel
-
-                            // Compute trapezoid area
-                            float top_width = first_pixel_right - x_top;
-                            float bottom_width = first_pixel_right - x_bottom;
-                            float area = (top_width + bottom_width) / 2.0f * height;
-                            coverage[first_pixel_index] += edges.e[i].direction * area;
-
-                            // Fill everything to the right with height
-                            fill[first_pixel_index + 1] += edges.e[i].direction * height;
-                        } else {
-                            // Edge covers multiple pixels
-                            float delta_y = (edges.e[i].segment.p1.y - edges.e[i].segment.p0.y)
-                                    / (edges.e[i].segment.p1.x - edges.e[i].segment.p0.x);
-
-                            // Handle first pixel
-                            float first_x_intersection = jk_segment_x_intersection(
-                                    edges.e[i].segment, first_pixel_right);
-                            float first_pixel_y_offset = first_x_intersection - y_start;
-                            float first_pixel_area = (first_pixel_right - x_start)
-                                    * JK_ABS(first_pixel_y_offset) / 2.0f;
-                            coverage[first_pixel_index] += edges.e[i].direction * first_pixel_area;
-
-                            // Handle middle pixels (if there are any)
-                            float y_offset = first_pixel_y_offset;
-                            int32_t pixel_index = first_pixel_index + 1;
-                            for (; (float)(pixel_index + 1) < x_end; pixel_index++) {
-                                coverage[pixel_index] +=
-                                        edges.e[i].direction * JK_ABS(y_offset + delta_y / 2.0f);
-                                y_offset += delta_y;
-                            }
-
-                            // Handle last pixel
-                            float last_x_intersection = y_start + y_offset;
-                            float uncovered_triangle = JK_ABS(y_end - last_x_intersection)
-                                    * (x_end - (float)pixel_index) / 2.0f;
-                            coverage[pixel_index] +=
-                                    edges.e[i].direction * (height - uncovered_triangle);
-
-                            // Fill everything to the right with height
-                            fill[pixel_index + 1] += edges.e[i].direction * height;
-                        }
-                    }
+            atlas->stats.overflow_count++;
+        }
+    }
+    if (!bitmap->data) {
+        // Either there's no atlas, or it had no room and the bitmap won't be cached
+        bitmap->stride = bitmap->dimensions.x;
+        bitmap->data = jk_arena_push(renderer->arena,
+                bitmap->dimensions.x * bitmap->dimensions.y * JK_SIZEOF(bitmap->data[0]));
+        if (!atlas) {
+            jk_shapes_hash_table_set(hash_table, bitmap_slot, bitmap_key, *bitmap);
+        }
+    }
+    return 1;
+}
+
+// Fills in the pixels of a bitmap reserved by jk_shapes_bitmap_reserve. Only reads from the
+// renderer, so threads can rasterize different bitmaps at once as long as each has its own arena.
+static void jk_shapes_bitmap_rasterize(JkShapesRenderer *renderer,
+        JkArena *arena,
+        int64_t shape_index,
+        float pixel_scale,
+        JkShapesBitmap bitmap) {
+    JkShape shape = renderer->shapes.e[shape_index];
+    JkVec2 negative_offset_ceil = {(float)-bitmap.offset.x, (float)-bitmap.offset.y};
+
+    JkArenaScope rasterize_scope = jk_arena_scope_begin(arena);
+
+    int64_t coverage_size = JK_SIZEOF(float) * (bitmap.dimensions.x + 1);
+    float *coverage = jk_arena_push(arena, coverage_size);
+    float *fill = jk_arena_push(arena, coverage_size);
+
+    JkEdgeArray edges = jk_shapes_shape_edges_get(
+            renderer, arena, &shape, negative_offset_ceil, pixel_scale, 0.25f, 1);
+
+    // Bucket the edges by the first row they touch. Edges starting below the bitmap go in
+    // an extra bucket at the end that's never visited.
+    int32_t row_count = bitmap.dimensions.y;
+    int64_t *row_cursors =
+            jk_arena_push_zero(arena, JK_SIZEOF(int64_t) * (row_count + 1));
+    for (int64_t i = 0; i < edges.count; i++) {
+        row_cursors[jk_shapes_edge_first_row(edges.e[i], row_count)]++;
+    }
+    int64_t *row_starts =
+            jk_arena_push(arena, JK_SIZEOF(int64_t) * (row_count + 2));
+    row_starts[0] = 0;
+    for (int32_t row = 0; row <= row_count; row++) {
+        row_starts[row + 1] = row_starts[row] + row_cursors[row];
+        row_cursors[row] = row_starts[row];
+    }
+    JkEdge *sorted_edges = jk_arena_push(arena, JK_SIZEOF(JkEdge) * edges.count);
+    for (int64_t i = 0; i < edges.count; i++) {
+        sorted_edges[row_cursors[jk_shapes_edge_first_row(edges.e[i], row_count)]++] =
+                edges.e[i];
+    }
+
+    // Edges crossing the current row, in the order they became active
+    JkEdge **active_edges =
+            jk_arena_push(arena, JK_SIZEOF(JkEdge *) * edges.count);
+    int64_t active_count = 0;
+
+    for (int32_t y = 0; y < bitmap.dimensions.y; y++) {
+        jk_memset(coverage, 0, coverage_size * 2);
+
+        for (int64_t i = row_starts[y]; i < row_starts[y + 1]; i++) {
+            active_edges[active_count++] = sorted_edges + i;
+        }
+
+        float scan_y_top = (float)y;
+        float scan_y_bottom = scan_y_top + 1.0f;
+        for (int64_t i = 0; i < active_count; i++) {
+            JkEdge *edge = active_edges[i];
+            float y_top = JK_MAX(edge->segment.p0.y, scan_y_top);
+            float y_bottom = JK_MIN(edge->segment.p1.y, scan_y_bottom);
+            if (y_top < y_bottom) {
+                float height = y_bottom - y_top;
+                float x_top = jk_segment_y_intersection(edge->segment, y_top);
+                float x_bottom = jk_segment_y_intersection(edge->segment, y_bottom);
+
+                float y_start;
+                float y_end;
+                float x_start;
+                float x_end;
+                if (x_top < x_bottom) {
+                    y_start = y_top;
+                    y_end = y_bottom;
+                    x_start = x_top;
+                    x_end = x_bottom;
+                } else {
+                    y_start = y_bottom;
+                    y_end = y_top;
+                    x_start = x_bottom;
+                    x_end = x_top;
                 }
 
-                // Fill the scanline according to coverage
-                float acc = 0.0f;
-                for (int32_t x = 0; x < bitmap.dimensions.x; x++) {
-                    acc += fill[x];
-                    int32_t value = (int32_t)(JK_ABS((coverage[x] + acc) * 255.0f));
-                    if (255 < value) {
-                        value = 255;
+                int32_t first_pixel_index = (int32_t)x_start;
+                float first_pixel_right = (float)(first_pixel_index + 1);
+
+                if (first_pixel_index == (int32_t)x_end) {
+                    // Edge only covers one pixel
+
+                    // Compute trapezoid area
+                    float top_width = first_pixel_right - x_top;
+                    float bottom_width = first_pixel_right - x_bottom;
+                    float area = (top_width + bottom_width) / 2.0f * height;
+                    coverage[first_pixel_index] += edge->direction * area;
+
+                    // Fill everything to the right with height
+                    fill[first_pixel_index + 1] += edge->direction * height;
+                } else {
+                    // Edge covers multiple pixels
+                    float delta_y = (edge->segment.p1.y - edge->segment.p0.y)
+                            / (edge->segment.p1.x - edge->segment.p0.x);
+
+                    // Handle first pixel
+                    float first_x_intersection = jk_segment_x_intersection(
+                            edge->segment, first_pixel_right);
+                    float first_pixel_y_offset = first_x_intersection - y_start;
+                    float first_pixel_area = (first_pixel_right - x_start)
+                            * JK_ABS(first_pixel_y_offset) / 2.0f;
+                    coverage[first_pixel_index] += edge->direction * first_pixel_area;
+
+                    // Handle middle pixels (if there are any)
+                    float y_offset = first_pixel_y_offset;
+                    int32_t pixel_index = first_pixel_index + 1;
+                    for (; (float)(pixel_index + 1) < x_end; pixel_index++) {
+                        coverage[pixel_index] +=
+                                edge->direction * JK_ABS(y_offset + delta_y / 2.0f);
+                        y_offset += delta_y;
                     }
-                    bitmap.data[y * bitmap.dimensions.x + x] = (uint8_t)value;
+
+                    // Handle last pixel
+                    float last_x_intersection = y_start + y_offset;
+                    float uncovered_triangle = JK_ABS(y_end - last_x_intersection)
+                            * (x_end - (float)pixel_index) / 2.0f;
+                    coverage[pixel_index] +=
+                            edge->direction * (height - uncovered_triangle);
+
+                    // Fill everything to the right with height
+                    fill[pixel_index + 1] += edge->direction * height;
                 }
             }
+        }
+
+        // Retire edges that end within this row
+        int64_t kept_count = 0;
+        for (int64_t i = 0; i < active_count; i++) {
+            if (scan_y_bottom < active_edges[i]->segment.p1.y) {
+                active_edges[kept_count++] = active_edges[i];
+            }
+        }
+        active_count = kept_count;
+
+        // Fill the scanline according to coverage, accumulating fill 8 pixels at a time
+        uint8_t *row = bitmap.data + (int64_t)y * bitmap.stride;
+        JkF32x8 max_value = jk_f32x8_broadcast(255.0f);
+        float acc = 0.0f;
+        int32_t x = 0;
+        for (; x + 8 <= bitmap.dimensions.x; x += 8) {
+            JkF32x8 sums = jk_f32x8_add(
+                    jk_f32x8_broadcast(acc), jk_f32x8_prefix_sum(jk_f32x8_load(fill + x)));
+            JkF32x8 values = jk_f32x8_mul(
+                    jk_f32x8_add(jk_f32x8_load(coverage + x), sums), max_value);
+            values = jk_f32x8_min(jk_f32x8_abs(values), max_value);
+
+            int32_t lanes[8];
+            jk_i256_store(lanes, jk_i32x8_from_f32x8_truncate(values));
+            for (int32_t lane = 0; lane < 8; lane++) {
+                row[x + lane] = (uint8_t)lanes[lane];
+            }
 
-            jk_arena_scope_end(rasterize_scope);
+            float sums_array[8];
+            jk_f32x8_store(sums_array, sums);
+            acc = sums_array[7];
+        }
+        for (; x < bitmap.dimensions.x; x++) {
+            acc += fill[x];
+            int32_t value = (int32_t)(JK_ABS((coverage[x] + acc) * 255.0f));
+            if (255 < value) {
+                value = 255;
+            }
+            row[x] = (uint8_t)value;
+        }
+    }
+
+    jk_arena_scope_end(rasterize_scope);
+}
+
+// Fills in the texels of an SDF glyph reserved by jk_shapes_bitmap_reserve, with the same
+// threading rules as jk_shapes_bitmap_rasterize. The sign comes from a scanline winding count at
+// each texel center and the distance from the nearest edge.
+// Distances saturate at the spread, so bin each edge into every cell its bounds touch once grown by
+// that much
+JK_PUBLIC JkShapesSdfCells jk_shapes_sdf_cells_get(
+        JkArena *arena, JkEdgeArray edges, JkIntVec2 dimensions, float spread) {
+    JkShapesSdfCells cells = {.side_length = 8};
+    cells.counts = (JkIntVec2){
+        (dimensions.x + cells.side_length - 1) / cells.side_length,
+        (dimensions.y + cells.side_length - 1) / cells.side_length,
+    };
+    int32_t cell_count = cells.counts.x * cells.counts.y;
+
+    JkIntRect *edge_cells = jk_arena_push(arena, JK_SIZEOF(JkIntRect) * edges.count);
+    int32_t *cell_cursors = jk_arena_push_zero(arena, JK_SIZEOF(int32_t) * cell_count);
+    for (int64_t i = 0; i < edges.count; i++) {
+        JkSegment2d segment = edges.e[i].segment;
+        float bounds[2][2] = {
+            {JK_MIN(segment.p0.x, segment.p1.x), JK_MIN(segment.p0.y, segment.p1.y)},
+            {JK_MAX(segment.p0.x, segment.p1.x), JK_MAX(segment.p0.y, segment.p1.y)},
+        };
+        for (int32_t axis = 0; axis < 2; axis++) {
+            float min = (bounds[0][axis] - spread) / cells.side_length;
+            float max = (bounds[1][axis] + spread) / cells.side_length;
+            edge_cells[i].min.v[axis] =
+                    (int32_t)JK_CLAMP(jk_floor_f32(min), 0, cells.counts.v[axis]);
+            edge_cells[i].max.v[axis] =
+                    (int32_t)JK_CLAMP(jk_floor_f32(max) + 1, 0, cells.counts.v[axis]);
+        }
+        for (int32_t y = edge_cells[i].min.y; y < edge_cells[i].max.y; y++) {
+            for (int32_t x = edge_cells[i].min.x; x < edge_cells[i].max.x; x++) {
+                cell_cursors[y * cells.counts.x + x]++;
+            }
+        }
+    }
+
+    cells.starts = jk_arena_push(arena, JK_SIZEOF(int32_t) * (cell_count + 1));
+    cells.starts[0] = 0;
+    for (int32_t i = 0; i < cell_count; i++) {
+        cells.starts[i + 1] = cells.starts[i] + cell_cursors[i];
+        cell_cursors[i] = cells.starts[i];
+    }
+    cells.edge_indexes = jk_arena_push(arena, JK_SIZEOF(int32_t) * cells.starts[cell_count]);
+    for (int64_t i = 0; i < edges.count; i++) {
+        for (int32_t y = edge_cells[i].min.y; y < edge_cells[i].max.y; y++) {
+            for (int32_t x = edge_cells[i].min.x; x < edge_cells[i].max.x; x++) {
+                cells.edge_indexes[cell_cursors[y * cells.counts.x + x]++] = (int32_t)i;
+            }
+        }
+    }
+
+    return cells;
+}
+
+JK_PUBLIC int32_t jk_shapes_sdf_cell_index_get(JkShapesSdfCells *cells, JkIntVec2 texel) {
+    return (texel.y / cells->side_length) * cells->counts.x + texel.x / cells->side_length;
+}
+
+JK_PUBLIC void jk_shapes_sdf_from_edges(JkArena *arena,
+        JkEdgeArray edges,
+        JkIntVec2 dimensions,
+        float spread,
+        uint8_t *data,
+        int64_t stride) {
+    JkArenaScope generate_scope = jk_arena_scope_begin(arena);
+
+    JkShapesSdfCells cells = jk_shapes_sdf_cells_get(arena, edges, dimensions, spread);
+
+    float *fill_right = jk_arena_push(arena, JK_SIZEOF(float) * dimensions.x);
+    for (JkIntVec2 pos = {0}; pos.y < dimensions.y; pos.y++) {
+        jk_memset(fill_right, 0, JK_SIZEOF(float) * dimensions.x);
+        float sample_y = pos.y + 0.5f;
+        for (int64_t i = 0; i < edges.count; i++) {
+            JkEdge *edge = edges.e + i;
+            if (edge->segment.p0.y <= sample_y && sample_y < edge->segment.p1.y) {
+                float leftmost_sample_x = jk_ceil_f32(
+                        jk_segment_y_intersection(edge->segment, sample_y) - 0.5f);
+                if (leftmost_sample_x < 0) {
+                    fill_right[0] += edge->direction;
+                } else if (leftmost_sample_x < dimensions.x) {
+                    fill_right[(int32_t)leftmost_sample_x] += edge->direction;
+                }
+            }
+        }
+
+        uint8_t *row = data + pos.y * stride;
+        float winding = 0;
+        for (pos.x = 0; pos.x < dimensions.x; pos.x++) {
+            winding += fill_right[pos.x];
+
+            JkVec2 sample = {pos.x + 0.5f, sample_y};
+            int32_t cell_index = jk_shapes_sdf_cell_index_get(&cells, pos);
+            float distance_sqr = jk_infinity_f32.f32;
+            for (int32_t i = cells.starts[cell_index]; i < cells.starts[cell_index + 1]; i++) {
+                float candidate =
+                        jk_distance_to_segment_2d(sample, edges.e[cells.edge_indexes[i]].segment);
+                if (candidate < distance_sqr) {
+                    distance_sqr = candidate;
+                }
+            }
+
+            float signed_distance = jk_sqrt_f32(JK_MIN(distance_sqr, spread * spread));
+            if (winding != 0) {
+                signed_distance = -signed_distance;
+            }
+            float value = jk_remap_clamped_f32(signed_distance, spread, -spread, 0, 255);
+            row[pos.x] = (uint8_t)(value + 0.5f);
+        }
+    }
+
+    jk_arena_scope_end(generate_scope);
+}
+
+static void jk_shapes_sdf_generate(JkShapesRenderer *renderer,
+        JkArena *arena,
+        int64_t shape_index,
+        JkShapesBitmap bitmap) {
+    JkShape shape = renderer->shapes.e[shape_index];
+    float sdf_pixel_scale = jk_shapes_sdf_pixel_scale_get(shape);
+
+    JkArenaScope generate_scope = jk_arena_scope_begin(arena);
+
+    // Glyphs get magnified, so flatten curves more finely than for coverage bitmaps. Horizontal
+    // edges don't affect the winding count but still count toward distances, so keep them.
+    JkEdgeArray edges = jk_shapes_shape_edges_get(renderer,
+            arena,
+            &shape,
+            jk_shapes_sdf_offset_get(shape, sdf_pixel_scale),
+            sdf_pixel_scale,
+            JK_SHAPES_SDF_TOLERANCE,
+            0);
+    jk_shapes_sdf_from_edges(
+            arena, edges, bitmap.dimensions, JK_SHAPES_SDF_SPREAD, bitmap.data, bitmap.stride);
+
+    jk_arena_scope_end(generate_scope);
+}
+
+JK_PUBLIC JkShapesBitmap jk_shapes_bitmap_get(
+        JkShapesRenderer *renderer, int64_t shape_index, float scale) {
+    JkShapesBitmap bitmap = {0};
+    float pixel_scale = scale * renderer->pixels_per_unit;
+
+    JkShape shape = renderer->shapes.e[shape_index];
+    if (shape.dimensions.x && shape.dimensions.y) {
+        if (jk_shapes_bitmap_reserve(renderer, shape_index, pixel_scale, 0, &bitmap)) {
+            jk_shapes_bitmap_rasterize(renderer, renderer->arena, shape_index, pixel_scale, bitmap);
         }
     }
 
     return bitmap;
 }
 
+JK_PUBLIC JkShapesBitmap jk_shapes_sdf_get(JkShapesRenderer *renderer, int64_t shape_index) {
+    JkShapesBitmap bitmap = {0};
+
+    JkShape shape = renderer->shapes.e[shape_index];
+    if (shape.dimensions.x && shape.dimensions.y) {
+        if (jk_shapes_bitmap_reserve(renderer, shape_index, 0, 1, &bitmap)) {
+            jk_shapes_sdf_generate(renderer, renderer->arena, shape_index, bitmap);
+        }
+    }
+
+    return bitmap;
+}
+
+static int jk_shapes_prewarm_job_compare(void *data, void *a, void *b) {
+    JkShapesPrewarmJob *x = a;
+    JkShapesPrewarmJob *y = b;
+    int64_t x_area = (int64_t)x->bitmap.dimensions.x * x->bitmap.dimensions.y;
+    int64_t y_area = (int64_t)y->bitmap.dimensions.x * y->bitmap.dimensions.y;
+    return (y_area > x_area) - (y_area < x_area);
+}
+
+JK_PUBLIC void jk_shapes_prewarm(JkShapesRenderer *renderer, JkShapesBitmapRequestArray requests) {
+    // Cache lookups and allocation aren't thread safe, so one thread reserves every missing bitmap
+    // up front and the rest of the channel only rasterizes
+    JK_CHANNEL_NARROW(0) {
+        renderer->prewarm_jobs = jk_arena_push(
+                renderer->arena, JK_SIZEOF(renderer->prewarm_jobs[0]) * requests.count);
+        renderer->prewarm_job_count = 0;
+        renderer->prewarm_job_next = 0;
+        for (int64_t i = 0; i < requests.count; i++) {
+            JkShapesPrewarmJob job = {
+                .shape_index = requests.e[i].shape_index,
+                .pixel_scale = requests.e[i].scale * renderer->pixels_per_unit,
+                .sdf = requests.e[i].sdf,
+            };
+            JkShape shape = renderer->shapes.e[job.shape_index];
+            if (shape.dimensions.x && shape.dimensions.y
+                    && jk_shapes_bitmap_reserve(
+                            renderer, job.shape_index, job.pixel_scale, job.sdf, &job.bitmap)) {
+                renderer->prewarm_jobs[renderer->prewarm_job_count++] = job;
+            }
+        }
+
+        // Hand out the biggest bitmaps first so no thread is left with a large one at the end
+        JkShapesPrewarmJob tmp;
+        jk_quicksort(renderer->prewarm_jobs,
+                renderer->prewarm_job_count,
+                JK_SIZEOF(tmp),
+                &tmp,
+                0,
+                jk_shapes_prewarm_job_compare);
+    }
+    jk_channel_sync();
+
+    JkArena *arena = jk_context->channel.index == 0 ? renderer->arena : jk_context->scratch_arenas;
+    for (;;) {
+        int64_t job_index = jk_atomic_add(&renderer->prewarm_job_next, 1);
+        if (renderer->prewarm_job_count <= job_index) {
+            break;
+        }
+        JkShapesPrewarmJob *job = renderer->prewarm_jobs + job_index;
+        if (job->sdf) {
+            jk_shapes_sdf_generate(renderer, arena, job->shape_index, job->bitmap);
+        } else {
+            jk_shapes_bitmap_rasterize(
+                    renderer, arena, job->shape_index, job->pixel_scale, job->bitmap);
+        }
+    }
+    jk_channel_sync();
+}
+
 // Returns the shape's scaled advance_width
 JK_PUBLIC float jk_shapes_draw(JkShapesRenderer *renderer,
         int64_t shape_index,
@@ -598,7 +1191,54 @@ JK_PUBLIC float jk_shapes_draw(JkShapesRenderer *renderer,
                 jk_vec2_round(jk_vec2_mul(renderer->pixels_per_unit, position)), bitmap.offset);
         node->command.color = color;
         node->command.rect.max = jk_int_vec2_add(node->command.rect.min, bitmap.dimensions);
+        node->command.alpha_map_stride = bitmap.stride;
         node->command.alpha_map = bitmap.data;
+        node->command.alpha_map_key =
+                jk_shapes_bitmap_key_get(shape_index, scale * renderer->pixels_per_unit);
+        node->command.sdf_step = 0;
+        node->next = renderer->draw_commands_head;
+        renderer->draw_commands_head = node;
+    }
+
+    return scale * shape.advance_width;
+}
+
+// Returns the shape's scaled advance_width
+JK_PUBLIC float jk_shapes_sdf_draw(JkShapesRenderer *renderer,
+        int64_t shape_index,
+        JkVec2 position,
+        float scale,
+        JkColor color) {
+    JkShape shape = renderer->shapes.e[shape_index];
+
+    if (shape.dimensions.x && shape.dimensions.y) {
+        JkShapesBitmap sdf = jk_shapes_sdf_get(renderer, shape_index);
+        float pixel_scale = scale * renderer->pixels_per_unit;
+        float sdf_pixel_scale = jk_shapes_sdf_pixel_scale_get(shape);
+
+        // Snap the origin to a pixel like jk_shapes_draw does, so glyphs line up the same way
+        JkVec2 origin = jk_vec2_from_i32(
+                jk_vec2_round(jk_vec2_mul(renderer->pixels_per_unit, position)));
+        JkVec2 min = jk_vec2_add(origin, jk_vec2_mul(pixel_scale, shape.offset));
+        JkVec2 max = jk_vec2_add(min, jk_vec2_mul(pixel_scale, shape.dimensions));
+
+        JkShapesDrawCommandListNode *node = jk_arena_push(renderer->arena, JK_SIZEOF(*node));
+        node->command.color = color;
+        // Leave a pixel on each side for the antialiased edge
+        node->command.rect.min.x = (int32_t)jk_floor_f32(min.x) - 1;
+        node->command.rect.min.y = (int32_t)jk_floor_f32(min.y) - 1;
+        node->command.rect.max.x = (int32_t)jk_ceil_f32(max.x) + 1;
+        node->command.rect.max.y = (int32_t)jk_ceil_f32(max.y) + 1;
+        node->command.alpha_map_stride = sdf.stride;
+        node->command.alpha_map = sdf.data;
+        node->command.alpha_map_key = jk_shapes_sdf_key_get(shape_index);
+        node->command.sdf_step = sdf_pixel_scale / pixel_scale;
+        node->command.sdf_origin = jk_vec2_add(jk_shapes_sdf_offset_get(shape, sdf_pixel_scale),
+                jk_vec2_mul(node->command.sdf_step,
+                        jk_vec2_sub(jk_vec2_add(jk_vec2_from_i32(node->command.rect.min),
+                                            (JkVec2){0.5f, 0.5f}),
+                                origin)));
+        node->command.sdf_dimensions = sdf.dimensions;
         node->next = renderer->draw_commands_head;
         renderer->draw_commands_head = node;
     }
@@ -636,3 +1276,804 @@ JK_PUBLIC JkShapesDrawCommandArray jk_shapes_draw_commands_get(JkShapesRenderer
 
     return result;
 }
+
+// ---- Tiles begin ------------------------------------------------------------
+
+JK_PUBLIC JkShapesTiles jk_shapes_tiles_get(JkShapesRenderer *renderer, JkIntVec2 dimensions) {
+    JkShapesTiles tiles = {.dimensions = dimensions};
+    tiles.counts.x = (dimensions.x + JK_SHAPES_TILE_SIDE_LENGTH - 1) / JK_SHAPES_TILE_SIDE_LENGTH;
+    tiles.counts.y = (dimensions.y + JK_SHAPES_TILE_SIDE_LENGTH - 1) / JK_SHAPES_TILE_SIDE_LENGTH;
+    int64_t tile_count = (int64_t)tiles.counts.x * tiles.counts.y;
+
+    // The list runs from the most recent command back, so fill the array from the end
+    for (JkShapesDrawCommandListNode *node = renderer->draw_commands_head; node;
+            node = node->next) {
+        tiles.commands.count++;
+    }
+    tiles.commands.e =
+            jk_arena_push(renderer->arena, JK_SIZEOF(tiles.commands.e[0]) * tiles.commands.count);
+    int64_t command_index = tiles.commands.count;
+    for (JkShapesDrawCommandListNode *node = renderer->draw_commands_head; node;
+            node = node->next) {
+        tiles.commands.e[--command_index] = node->command;
+    }
+
+    // Counting sort the commands into every tile they overlap. Visiting them in draw order keeps
+    // each tile's commands in draw order too.
+    JkIntRect screen_rect = {.max = dimensions};
+    JkIntRect *tile_ranges =
+            jk_arena_push(renderer->arena, JK_SIZEOF(JkIntRect) * tiles.commands.count);
+    int32_t *tile_cursors =
+            jk_arena_push_zero(renderer->arena, JK_SIZEOF(int32_t) * (tile_count + 1));
+    for (int64_t i = 0; i < tiles.commands.count; i++) {
+        JkIntRect rect = jk_int_rect_intersect(screen_rect, tiles.commands.e[i].rect);
+        if (rect.min.x < rect.max.x && rect.min.y < rect.max.y) {
+            tile_ranges[i].min.x = rect.min.x / JK_SHAPES_TILE_SIDE_LENGTH;
+            tile_ranges[i].min.y = rect.min.y / JK_SHAPES_TILE_SIDE_LENGTH;
+            tile_ranges[i].max.x = (rect.max.x - 1) / JK_SHAPES_TILE_SIDE_LENGTH + 1;
+            tile_ranges[i].max.y = (rect.max.y - 1) / JK_SHAPES_TILE_SIDE_LENGTH + 1;
+        } else {
+            tile_ranges[i] = (JkIntRect){0};
+        }
+        for (int32_t y = tile_ranges[i].min.y; y < tile_ranges[i].max.y; y++) {
+            for (int32_t x = tile_ranges[i].min.x; x < tile_ranges[i].max.x; x++) {
+                tile_cursors[y * tiles.counts.x + x]++;
+            }
+        }
+    }
+    tiles.command_starts =
+            jk_arena_push(renderer->arena, JK_SIZEOF(int32_t) * (tile_count + 1));
+    tiles.command_starts[0] = 0;
+    for (int64_t i = 0; i < tile_count; i++) {
+        tiles.command_starts[i + 1] = tiles.command_starts[i] + tile_cursors[i];
+        tile_cursors[i] = tiles.command_starts[i];
+    }
+    tiles.command_indexes = jk_arena_push(
+            renderer->arena, JK_SIZEOF(int32_t) * tiles.command_starts[tile_count]);
+    for (int64_t i = 0; i < tiles.commands.count; i++) {
+        for (int32_t y = tile_ranges[i].min.y; y < tile_ranges[i].max.y; y++) {
+            for (int32_t x = tile_ranges[i].min.x; x < tile_ranges[i].max.x; x++) {
+                tiles.command_indexes[tile_cursors[y * tiles.counts.x + x]++] = (int32_t)i;
+            }
+        }
+    }
+
+    tiles.hashes = jk_arena_push(renderer->arena, JK_SIZEOF(uint64_t) * tile_count);
+    for (int64_t i = 0; i < tile_count; i++) {
+        uint64_t hash = jk_hash_uint64(tiles.command_starts[i + 1] - tiles.command_starts[i]);
+        for (int32_t j = tiles.command_starts[i]; j < tiles.command_starts[i + 1]; j++) {
+            JkShapesDrawCommand *command = tiles.commands.e + tiles.command_indexes[j];
+            uint32_t color;
+            jk_memcpy(&color, command->color.v, JK_SIZEOF(color));
+            hash = jk_hash_uint64(hash ^ (uint32_t)command->rect.min.x
+                    ^ ((uint64_t)(uint32_t)command->rect.min.y << 32));
+            hash = jk_hash_uint64(hash ^ (uint32_t)command->rect.max.x
+                    ^ ((uint64_t)(uint32_t)command->rect.max.y << 32));
+            hash = jk_hash_uint64(hash ^ color);
+            hash = jk_hash_uint64(hash ^ (uint64_t)command->alpha_map_key);
+            if (command->sdf_step) {
+                // An SDF glyph's key doesn't capture the scale or position it's sampled at
+                uint32_t sdf_bits[3];
+                jk_memcpy(sdf_bits + 0, &command->sdf_step, JK_SIZEOF(sdf_bits[0]));
+                jk_memcpy(sdf_bits + 1, &command->sdf_origin.x, JK_SIZEOF(sdf_bits[0]));
+                jk_memcpy(sdf_bits + 2, &command->sdf_origin.y, JK_SIZEOF(sdf_bits[0]));
+                hash = jk_hash_uint64(hash ^ sdf_bits[0] ^ ((uint64_t)sdf_bits[1] << 32));
+                hash = jk_hash_uint64(hash ^ sdf_bits[2]);
+            }
+        }
+        tiles.hashes[i] = hash;
+    }
+
+    return tiles;
+}
+
+JK_PUBLIC JkIntRect jk_shapes_tile_rect_get(JkShapesTiles *tiles, int64_t tile_index) {
+    JkIntRect rect;
+    rect.min.x = (int32_t)(tile_index % tiles->counts.x) * JK_SHAPES_TILE_SIDE_LENGTH;
+    rect.min.y = (int32_t)(tile_index / tiles->counts.x) * JK_SHAPES_TILE_SIDE_LENGTH;
+    rect.max.x = JK_MIN(rect.min.x + JK_SHAPES_TILE_SIDE_LENGTH, tiles->dimensions.x);
+    rect.max.y = JK_MIN(rect.min.y + JK_SHAPES_TILE_SIDE_LENGTH, tiles->dimensions.y);
+    return rect;
+}
+
+// Divides both 16-bit halves of every lane by 255, rounding down. Exact for halves up to 255 * 255,
+// which is as large as a sum of two 8-bit products weighted by alpha and 255 - alpha gets.
+static JkI256 jk_shapes_div_255_x2(JkI256 x) {
+    JkI256 mask = jk_i256_broadcast_i32(0x00ff00ff);
+    JkI256 high = jk_i256_and(JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(x, 8), mask);
+    x = jk_i256_add_i32(jk_i256_add_i32(x, jk_i256_broadcast_i32(0x00010001)), high);
+    return jk_i256_and(JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(x, 8), mask);
+}
+
+static float jk_shapes_lane_offsets[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+// Samples an SDF glyph row, already blended between its two texel rows, at 8 texel x coordinates
+// and turns the distances into alphas scaled by color_alpha
+static JkI256 jk_shapes_sdf_alpha_get(
+        float *sdf_row, JkF32x8 sdf_x, float sdf_x_max, float sdf_ramp, float color_alpha) {
+    JkF32x8 x_max = jk_f32x8_broadcast(sdf_x_max);
+    sdf_x = jk_f32x8_min(jk_f32x8_max(sdf_x, jk_f32x8_zero()), x_max);
+    JkF32x8 x0 = jk_f32x8_floor(sdf_x);
+    JkF32x8 x1 = jk_f32x8_min(jk_f32x8_add(x0, jk_f32x8_broadcast(1)), x_max);
+    JkF32x8 value = jk_f32x8_lerp(jk_f32x8_gather(sdf_row, jk_i32x8_from_f32x8_truncate(x0)),
+            jk_f32x8_gather(sdf_row, jk_i32x8_from_f32x8_truncate(x1)),
+            jk_f32x8_sub(sdf_x, x0));
+
+    JkF32x8 coverage = jk_f32x8_add(jk_f32x8_broadcast(0.5f),
+            jk_f32x8_mul(jk_f32x8_sub(value, jk_f32x8_broadcast(127.5f)),
+                    jk_f32x8_broadcast(sdf_ramp)));
+    coverage = jk_f32x8_min(jk_f32x8_max(coverage, jk_f32x8_zero()), jk_f32x8_broadcast(1));
+    return jk_i32x8_from_f32x8_truncate(jk_f32x8_add(
+            jk_f32x8_mul(coverage, jk_f32x8_broadcast(color_alpha)), jk_f32x8_broadcast(0.5f)));
+}
+
+JK_PUBLIC void jk_shapes_tile_composite(
+        JkShapesTiles *tiles, int64_t tile_index, JkColor *buffer, int64_t buffer_stride) {
+    JkIntRect tile_rect = jk_shapes_tile_rect_get(tiles, tile_index);
+    JkI256 channel_mask = jk_i256_broadcast_i32(0x00ff00ff);
+    JkI256 max_alpha = jk_i256_broadcast_i32(255);
+    JkI256 opaque = jk_i256_broadcast_i32((int32_t)0xff000000);
+    JkF32x8 lane_offsets = jk_f32x8_load(jk_shapes_lane_offsets);
+    float sdf_row[JK_SHAPES_SDF_SIDE_LENGTH];
+
+    for (int32_t i = tiles->command_starts[tile_index]; i < tiles->command_starts[tile_index + 1];
+            i++) {
+        JkShapesDrawCommand *command = tiles->commands.e + tiles->command_indexes[i];
+        JkIntRect rect = jk_int_rect_intersect(tile_rect, command->rect);
+        JkColor color = command->color;
+
+        // Red and blue share a lane, as do green and alpha, so each multiply covers two channels
+        uint32_t color_bits;
+        jk_memcpy(&color_bits, color.v, JK_SIZEOF(color_bits));
+        JkI256 color_rb = jk_i256_broadcast_i32(color_bits & 0x00ff00ff);
+        JkI256 color_ga = jk_i256_broadcast_i32((color_bits >> 8) & 0x00ff00ff);
+        JkI256 color_alpha = jk_i256_broadcast_i32(color.a);
+
+        // SDF coverage ramps from 0 to 1 across one pixel centered on the outline. Values are in
+        // 8-bit steps of JK_SHAPES_SDF_SPREAD / 127.5 texels, and a pixel spans sdf_step texels.
+        float sdf_ramp = 0;
+        float sdf_x_min = 0;
+        float sdf_x_max = 0;
+        JkF32x8 sdf_x_steps = jk_f32x8_zero();
+        int32_t sdf_column_start = 0; // Texel columns the pixels in rect sample from
+        int32_t sdf_column_end = 0;
+        if (command->sdf_step) {
+            sdf_ramp = JK_SHAPES_SDF_SPREAD / (127.5f * command->sdf_step);
+            sdf_x_min = command->sdf_origin.x - 0.5f
+                    + command->sdf_step * (float)(rect.min.x - command->rect.min.x);
+            sdf_x_max = (float)(command->sdf_dimensions.x - 1);
+            sdf_x_steps = jk_f32x8_mul(lane_offsets, jk_f32x8_broadcast(command->sdf_step));
+            sdf_column_start = (int32_t)JK_CLAMP(sdf_x_min, 0, sdf_x_max);
+            sdf_column_end = (int32_t)JK_CLAMP(
+                                     sdf_x_min + command->sdf_step * (rect.max.x - rect.min.x),
+                                     0,
+                                     sdf_x_max)
+                    + 2;
+            sdf_column_end = JK_MIN(sdf_column_end, command->sdf_dimensions.x);
+        }
+
+        for (int32_t y = rect.min.y; y < rect.max.y; y++) {
+            JkColor *row = buffer + y * buffer_stride + rect.min.x;
+            uint8_t *alpha_row = 0;
+            if (command->sdf_step) {
+                // Blend the two texel rows around this pixel row, so each pixel only has to
+                // interpolate horizontally between two gathered values
+                float sdf_y = command->sdf_origin.y - 0.5f
+                        + command->sdf_step * (float)(y - command->rect.min.y);
+                sdf_y = JK_CLAMP(sdf_y, 0, (float)(command->sdf_dimensions.y - 1));
+                int32_t sdf_y0 = (int32_t)sdf_y;
+                int32_t sdf_y1 = JK_MIN(sdf_y0 + 1, command->sdf_dimensions.y - 1);
+                float sdf_y_frac = sdf_y - (float)sdf_y0;
+                uint8_t *row0 = command->alpha_map + (int64_t)sdf_y0 * command->alpha_map_stride;
+                uint8_t *row1 = command->alpha_map + (int64_t)sdf_y1 * command->alpha_map_stride;
+                int32_t sdf_x = sdf_column_start;
+                for (; sdf_x + 8 <= sdf_column_end; sdf_x += 8) {
+                    jk_f32x8_store(sdf_row + sdf_x,
+                            jk_f32x8_lerp(jk_f32x8_from_i32x8(jk_i32x8_load_u8(row0 + sdf_x)),
+                                    jk_f32x8_from_i32x8(jk_i32x8_load_u8(row1 + sdf_x)),
+                                    jk_f32x8_broadcast(sdf_y_frac)));
+                }
+                for (; sdf_x < sdf_column_end; sdf_x++) {
+                    sdf_row[sdf_x] = jk_f32_lerp(row0[sdf_x], row1[sdf_x], sdf_y_frac);
+                }
+            } else if (command->alpha_map) {
+                alpha_row = command->alpha_map
+                        + (int64_t)(y - command->rect.min.y) * command->alpha_map_stride
+                        + (rect.min.x - command->rect.min.x);
+            }
+            int32_t width = rect.max.x - rect.min.x;
+            int32_t x = 0;
+            for (; x + 8 <= width; x += 8) {
+                JkI256 alpha = color_alpha;
+                if (command->sdf_step) {
+                    JkF32x8 sdf_x = jk_f32x8_add(
+                            jk_f32x8_broadcast(sdf_x_min + command->sdf_step * (float)x),
+                            sdf_x_steps);
+                    alpha = jk_shapes_sdf_alpha_get(sdf_row, sdf_x, sdf_x_max, sdf_ramp, color.a);
+                } else if (alpha_row) {
+                    alpha = jk_shapes_div_255_x2(
+                            jk_i256_mul_i32(jk_i32x8_load_u8(alpha_row + x), color_alpha));
+                }
+                JkI256 inverse_alpha = jk_i256_sub_i32(max_alpha, alpha);
+
+                JkI256 pixels = jk_i256_load(row + x);
+                JkI256 rb = jk_i256_and(pixels, channel_mask);
+                JkI256 ga = jk_i256_and(JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(pixels, 8), channel_mask);
+                rb = jk_shapes_div_255_x2(jk_i256_add_i32(
+                        jk_i256_mul_i32(color_rb, alpha), jk_i256_mul_i32(rb, inverse_alpha)));
+                ga = jk_shapes_div_255_x2(jk_i256_add_i32(
+                        jk_i256_mul_i32(color_ga, alpha), jk_i256_mul_i32(ga, inverse_alpha)));
+
+                // Blending always leaves the destination opaque
+                JkI256 g = jk_i256_and(
+                        JK_I256_SHIFT_LEFT_I32(ga, 8), jk_i256_broadcast_i32(0x0000ff00));
+                jk_i256_store(row + x, jk_i256_or(jk_i256_or(rb, g), opaque));
+            }
+            for (; x < width; x++) {
+                uint8_t alpha = color.a;
+                if (command->sdf_step) {
+                    float sdf_x = JK_CLAMP(
+                            sdf_x_min + command->sdf_step * (float)x, 0, sdf_x_max);
+                    int32_t sdf_x0 = (int32_t)sdf_x;
+                    int32_t sdf_x1 = JK_MIN(sdf_x0 + 1, (int32_t)sdf_x_max);
+                    float value =
+                            jk_f32_lerp(sdf_row[sdf_x0], sdf_row[sdf_x1], sdf_x - (float)sdf_x0);
+                    float coverage = JK_CLAMP(0.5f + (value - 127.5f) * sdf_ramp, 0, 1);
+                    alpha = (uint8_t)(coverage * color.a + 0.5f);
+                } else if (alpha_row) {
+                    alpha = (uint8_t)(((uint32_t)color.a * alpha_row[x]) / 255);
+                }
+                row[x] = jk_color_alpha_blend(color, row[x], alpha);
+            }
+        }
+    }
+}
+
+// ---- Tiles end --------------------------------------------------------------
+
+// ---- Font begin -------------------------------------------------------------
+
+#define JK_SHAPES_FONT_TAG(a, b, c, d) \
+    (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+// Composite glyphs nest their components. Real fonts go a level or two deep, so anything past this
+// is a cycle in a malformed file.
+#define JK_SHAPES_FONT_COMPOSITE_DEPTH_MAX 8
+
+typedef enum JkShapesFontPointFlag {
+    JK_SHAPES_FONT_POINT_FLAG_ON_CURVE,
+    JK_SHAPES_FONT_POINT_FLAG_X_SHORT,
+    JK_SHAPES_FONT_POINT_FLAG_Y_SHORT,
+    JK_SHAPES_FONT_POINT_FLAG_REPEAT,
+    JK_SHAPES_FONT_POINT_FLAG_X_SAME_OR_POSITIVE,
+    JK_SHAPES_FONT_POINT_FLAG_Y_SAME_OR_POSITIVE,
+} JkShapesFontPointFlag;
+
+typedef enum JkShapesFontComponentFlag {
+    JK_SHAPES_FONT_COMPONENT_FLAG_ARGS_ARE_WORDS,
+    JK_SHAPES_FONT_COMPONENT_FLAG_ARGS_ARE_XY,
+    JK_SHAPES_FONT_COMPONENT_FLAG_ROUND_TO_GRID,
+    JK_SHAPES_FONT_COMPONENT_FLAG_SCALE,
+    JK_SHAPES_FONT_COMPONENT_FLAG_RESERVED,
+    JK_SHAPES_FONT_COMPONENT_FLAG_MORE_COMPONENTS,
+    JK_SHAPES_FONT_COMPONENT_FLAG_X_AND_Y_SCALE,
+    JK_SHAPES_FONT_COMPONENT_FLAG_TWO_BY_TWO,
+} JkShapesFontComponentFlag;
+
+typedef struct JkShapesFontPoint {
+    JkVec2 position;
+    b32 on_curve;
+    b32 contour_end;
+} JkShapesFontPoint;
+
+// TrueType is big-endian. Reads past the end of the file return 0, so a truncated or malformed
+// font gives broken glyphs rather than reading out of bounds.
+static uint32_t jk_shapes_font_read(JkShapesFont *font, int64_t offset, int64_t size) {
+    uint32_t result = 0;
+    if (0 <= offset && offset + size <= font->file.size) {
+        for (int64_t i = 0; i < size; i++) {
+            result = (result << 8) | font->file.data[offset + i];
+        }
+    }
+    return result;
+}
+
+static uint32_t jk_shapes_font_u8(JkShapesFont *font, int64_t offset) {
+    return jk_shapes_font_read(font, offset, 1);
+}
+
+static uint32_t jk_shapes_font_u16(JkShapesFont *font, int64_t offset) {
+    return jk_shapes_font_read(font, offset, 2);
+}
+
+static int32_t jk_shapes_font_i16(JkShapesFont *font, int64_t offset) {
+    return (int16_t)jk_shapes_font_read(font, offset, 2);
+}
+
+static uint32_t jk_shapes_font_u32(JkShapesFont *font, int64_t offset) {
+    return jk_shapes_font_read(font, offset, 4);
+}
+
+// Fixed point with 14 fractional bits
+static float jk_shapes_font_f2dot14(JkShapesFont *font, int64_t offset) {
+    return (float)jk_shapes_font_i16(font, offset) / 16384.0f;
+}
+
+JK_PUBLIC b32 jk_shapes_font_init(JkShapesFont *font, JkBuffer file, JkArena *arena) {
+    *font = (JkShapesFont){.file = file, .arena = arena};
+
+    // Use the first font of a collection
+    int64_t start = 0;
+    if (jk_shapes_font_u32(font, 0) == JK_SHAPES_FONT_TAG('t', 't', 'c', 'f')) {
+        start = jk_shapes_font_u32(font, 12);
+    }
+
+    int64_t head = 0;
+    int64_t hhea = 0;
+    int64_t maxp = 0;
+    int64_t cmap = 0;
+    int64_t table_count = jk_shapes_font_u16(font, start + 4);
+    for (int64_t i = 0; i < table_count; i++) {
+        int64_t record = start + 12 + 16 * i;
+        int64_t offset = jk_shapes_font_u32(font, record + 8);
+        switch (jk_shapes_font_u32(font, record)) {
+        case JK_SHAPES_FONT_TAG('c', 'm', 'a', 'p'): {
+            cmap = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('g', 'l', 'y', 'f'): {
+            font->glyf = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('h', 'e', 'a', 'd'): {
+            head = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('h', 'h', 'e', 'a'): {
+            hhea = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('h', 'm', 't', 'x'): {
+            font->hmtx = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('l', 'o', 'c', 'a'): {
+            font->loca = offset;
+        } break;
+
+        case JK_SHAPES_FONT_TAG('m', 'a', 'x', 'p'): {
+            maxp = offset;
+        } break;
+        }
+    }
+    if (!(head && hhea && maxp && cmap && font->glyf && font->hmtx && font->loca)) {
+        return 0;
+    }
+
+    font->units_per_em = (float)jk_shapes_font_u16(font, head + 18);
+    font->loca_long = jk_shapes_font_i16(font, head + 50) != 0;
+    font->glyph_count = jk_shapes_font_u16(font, maxp + 4);
+    font->ascent = (float)-jk_shapes_font_i16(font, hhea + 4);
+    font->descent = (float)-jk_shapes_font_i16(font, hhea + 6);
+    font->line_gap = (float)jk_shapes_font_i16(font, hhea + 8);
+    font->h_metric_count = jk_shapes_font_u16(font, hhea + 34);
+
+    // Prefer a subtable covering all of Unicode, then one covering the Basic Multilingual Plane
+    int64_t subtable_count = jk_shapes_font_u16(font, cmap + 2);
+    for (int64_t i = 0; i < subtable_count; i++) {
+        int64_t record = cmap + 4 + 8 * i;
+        uint32_t platform = jk_shapes_font_u16(font, record);
+        uint32_t encoding = jk_shapes_font_u16(font, record + 2);
+        int64_t subtable = cmap + jk_shapes_font_u32(font, record + 4);
+        uint32_t format = jk_shapes_font_u16(font, subtable);
+        if (platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10))) {
+            if (format == 12) {
+                font->cmap = subtable;
+                break;
+            }
+            if (format == 4 && !font->cmap) {
+                font->cmap = subtable;
+            }
+        }
+    }
+    if (!font->cmap || !font->h_metric_count) {
+        return 0;
+    }
+
+    font->shapes.e = jk_arena_push_zero(arena, JK_SIZEOF(JkShape) * JK_SHAPES_FONT_GLYPH_CAPACITY);
+    font->slot_keys = jk_arena_push_zero(
+            arena, JK_SIZEOF(*font->slot_keys) * 2 * JK_SHAPES_FONT_GLYPH_CAPACITY);
+    font->slot_values = jk_arena_push_zero(
+            arena, JK_SIZEOF(*font->slot_values) * 2 * JK_SHAPES_FONT_GLYPH_CAPACITY);
+
+    return 1;
+}
+
+static int64_t jk_shapes_font_glyph_index_get(JkShapesFont *font, uint32_t codepoint) {
+    int64_t result = 0;
+
+    if (jk_shapes_font_u16(font, font->cmap) == 4) {
+        // Segments of consecutive codepoints, as parallel arrays sorted by each segment's end
+        int64_t segment_count = jk_shapes_font_u16(font, font->cmap + 6) / 2;
+        int64_t ends = font->cmap + 14;
+        int64_t starts = ends + 2 * segment_count + 2;
+        int64_t deltas = starts + 2 * segment_count;
+        int64_t range_offsets = deltas + 2 * segment_count;
+
+        int64_t low = 0;
+        int64_t high = segment_count;
+        while (low < high) {
+            int64_t mid = (low + high) / 2;
+            if (jk_shapes_font_u16(font, ends + 2 * mid) < codepoint) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        uint32_t start = jk_shapes_font_u16(font, starts + 2 * low);
+        if (low < segment_count && start <= codepoint && codepoint <= 0xffff) {
+            uint32_t delta = jk_shapes_font_u16(font, deltas + 2 * low);
+            int64_t range_offset_position = range_offsets + 2 * low;
+            int64_t range_offset = jk_shapes_font_u16(font, range_offset_position);
+            if (range_offset) {
+                // The offset is relative to where it's stored and leads into the glyph index array
+                uint32_t glyph = jk_shapes_font_u16(
+                        font, range_offset_position + range_offset + 2 * (codepoint - start));
+                result = glyph ? (glyph + delta) & 0xffff : 0;
+            } else {
+                result = (codepoint + delta) & 0xffff;
+            }
+        }
+    } else {
+        // Groups of consecutive codepoints mapping to consecutive glyphs, sorted by codepoint
+        int64_t group_count = jk_shapes_font_u32(font, font->cmap + 12);
+        int64_t groups = font->cmap + 16;
+
+        int64_t low = 0;
+        int64_t high = group_count;
+        while (low < high) {
+            int64_t mid = (low + high) / 2;
+            if (jk_shapes_font_u32(font, groups + 12 * mid + 4) < codepoint) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        int64_t group = groups + 12 * low;
+        uint32_t start = jk_shapes_font_u32(font, group);
+        if (low < group_count && start <= codepoint) {
+            result = jk_shapes_font_u32(font, group + 8) + (codepoint - start);
+        }
+    }
+
+    return result < font->glyph_count ? result : 0;
+}
+
+// Byte range of the glyph's data in the file, empty for glyphs without an outline
+static JkSpan jk_shapes_font_glyph_span_get(JkShapesFont *font, int64_t glyph_index) {
+    JkSpan result = {0};
+    if (0 <= glyph_index && glyph_index < font->glyph_count) {
+        int64_t start, end;
+        if (font->loca_long) {
+            start = jk_shapes_font_u32(font, font->loca + 4 * glyph_index);
+            end = jk_shapes_font_u32(font, font->loca + 4 * (glyph_index + 1));
+        } else {
+            start = 2 * (int64_t)jk_shapes_font_u16(font, font->loca + 2 * glyph_index);
+            end = 2 * (int64_t)jk_shapes_font_u16(font, font->loca + 2 * (glyph_index + 1));
+        }
+        if (start < end) {
+            result.offset = font->glyf + start;
+            result.size = end - start;
+        }
+    }
+    return result;
+}
+
+// Applies a TrueType component transform, where x' = m[0][0] x + m[0][1] y + m[0][2] and
+// y' = m[1][0] x + m[1][1] y + m[1][2]
+static JkVec2 jk_shapes_font_transform(float m[2][3], JkVec2 v) {
+    return (JkVec2){
+        m[0][0] * v.x + m[0][1] * v.y + m[0][2],
+        m[1][0] * v.x + m[1][1] * v.y + m[1][2],
+    };
+}
+
+// Pushes the glyph's outline points onto the arena in font units, transformed by m. Composite
+// glyphs push each of their components in turn.
+static void jk_shapes_font_points_push(
+        JkShapesFont *font, JkArena *arena, int64_t glyph_index, float m[2][3], int32_t depth) {
+    JkSpan glyph = jk_shapes_font_glyph_span_get(font, glyph_index);
+    if (!glyph.size || JK_SHAPES_FONT_COMPOSITE_DEPTH_MAX < depth) {
+        return;
+    }
+
+    int64_t contour_count = jk_shapes_font_i16(font, glyph.offset);
+    if (0 <= contour_count) {
+        int64_t contour_ends = glyph.offset + 10;
+        int64_t point_count = contour_count
+                ? jk_shapes_font_u16(font, contour_ends + 2 * (contour_count - 1)) + 1
+                : 0;
+        int64_t instruction_size = jk_shapes_font_u16(font, contour_ends + 2 * contour_count);
+        int64_t flags_start = contour_ends + 2 * contour_count + 2 + instruction_size;
+
+        // The x coordinates follow the flags and the y coordinates follow those, each taking 0, 1,
+        // or 2 bytes per point depending on its flags. Find where both start before decoding.
+        int64_t pos = flags_start;
+        int64_t x_size = 0;
+        for (int64_t i = 0; i < point_count && pos < font->file.size;) {
+            uint32_t flags = jk_shapes_font_u8(font, pos++);
+            int64_t repeat_count = 1;
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_REPEAT)) {
+                repeat_count += jk_shapes_font_u8(font, pos++);
+            }
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_X_SHORT)) {
+                x_size += repeat_count;
+            } else if (!JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_X_SAME_OR_POSITIVE)) {
+                x_size += 2 * repeat_count;
+            }
+            i += repeat_count;
+        }
+        int64_t x_pos = pos;
+        int64_t y_pos = pos + x_size;
+
+        int64_t flags_pos = flags_start;
+        uint32_t flags = 0;
+        int64_t repeats_left = 0;
+        JkIntVec2 point = {0};
+        int64_t contour_index = 0;
+        for (int64_t i = 0; i < point_count; i++) {
+            if (repeats_left) {
+                repeats_left--;
+            } else {
+                flags = jk_shapes_font_u8(font, flags_pos++);
+                if (JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_REPEAT)) {
+                    repeats_left = jk_shapes_font_u8(font, flags_pos++);
+                }
+            }
+
+            // Coordinates are deltas from the previous point. Short ones are unsigned bytes with
+            // the sign in a flag, and long ones are signed 16-bit values unless the flag says the
+            // coordinate didn't change.
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_X_SHORT)) {
+                int32_t delta = (int32_t)jk_shapes_font_u8(font, x_pos++);
+                point.x += JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_X_SAME_OR_POSITIVE)
+                        ? delta
+                        : -delta;
+            } else if (!JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_X_SAME_OR_POSITIVE)) {
+                point.x += jk_shapes_font_i16(font, x_pos);
+                x_pos += 2;
+            }
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_Y_SHORT)) {
+                int32_t delta = (int32_t)jk_shapes_font_u8(font, y_pos++);
+                point.y += JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_Y_SAME_OR_POSITIVE)
+                        ? delta
+                        : -delta;
+            } else if (!JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_Y_SAME_OR_POSITIVE)) {
+                point.y += jk_shapes_font_i16(font, y_pos);
+                y_pos += 2;
+            }
+
+            JkShapesFontPoint *new_point = jk_arena_push(arena, JK_SIZEOF(*new_point));
+            new_point->position = jk_shapes_font_transform(m, jk_vec2_from_i32(point));
+            new_point->on_curve = JK_FLAG_GET(flags, JK_SHAPES_FONT_POINT_FLAG_ON_CURVE);
+            new_point->contour_end =
+                    i == jk_shapes_font_u16(font, contour_ends + 2 * contour_index);
+            if (new_point->contour_end) {
+                contour_index++;
+            }
+        }
+    } else {
+        int64_t pos = glyph.offset + 10;
+        uint32_t flags;
+        do {
+            flags = jk_shapes_font_u16(font, pos);
+            int64_t component = jk_shapes_font_u16(font, pos + 2);
+            pos += 4;
+
+            float c[2][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+            // Arguments that aren't an offset pair points of the component up with the glyph's,
+            // which is rare enough to leave the component unmoved
+            b32 args_are_xy = JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_ARGS_ARE_XY);
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_ARGS_ARE_WORDS)) {
+                if (args_are_xy) {
+                    c[0][2] = (float)jk_shapes_font_i16(font, pos);
+                    c[1][2] = (float)jk_shapes_font_i16(font, pos + 2);
+                }
+                pos += 4;
+            } else {
+                if (args_are_xy) {
+                    c[0][2] = (float)(int8_t)jk_shapes_font_u8(font, pos);
+                    c[1][2] = (float)(int8_t)jk_shapes_font_u8(font, pos + 1);
+                }
+                pos += 2;
+            }
+            if (JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_SCALE)) {
+                c[0][0] = c[1][1] = jk_shapes_font_f2dot14(font, pos);
+                pos += 2;
+            } else if (JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_X_AND_Y_SCALE)) {
+                c[0][0] = jk_shapes_font_f2dot14(font, pos);
+                c[1][1] = jk_shapes_font_f2dot14(font, pos + 2);
+                pos += 4;
+            } else if (JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_TWO_BY_TWO)) {
+                c[0][0] = jk_shapes_font_f2dot14(font, pos);
+                c[1][0] = jk_shapes_font_f2dot14(font, pos + 2);
+                c[0][1] = jk_shapes_font_f2dot14(font, pos + 4);
+                c[1][1] = jk_shapes_font_f2dot14(font, pos + 6);
+                pos += 8;
+            }
+
+            // Apply the component's transform first, then the glyph's
+            float combined[2][3];
+            for (int32_t row = 0; row < 2; row++) {
+                for (int32_t column = 0; column < 3; column++) {
+                    combined[row][column] = m[row][0] * c[0][column] + m[row][1] * c[1][column]
+                            + (column == 2 ? m[row][2] : 0.0f);
+                }
+            }
+            jk_shapes_font_points_push(font, arena, component, combined, depth + 1);
+        } while (JK_FLAG_GET(flags, JK_SHAPES_FONT_COMPONENT_FLAG_MORE_COMPONENTS)
+                && pos < glyph.offset + glyph.size);
+    }
+}
+
+static void jk_shapes_font_command_push(
+        JkArena *arena, JkShapesPenCommandType type, JkVec2 v0, JkVec2 v1) {
+    JkShapesPenCommand *new_command = jk_arena_push_zero(arena, JK_SIZEOF(*new_command));
+    new_command->type = type;
+    new_command->v[0] = v0;
+    new_command->v[1] = v1;
+}
+
+// Converts outline points to pen commands. Between two off-curve points there's an implied
+// on-curve point halfway, and each contour closes back to where it started.
+static void jk_shapes_font_commands_push(
+        JkArena *arena, JkShapesFontPoint *points, int64_t point_count) {
+    int64_t contour_start = 0;
+    for (int64_t i = 0; i < point_count; i++) {
+        if (!points[i].contour_end) {
+            continue;
+        }
+        JkShapesFontPoint *contour = points + contour_start;
+        int64_t count = i + 1 - contour_start;
+        contour_start = i + 1;
+
+        // Start from an on-curve point, taking the last one or the implied point between the
+        // last and first when the first is off the curve
+        JkVec2 start;
+        int64_t first = 0;
+        int64_t end = count;
+        if (contour[0].on_curve) {
+            start = contour[0].position;
+            first = 1;
+        } else if (contour[count - 1].on_curve) {
+            start = contour[count - 1].position;
+            end = count - 1;
+        } else {
+            start = jk_vec2_lerp(contour[0].position, contour[count - 1].position, 0.5f);
+        }
+        jk_shapes_font_command_push(arena, JK_SHAPES_PEN_COMMAND_MOVE, start, (JkVec2){0});
+
+        b32 has_control = 0;
+        JkVec2 control = {0};
+        for (int64_t j = first; j < end; j++) {
+            JkVec2 position = contour[j].position;
+            if (contour[j].on_curve) {
+                if (has_control) {
+                    jk_shapes_font_command_push(
+                            arena, JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC, control, position);
+                } else {
+                    jk_shapes_font_command_push(
+                            arena, JK_SHAPES_PEN_COMMAND_LINE, position, (JkVec2){0});
+                }
+                has_control = 0;
+            } else {
+                if (has_control) {
+                    jk_shapes_font_command_push(arena,
+                            JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC,
+                            control,
+                            jk_vec2_lerp(control, position, 0.5f));
+                }
+                control = position;
+                has_control = 1;
+            }
+        }
+        if (has_control) {
+            jk_shapes_font_command_push(
+                    arena, JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC, control, start);
+        } else {
+            jk_shapes_font_command_push(arena, JK_SHAPES_PEN_COMMAND_LINE, start, (JkVec2){0});
+        }
+    }
+}
+
+JK_PUBLIC int64_t jk_shapes_font_shape_index_get(JkShapesFont *font, uint32_t codepoint) {
+    uint32_t key = codepoint + 1;
+    int64_t slot_mask = 2 * JK_SHAPES_FONT_GLYPH_CAPACITY - 1;
+    int64_t slot = jk_hash_uint32(key) & slot_mask;
+    while (font->slot_keys[slot] && font->slot_keys[slot] != key) {
+        slot = (slot + 1) & slot_mask;
+    }
+    if (font->slot_keys[slot]) {
+        return font->slot_values[slot];
+    }
+    if (font->shapes.count == JK_SHAPES_FONT_GLYPH_CAPACITY) {
+        return -1;
+    }
+
+    int64_t glyph_index = jk_shapes_font_glyph_index_get(font, codepoint);
+    JkShape *shape = font->shapes.e + font->shapes.count;
+    *shape = (JkShape){0};
+
+    int64_t metric = JK_MIN(glyph_index, font->h_metric_count - 1);
+    shape->advance_width = (float)jk_shapes_font_u16(font, font->hmtx + 4 * metric);
+
+    JkSpan glyph = jk_shapes_font_glyph_span_get(font, glyph_index);
+    if (glyph.size) {
+        // The bounding box in the glyph header covers composite glyphs too
+        float x_min = (float)jk_shapes_font_i16(font, glyph.offset + 2);
+        float y_min = (float)jk_shapes_font_i16(font, glyph.offset + 4);
+        float x_max = (float)jk_shapes_font_i16(font, glyph.offset + 6);
+        float y_max = (float)jk_shapes_font_i16(font, glyph.offset + 8);
+        shape->offset = (JkVec2){x_min, -y_max};
+        shape->dimensions = (JkVec2){x_max - x_min, y_max - y_min};
+
+        shape->commands.offset = font->arena->pos;
+        JK_ARENA_SCRATCH_NOT(scratch, font->arena) {
+            // Flip y so it grows downward like the shapes
+            float m[2][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+            JkShapesFontPoint *points = jk_arena_pointer_current(scratch.arena);
+            jk_shapes_font_points_push(font, scratch.arena, glyph_index, m, 0);
+            int64_t point_count = (JkShapesFontPoint *)jk_arena_pointer_current(scratch.arena)
+                    - points;
+            jk_shapes_font_commands_push(font->arena, points, point_count);
+        }
+        shape->commands.size = font->arena->pos - shape->commands.offset;
+    }
+
+    int64_t shape_index = font->shapes.count++;
+    font->slot_keys[slot] = key;
+    font->slot_values[slot] = (int32_t)shape_index;
+    return shape_index;
+}
+
+JK_PUBLIC void jk_shapes_font_renderer_init(JkShapesRenderer *renderer,
+        JkShapesFont *font,
+        float pixels_per_unit,
+        JkArena *arena) {
+    jk_shapes_renderer_init(
+            renderer, pixels_per_unit, font->arena->memory.data, font->shapes, arena);
+}
+
+JK_PUBLIC float jk_shapes_font_text_draw(JkShapesRenderer *renderer,
+        JkShapesFont *font,
+        JkBuffer text,
+        JkVec2 position,
+        float scale,
+        JkColor color) {
+    JK_ASSERT(renderer->shapes.e == font->shapes.e
+            && renderer->base_pointer == font->arena->memory.data);
+
+    JkVec2 cursor = position;
+    int64_t pos = 0;
+    JkUtf8Codepoint codepoint;
+    JkUtf8CodepointGetResult result;
+    while ((result = jk_utf8_codepoint_get(text, &pos, &codepoint))
+            != JK_UTF8_CODEPOINT_GET_EOF) {
+        if (result == JK_UTF8_CODEPOINT_GET_UNEXPECTED_BYTE) {
+            pos++; // Skip stray continuation bytes
+            continue;
+        }
+        int64_t shape_index =
+                jk_shapes_font_shape_index_get(font, jk_utf8_codepoint_decode(codepoint));
+        if (shape_index != -1) {
+            // Pick up any glyphs parsed since the renderer last looked
+            renderer->shapes.count = font->shapes.count;
+            cursor.x += jk_shapes_draw(renderer, shape_index, cursor, scale, color);
+        }
+    }
+    return cursor.x - position.x;
+}
+
+// ---- Font end ---------------------------------------------------------------
@@ -6,6 +6,7 @@
 typedef struct JkShapesBitmap {
     JkIntVec2 offset;
     JkIntVec2 dimensions;
+    int32_t stride; // Bytes between the starts of consecutive rows
     uint8_t *data;
 } JkShapesBitmap;
 
@@ -33,8 +34,66 @@ JK_PUBLIC JkShapesHashTableSlot *jk_shapes_hash_table_probe(JkShapesHashTable *t
 JK_PUBLIC void jk_shapes_hash_table_set(
         JkShapesHashTable *t, JkShapesHashTableSlot *slot, int64_t key, JkShapesBitmap value);
 
+JK_PUBLIC void jk_shapes_hash_table_remove(JkShapesHashTable *t, JkShapesHashTableSlot *slot);
+
 // ---- Hash table end ---------------------------------------------------------
 
+// ---- Atlas begin ------------------------------------------------------------
+
+// Shelf heights are rounded up to a multiple of this so bitmaps of similar heights can share them
+#define JK_SHAPES_ATLAS_SHELF_ALIGNMENT 8
+
+typedef struct JkShapesAtlasShelf {
+    int32_t y;
+    int32_t height;
+    int32_t cursor_x;
+    int64_t frame_used; // Latest atlas frame that looked up a bitmap in this shelf
+} JkShapesAtlasShelf;
+
+typedef struct JkShapesAtlasStats {
+    int64_t hit_count;
+    int64_t miss_count;
+    int64_t eviction_count; // Bitmaps evicted to make room for new ones
+    int64_t overflow_count; // Misses that found no room, so the bitmap only lasts for the frame
+} JkShapesAtlasStats;
+
+// A fixed-size 8-bit page that caches bitmaps across frames. Bitmaps are packed into horizontal
+// shelves. When the page fills up, the least recently used shelf is evicted as a whole. Shelves
+// used in the current frame are never evicted because draw commands still point into them.
+typedef struct JkShapesAtlas {
+    JkIntVec2 dimensions;
+    uint8_t *pixels;
+    int64_t shelf_count;
+    int64_t shelf_capacity;
+    JkShapesAtlasShelf *shelves;
+    JkShapesHashTable hash_table;
+    int64_t frame;
+    JkShapesAtlasStats stats;
+
+    // Shape table the cached bitmaps were drawn from. Keys are only shape indexes and scales, so
+    // the bitmaps mean nothing to renderers over any other table.
+    struct JkShape *shapes;
+} JkShapesAtlas;
+
+// Returns the number of bytes of memory jk_shapes_atlas_init needs to cache up to bitmap_capacity
+// bitmaps at the given dimensions
+JK_PUBLIC int64_t jk_shapes_atlas_memory_size(JkIntVec2 dimensions, int64_t bitmap_capacity);
+
+JK_PUBLIC void jk_shapes_atlas_init(JkShapesAtlas *atlas, JkIntVec2 dimensions, JkBuffer memory);
+
+// ---- Atlas end --------------------------------------------------------------
+
+// SDF glyphs are generated once per shape, scaled so its larger dimension plus the spread on
+// either side spans this many texels, and sampled at whatever scale they're drawn
+#define JK_SHAPES_SDF_SIDE_LENGTH 64
+
+// Distance in texels at which SDF glyph values saturate. Drawing a glyph at less than about
+// 1 / JK_SHAPES_SDF_SPREAD of its reference size blurs it, since the edge ramp no longer fits.
+#define JK_SHAPES_SDF_SPREAD 6.0f
+
+// Distance in texels SDF glyph outlines are allowed to stray from the curves they flatten
+#define JK_SHAPES_SDF_TOLERANCE (1 / 8.0f)
+
 typedef enum JkShapesArcFlag {
     JK_SHAPES_ARC_FLAG_LARGE,
     JK_SHAPES_ARC_FLAG_SWEEP,
@@ -68,11 +127,16 @@ typedef struct JkShapesPenCommandArray {
     JkShapesPenCommand *e;
 } JkShapesPenCommandArray;
 
+// Asset packers can store a shape's outline already flattened at a few tolerances, from coarse to
+// fine, so drawing it doesn't have to flatten its pen commands at runtime
+#define JK_SHAPES_EDGE_LEVEL_COUNT 3
+
 typedef struct JkShape {
     JkVec2 offset;
     JkVec2 dimensions;
     float advance_width;
     JkSpan commands;
+    JkSpan edges[JK_SHAPES_EDGE_LEVEL_COUNT]; // JkEdge arrays in shape units, empty if not packed
 } JkShape;
 
 typedef struct JkShapeArray {
@@ -83,7 +147,15 @@ typedef struct JkShapeArray {
 typedef struct JkShapesDrawCommand {
     JkColor color;
     JkIntRect rect;
+    int32_t alpha_map_stride;
     uint8_t *alpha_map;
+    int64_t alpha_map_key; // Identifies the alpha map's contents, or 0 when there is none
+
+    // Nonzero when alpha_map is an SDF glyph of sdf_dimensions texels rather than coverage. Pixel
+    // (x, y) of rect samples it at sdf_origin + sdf_step * (x - rect.min.x, y - rect.min.y).
+    float sdf_step;
+    JkVec2 sdf_origin;
+    JkIntVec2 sdf_dimensions;
 } JkShapesDrawCommand;
 
 typedef struct JkShapesDrawCommandListNode {
@@ -96,21 +168,38 @@ typedef struct JkShapesDrawCommandArray {
     JkShapesDrawCommand *e;
 } JkShapesDrawCommandArray;
 
+typedef struct JkShapesBitmapRequest {
+    int64_t shape_index;
+    float scale;
+    b32 sdf; // Requests the shape's SDF glyph instead, which doesn't depend on scale
+} JkShapesBitmapRequest;
+
+typedef struct JkShapesBitmapRequestArray {
+    int64_t count;
+    JkShapesBitmapRequest *e;
+} JkShapesBitmapRequestArray;
+
+typedef struct JkShapesPrewarmJob {
+    int64_t shape_index;
+    float pixel_scale;
+    b32 sdf;
+    JkShapesBitmap bitmap;
+} JkShapesPrewarmJob;
+
 typedef struct JkShapesRenderer {
     float pixels_per_unit;
     uint8_t *base_pointer;
     JkShapeArray shapes;
     JkArena *arena;
     JkShapesHashTable hash_table;
+    JkShapesAtlas *atlas; // Optional. Bitmaps are cached here instead of in hash_table when set.
     JkShapesDrawCommandListNode *draw_commands_head;
-} JkShapesRenderer;
 
-typedef struct JkShapesPointListNode {
-    struct JkShapesPointListNode *next;
-    JkVec2 point;
-    float t;
-    b32 is_cursor_movement;
-} JkShapesPointListNode;
+    // Shared by the channel's threads during jk_shapes_prewarm
+    int64_t prewarm_job_count;
+    JkShapesPrewarmJob *prewarm_jobs;
+    int32_t volatile prewarm_job_next;
+} JkShapesRenderer;
 
 JK_PUBLIC void jk_shapes_renderer_init(JkShapesRenderer *renderer,
         float pixels_per_unit,
@@ -118,6 +207,12 @@ JK_PUBLIC void jk_shapes_renderer_init(JkShapesRenderer *renderer,
         JkShapeArray shapes,
         JkArena *arena);
 
+// Makes the renderer cache its bitmaps in the atlas, and starts a new frame of the atlas. Bitmaps
+// used since the previous attach become eligible for eviction. Attaching a renderer over a
+// different shape table than last time empties the atlas, so each shape table, including each
+// font's, should have an atlas of its own.
+JK_PUBLIC void jk_shapes_renderer_atlas_attach(JkShapesRenderer *renderer, JkShapesAtlas *atlas);
+
 JK_PUBLIC JkEdgeArray jk_shapes_edges_get(JkArena *arena,
         JkShapesPenCommandArray commands,
         JkVec2 offset,
@@ -125,6 +220,39 @@ JK_PUBLIC JkEdgeArray jk_shapes_edges_get(JkArena *arena,
         float tolerance,
         b32 skip_horizontal);
 
+// Flattens the shape's pen commands at the first level_count edge levels and pushes the edges onto
+// the arena, pointing shape->edges at them. Offsets are from base_pointer, the same as
+// shape->commands. Shapes only ever drawn small can skip the finer levels to save space.
+JK_PUBLIC void jk_shapes_edges_pack(
+        JkArena *arena, void *base_pointer, JkShape *shape, int64_t level_count);
+
+// Edges binned into square cells of a distance field. Each cell lists every edge that comes within
+// spread of it, so whenever a texel's nearest edge is close enough to matter, it's in the texel's
+// cell.
+typedef struct JkShapesSdfCells {
+    int32_t side_length;
+    JkIntVec2 counts;
+    int32_t *starts; // Where each cell's run of edge_indexes begins, plus where the last one ends
+    int32_t *edge_indexes;
+} JkShapesSdfCells;
+
+JK_PUBLIC JkShapesSdfCells jk_shapes_sdf_cells_get(
+        JkArena *arena, JkEdgeArray edges, JkIntVec2 dimensions, float spread);
+
+// Returns the index into cells->starts of the cell containing the texel
+JK_PUBLIC int32_t jk_shapes_sdf_cell_index_get(JkShapesSdfCells *cells, JkIntVec2 texel);
+
+// Writes an 8-bit signed distance field of the edges with texel (x, y) sampled at (x + 0.5,
+// y + 0.5). Values cross 127.5 on the outline and saturate spread texels away from it, brighter
+// where the nonzero winding is inside. Rows start stride bytes apart. Scratch memory comes from
+// arena and is released before returning.
+JK_PUBLIC void jk_shapes_sdf_from_edges(JkArena *arena,
+        JkEdgeArray edges,
+        JkIntVec2 dimensions,
+        float spread,
+        uint8_t *data,
+        int64_t stride);
+
 JK_PUBLIC JkIntRect jk_shapes_pixel_rect_get(JkShapesRenderer *renderer, JkRect rect);
 
 JK_PUBLIC void jk_shapes_pixel_rect_draw(
@@ -141,12 +269,120 @@ JK_PUBLIC JkIntRect jk_shapes_rect_draw_outline(
 JK_PUBLIC JkShapesBitmap jk_shapes_bitmap_get(
         JkShapesRenderer *renderer, int64_t shape_index, float scale);
 
+// Returns the shape's SDF glyph. Values are 8-bit distances that cross 127.5 on the outline and
+// saturate JK_SHAPES_SDF_SPREAD texels away from it, brighter inside. One glyph serves every scale.
+JK_PUBLIC JkShapesBitmap jk_shapes_sdf_get(JkShapesRenderer *renderer, int64_t shape_index);
+
+// Rasterizes whichever of the requested bitmaps aren't cached yet, so later draws of them are
+// lookups. Every thread in jk_context's channel must call this with the same renderer and
+// requests. Channel index 0 rasterizes in the renderer's arena and the others in their first
+// scratch arena.
+JK_PUBLIC void jk_shapes_prewarm(JkShapesRenderer *renderer, JkShapesBitmapRequestArray requests);
+
 JK_PUBLIC float jk_shapes_draw(JkShapesRenderer *renderer,
         int64_t shape_index,
         JkVec2 position,
         float scale,
         JkColor color);
 
+// Draws like jk_shapes_draw, but from the shape's SDF glyph, which is sampled and thresholded at
+// composite time. Suits text, where a new scale would otherwise mean rasterizing every glyph again.
+JK_PUBLIC float jk_shapes_sdf_draw(JkShapesRenderer *renderer,
+        int64_t shape_index,
+        JkVec2 position,
+        float scale,
+        JkColor color);
+
 JK_PUBLIC JkShapesDrawCommandArray jk_shapes_draw_commands_get(JkShapesRenderer *renderer);
 
+// ---- Tiles begin ------------------------------------------------------------
+
+#define JK_SHAPES_TILE_SIDE_LENGTH 64
+
+typedef struct JkShapesTiles {
+    JkIntVec2 dimensions; // Pixels covered, starting from the origin
+    JkIntVec2 counts; // Tiles along each axis
+    JkShapesDrawCommandArray commands; // In the order they were drawn
+
+    // Tile i's commands are command_indexes[command_starts[i]] up to
+    // command_indexes[command_starts[i + 1]], in draw order
+    int32_t *command_starts;
+    int32_t *command_indexes;
+
+    // A fingerprint of each tile's commands. If a tile's hash matches last frame's and nothing
+    // beneath the commands changed, compositing it again would produce the same pixels.
+    uint64_t *hashes;
+} JkShapesTiles;
+
+// Bins the renderer's draw commands into tiles of JK_SHAPES_TILE_SIDE_LENGTH pixels square
+JK_PUBLIC JkShapesTiles jk_shapes_tiles_get(JkShapesRenderer *renderer, JkIntVec2 dimensions);
+
+JK_PUBLIC JkIntRect jk_shapes_tile_rect_get(JkShapesTiles *tiles, int64_t tile_index);
+
+// Blends the tile's commands over the buffer in draw order. Only writes pixels inside the tile, so
+// threads can composite different tiles at once.
+JK_PUBLIC void jk_shapes_tile_composite(
+        JkShapesTiles *tiles, int64_t tile_index, JkColor *buffer, int64_t buffer_stride);
+
+// ---- Tiles end --------------------------------------------------------------
+
+// ---- Font begin -------------------------------------------------------------
+
+// Most distinct codepoints a font keeps glyph shapes for
+#define JK_SHAPES_FONT_GLYPH_CAPACITY 4096
+
+// Reads glyph outlines out of a TrueType file the first time each codepoint is asked for, so only
+// the parts of the file for glyphs actually drawn get touched. Paired with jk_platform_file_map,
+// text can use anything the font covers without packing it ahead of time.
+typedef struct JkShapesFont {
+    JkBuffer file;
+    JkArena *arena; // Holds the parsed pen commands, at offsets from its memory's start
+
+    // Byte offsets into the file
+    int64_t glyf;
+    int64_t loca;
+    int64_t hmtx;
+    int64_t cmap; // The Unicode subtable
+    b32 loca_long;
+    int64_t glyph_count;
+    int64_t h_metric_count;
+
+    // In font units, with y growing downward like the shapes
+    float units_per_em;
+    float ascent;
+    float descent;
+    float line_gap;
+
+    JkShapeArray shapes; // In the order their codepoints were first asked for
+
+    // Open addressing from codepoint + 1 to the index of its shape, with 0 marking empty slots
+    uint32_t *slot_keys;
+    int32_t *slot_values;
+} JkShapesFont;
+
+// Returns 0 if the file isn't a TrueType font with glyph outlines and a Unicode character map
+JK_PUBLIC b32 jk_shapes_font_init(JkShapesFont *font, JkBuffer file, JkArena *arena);
+
+// Returns the index in font->shapes of the codepoint's glyph, parsing its outline on first use.
+// Codepoints the font lacks get its missing glyph. Returns -1 once the shapes are at capacity.
+JK_PUBLIC int64_t jk_shapes_font_shape_index_get(JkShapesFont *font, uint32_t codepoint);
+
+// Initializes a renderer over the font's shapes. Glyphs are parsed into the font as text gets
+// drawn, so the renderer follows the font's shape count rather than a copy made at init.
+JK_PUBLIC void jk_shapes_font_renderer_init(JkShapesRenderer *renderer,
+        JkShapesFont *font,
+        float pixels_per_unit,
+        JkArena *arena);
+
+// Draws UTF-8 text from position on the baseline and returns the scaled advance. The renderer must
+// come from jk_shapes_font_renderer_init with the same font.
+JK_PUBLIC float jk_shapes_font_text_draw(JkShapesRenderer *renderer,
+        JkShapesFont *font,
+        JkBuffer text,
+        JkVec2 position,
+        float scale,
+        JkColor color);
+
+// ---- Font end ---------------------------------------------------------------
+
 #endif
@@ -0,0 +1,266 @@
+#include <math.h>
+#include <stdio.h>
+
+// #jk_build single_translation_unit
+
+// #jk_build dependencies_begin
+#include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/jk_shapes/jk_shapes.h>
+#include <jk_src/stb/stb_truetype.h>
+// #jk_build dependencies_end
+
+static char *font_paths[] = {
+    "../jk_assets/chess/AmiriQuran-Regular.ttf",
+    "../jk_assets/website/NotoSerif-Regular.ttf",
+    "../jk_assets/pikuma/graphics/Inconsolata-Regular.ttf",
+};
+
+static int64_t failure_count;
+
+static void fail(char *font_path, uint32_t codepoint, char *what) {
+    if (failure_count < 32) {
+        printf("FAIL: %s U+%04X %s\n", font_path, codepoint, what);
+    }
+    failure_count++;
+}
+
+static double cross(double ax, double ay, double bx, double by) {
+    return ax * by - ay * bx;
+}
+
+// Twice the signed area swept from the origin by a quadratic curve from p0 through control p1 to p2
+static double curve_area_x2(double x0, double y0, double x1, double y1, double x2, double y2) {
+    return (2 * cross(x0, y0, x1, y1) + 2 * cross(x1, y1, x2, y2) + cross(x0, y0, x2, y2)) / 3;
+}
+
+// Contours close back to their starting point whether or not the commands say so
+static double commands_area(JkShapesPenCommandArray commands) {
+    double area_x2 = 0;
+    JkVec2 start = {0};
+    JkVec2 pen = {0};
+    for (int64_t i = 0; i < commands.count; i++) {
+        JkShapesPenCommand *command = commands.e + i;
+        switch (command->type) {
+        case JK_SHAPES_PEN_COMMAND_MOVE: {
+            area_x2 += cross(pen.x, pen.y, start.x, start.y);
+            start = command->v[0];
+            pen = start;
+        } break;
+
+        case JK_SHAPES_PEN_COMMAND_LINE: {
+            area_x2 += cross(pen.x, pen.y, command->v[0].x, command->v[0].y);
+            pen = command->v[0];
+        } break;
+
+        case JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC: {
+            area_x2 += curve_area_x2(pen.x,
+                    pen.y,
+                    command->v[0].x,
+                    command->v[0].y,
+                    command->v[1].x,
+                    command->v[1].y);
+            pen = command->v[1];
+        } break;
+
+        default: {
+            JK_ASSERT(0 && "Font glyphs only have moves, lines, and quadratic curves");
+        } break;
+        }
+    }
+    area_x2 += cross(pen.x, pen.y, start.x, start.y);
+    return area_x2 / 2;
+}
+
+static uint32_t read_u16(uint8_t *data) {
+    return ((uint32_t)data[0] << 8) | data[1];
+}
+
+// stb_truetype multiplies the points of scaled components by the scale a second time, so its
+// outlines for glyphs built from them can't be compared against
+static b32 glyph_has_scaled_component(stbtt_fontinfo *info, int glyph_index) {
+    uint8_t *loca = info->data + info->loca;
+    int64_t offset = info->indexToLocFormat
+            ? ((int64_t)read_u16(loca + 4 * glyph_index) << 16)
+                    | read_u16(loca + 4 * glyph_index + 2)
+            : 2 * (int64_t)read_u16(loca + 2 * glyph_index);
+    uint8_t *glyph = info->data + info->glyf + offset;
+    if ((int16_t)read_u16(glyph) >= 0) {
+        return 0; // Not a composite glyph
+    }
+
+    uint8_t *component = glyph + 10;
+    uint32_t flags;
+    do {
+        flags = read_u16(component);
+        if (flags & (0x0008 | 0x0040 | 0x0080)) { // Scale, x and y scale, or two by two
+            return 1;
+        }
+        component += 4 + ((flags & 0x0001) ? 4 : 2); // Arguments are words or bytes
+    } while (flags & 0x0020); // More components
+    return 0;
+}
+
+// stb_truetype rounds the on-curve points implied between consecutive control points to whole
+// font units. Moving one by up to half a unit in x and y changes the area by at most that much
+// times the distance between the control points on either side.
+static double stb_vertices_area_tolerance(stbtt_vertex *vertices, int vertex_count) {
+    double tolerance = 1e-6;
+    for (int i = 1; i < vertex_count; i++) {
+        stbtt_vertex *a = vertices + i - 1;
+        stbtt_vertex *b = vertices + i;
+        if (a->type == STBTT_vcurve && b->type == STBTT_vcurve) {
+            tolerance += 0.5 * (fabs((double)b->cx - a->cx) + fabs((double)b->cy - a->cy));
+        }
+    }
+    return tolerance;
+}
+
+static double stb_vertices_area(stbtt_vertex *vertices, int vertex_count) {
+    double area_x2 = 0;
+    double start_x = 0, start_y = 0;
+    double pen_x = 0, pen_y = 0;
+    for (int i = 0; i < vertex_count; i++) {
+        stbtt_vertex *v = vertices + i;
+        switch (v->type) {
+        case STBTT_vmove: {
+            area_x2 += cross(pen_x, pen_y, start_x, start_y);
+            start_x = pen_x = v->x;
+            start_y = pen_y = v->y;
+        } break;
+
+        case STBTT_vline: {
+            area_x2 += cross(pen_x, pen_y, v->x, v->y);
+        } break;
+
+        case STBTT_vcurve: {
+            area_x2 += curve_area_x2(pen_x, pen_y, v->cx, v->cy, v->x, v->y);
+        } break;
+
+        default: {
+            JK_ASSERT(0 && "TrueType glyphs only have moves, lines, and quadratic curves");
+        } break;
+        }
+        pen_x = v->x;
+        pen_y = v->y;
+    }
+    area_x2 += cross(pen_x, pen_y, start_x, start_y);
+    return area_x2 / 2;
+}
+
+static void font_test(char *font_path) {
+    JkBuffer file = jk_platform_file_map(jk_buffer_from_null_terminated(font_path));
+    if (!file.size) {
+        fail(font_path, 0, "could not be mapped");
+        return;
+    }
+
+    JkArena font_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    JkShapesFont font;
+    stbtt_fontinfo info;
+    if (!jk_shapes_font_init(&font, file, &font_arena)
+            || !stbtt_InitFont(&info, file.data, stbtt_GetFontOffsetForIndex(file.data, 0))) {
+        fail(font_path, 0, "could not be parsed");
+        jk_platform_arena_virtual_release(&font_arena);
+        jk_platform_file_unmap(file);
+        return;
+    }
+
+    int ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &line_gap);
+    if (font.ascent != -ascent || font.descent != -descent || font.line_gap != line_gap) {
+        fail(font_path, 0, "vertical metrics differ");
+    }
+
+    int64_t glyph_count = 0;
+    int64_t area_checked_count = 0;
+    for (uint32_t codepoint = 0;
+            codepoint < 0x110000 && font.shapes.count < JK_SHAPES_FONT_GLYPH_CAPACITY;
+            codepoint++) {
+        int glyph_index = stbtt_FindGlyphIndex(&info, codepoint);
+        if (!glyph_index) {
+            continue;
+        }
+        glyph_count++;
+
+        int64_t shape_index = jk_shapes_font_shape_index_get(&font, codepoint);
+        JkShape *shape = font.shapes.e + shape_index;
+
+        int advance_width, left_side_bearing;
+        stbtt_GetGlyphHMetrics(&info, glyph_index, &advance_width, &left_side_bearing);
+        if (shape->advance_width != advance_width) {
+            fail(font_path, codepoint, "advance width differs");
+        }
+
+        int x0, y0, x1, y1;
+        if (stbtt_GetGlyphBox(&info, glyph_index, &x0, &y0, &x1, &y1)) {
+            // Shapes have y growing downward
+            if (shape->offset.x != x0 || shape->offset.y != -y1 || shape->dimensions.x != x1 - x0
+                    || shape->dimensions.y != y1 - y0) {
+                fail(font_path, codepoint, "bounding box differs");
+            }
+        }
+
+        JkShapesPenCommandArray commands = {
+            .count = shape->commands.size / JK_SIZEOF(JkShapesPenCommand),
+            .e = (JkShapesPenCommand *)(font_arena.memory.data + shape->commands.offset),
+        };
+        if (glyph_has_scaled_component(&info, glyph_index)) {
+            continue;
+        }
+        area_checked_count++;
+        stbtt_vertex *vertices;
+        int vertex_count = stbtt_GetGlyphShape(&info, glyph_index, &vertices);
+        // Flipping y flips the sign of the area
+        double area = -commands_area(commands);
+        double expected_area = stb_vertices_area(vertices, vertex_count);
+        if (fabs(area - expected_area) > stb_vertices_area_tolerance(vertices, vertex_count)) {
+            fail(font_path, codepoint, "outline area differs");
+        }
+        stbtt_FreeShape(&info, vertices);
+    }
+
+    // A fresh font, so text draws glyphs parsed after the renderer was initialized
+    JkArena text_font_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    JkArena renderer_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    JkShapesFont text_font;
+    jk_shapes_font_init(&text_font, file, &text_font_arena);
+    JkShapesRenderer renderer;
+    jk_shapes_font_renderer_init(&renderer, &text_font, 1.0f, &renderer_arena);
+    JkBuffer text = JKSI("Text");
+    float scale = 32.0f / text_font.units_per_em;
+    float advance = jk_shapes_font_text_draw(
+            &renderer, &text_font, text, (JkVec2){0, 32}, scale, (JkColor){.a = 0xff});
+    float expected_advance = 0;
+    for (int64_t i = 0; i < text.size; i++) {
+        int advance_width, left_side_bearing;
+        stbtt_GetCodepointHMetrics(&info, text.data[i], &advance_width, &left_side_bearing);
+        expected_advance += scale * advance_width;
+    }
+    if (fabsf(advance - expected_advance) > 0.001f) {
+        fail(font_path, 0, "text advance differs");
+    }
+    jk_platform_arena_virtual_release(&renderer_arena);
+    jk_platform_arena_virtual_release(&text_font_arena);
+
+    printf("%s: %lld glyphs, %lld outline areas\n",
+            font_path,
+            (long long)glyph_count,
+            (long long)area_checked_count);
+
+    jk_platform_arena_virtual_release(&font_arena);
+    jk_platform_file_unmap(file);
+}
+
+int32_t jk_platform_entry_point(int32_t argc, char **argv) {
+    jk_platform_set_working_directory_to_executable_directory();
+
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(font_paths); i++) {
+        font_test(font_paths[i]);
+    }
+
+    if (failure_count) {
+        printf("%lld failures\n", (long long)failure_count);
+        return 1;
+    }
+    return 0;
+}
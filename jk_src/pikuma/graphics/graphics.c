@@ -18,6 +18,11 @@
 
 #define NAV_STEP_HEIGHT jk_q16_from_f32(0.75f)
 #define NAV_HEIGHT jk_q16_from_f32(1.875f)
+#define NAV_CACHE_MARGIN 8 // Nav cells
+
+// Objects drop to a coarser level of detail once their triangles would average less than this
+// much screen area
+#define LOD_TRIANGLE_PIXELS_MIN 32.0f
 
 static float const nav_density = 0.125f;
 static JkIntVec2 const nav_dimensions = {32, 32};
@@ -26,21 +31,140 @@ static JkColor bg_color = {.r = CLEAR_COLOR_R, .g = CLEAR_COLOR_G, .b = CLEAR_CO
 
 static float const player_radius = 0.33f;
 static float const player_height = 1.75f;
-static float const player_eye_height = 1.4f;
+static float const player_eye_height = PLAYER_EYE_HEIGHT;
 static JkVec3 light_dir = {-1, 2, -1};
 static JkVec3 light_normal;
 static int32_t rotation_seconds = 8;
 
-static float sample_offsets[2][SAMPLE_COUNT] = {
-    {0.5, 0x0.4p0f, 0x0.Ep0f, 0x0.6p0f},
-    {0.5, 0x0.4p0f, 0x0.6p0f, 0x0.Ep0f},
+#define SAMPLE_PATTERN_COUNT 4
+
+// Indexed by log2(sample_count). Sample 0 is always the pixel center because the per-pixel
+// interpolants are evaluated there.
+static float sample_offsets[SAMPLE_PATTERN_COUNT][2][SAMPLE_COUNT_MAX] = {
+    {
+        {0.5},
+        {0.5},
+    },
+    {
+        {0.5, 0},
+        {0.5, 0},
+    },
+    {
+        {0.5, 0x0.4p0f, 0x0.Ep0f, 0x0.6p0f},
+        {0.5, 0x0.4p0f, 0x0.6p0f, 0x0.Ep0f},
+    },
+    {
+        {0.5, 0x0.2p0f, 0x0.Cp0f, 0x0.6p0f, 0, 0x0.Ep0f, 0x0.4p0f, 0x0.Ap0f},
+        {0.5, 0x0.4p0f, 0, 0x0.Ep0f, 0x0.Ap0f, 0x0.6p0f, 0x0.2p0f, 0x0.Cp0f},
+    },
+};
+
+// Per-thread multisampled color and depth for the tile being rasterized. Samples only live
+// here until resolve writes the final color into env->draw_buffer, so memory traffic scales
+// with the tile rather than with DRAW_BUFFER_SIDE_LENGTH.
+typedef struct TileSamples {
+    int32_t sample_count;
+    int32_t sample_count_log2;
+    JkIntVec2 origin;
+    JkColor *color; // [sample_count][TILE_PIXEL_COUNT]
+    float *z; // [sample_count][TILE_PIXEL_COUNT]
+
+    // All bits set where every sample of the pixel holds the same color, letting resolve skip
+    // averaging. Stored as floats so it can be used directly as a JkF32x8 mask.
+    float *uniform; // [TILE_PIXEL_COUNT]
+
+    // Visibility buffer only. Index into the frame's triangle setups of the triangle covering each
+    // sample, or -1 for none or for a sample whose color triangle_fill already wrote. Stored as
+    // floats, which hold indexes exactly below 2^24, so they can be compared with float vector ops.
+    float *triangle_ids; // [sample_count][TILE_PIXEL_COUNT]
+} TileSamples;
+
+static int32_t sample_count_log2_get(int32_t sample_count) {
+    if (!(0 < sample_count && sample_count <= SAMPLE_COUNT_MAX
+                && (sample_count & (sample_count - 1)) == 0)) {
+        sample_count = SAMPLE_COUNT_DEFAULT;
+    }
+    int32_t result = 0;
+    while ((1 << result) < sample_count) {
+        result++;
+    }
+    return result;
+}
+
+// NEON shifts need an immediate, so dispatch to one per supported sample count
+static JkI256 sample_sum_divide(JkI256 sum, int32_t sample_count_log2) {
+    switch (sample_count_log2) {
+    case 1: {
+        sum = JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sum, 1);
+    } break;
+
+    case 2: {
+        sum = JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sum, 2);
+    } break;
+
+    case 3: {
+        sum = JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sum, 3);
+    } break;
+
+    default: {
+    } break;
+    }
+    return sum;
+}
+
+static int32_t tile_samples_index(TileSamples *samples, int32_t x, int32_t y) {
+    return TILE_SIDE_LENGTH * (y - samples->origin.y) + (x - samples->origin.x);
+}
+
+// Each lane's x offset within a vector of pixels. Wide enough for the widest triangle_fill
+// variant, which loads as many as it has lanes.
+_Alignas(64) static float lane_offsets[16] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
 };
 
-_Alignas(32) static float lane_offsets[2][LANE_COUNT] = {
-    {0, 1, 2, 3, 4, 5, 6, 7},
-    {0, 0, 0, 0, 0, 0, 0, 0},
+static int32_t texture_mip_offsets[TEXTURE_MIP_COUNT] = {
+    TEXTURE_MIP_OFFSET(0),
+    TEXTURE_MIP_OFFSET(1),
+    TEXTURE_MIP_OFFSET(2),
+    TEXTURE_MIP_OFFSET(3),
+    TEXTURE_MIP_OFFSET(4),
 };
 
+// Interleaves the bits of x and y, x in the even bits
+int32_t texture_morton_index(int32_t x, int32_t y) {
+    int32_t result = 0;
+    for (int32_t bit = 0; bit < TEXTURE_POW_2; bit++) {
+        result |= ((x >> bit) & 1) << (2 * bit);
+        result |= ((y >> bit) & 1) << (2 * bit + 1);
+    }
+    return result;
+}
+
+JkColor *texture_data_get(Texture *tex) {
+    return (JkColor *)((uint8_t *)tex + tex->data.offset);
+}
+
+// Fills in every level below the first of a chain whose first level has a side length of
+// 1 << pow_2. Morton order puts each texel's four children next to each other in the level above,
+// so each one is the average of a contiguous run of four.
+void texture_mips_generate(JkColor *data, int32_t pow_2) {
+    int32_t first_level = TEXTURE_POW_2 - pow_2;
+    for (int32_t level = first_level + 1; level < TEXTURE_MIP_COUNT; level++) {
+        JkColor *src = data + TEXTURE_MIP_OFFSET(level - 1) - TEXTURE_MIP_OFFSET(first_level);
+        JkColor *dest = data + TEXTURE_MIP_OFFSET(level) - TEXTURE_MIP_OFFSET(first_level);
+        int32_t side_length = TEXTURE_SIDE_LENGTH >> level;
+        for (int32_t i = 0; i < side_length * side_length; i++) {
+            for (int32_t channel = 0; channel < 4; channel++) {
+                int32_t sum = 0;
+                for (int32_t child = 0; child < 4; child++) {
+                    sum += src[4 * i + child].v[channel];
+                }
+                dest[i].v[channel] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
 // ---- Xiaolin Wu's line algorithm begin --------------------------------------
 
 static uint8_t region_code(JkIntVec2 dimensions, JkVec2 v) {
@@ -198,19 +322,18 @@ typedef struct TriangleArray {
     TexturedTriangle *e;
 } TriangleArray;
 
-typedef struct TriangleNode {
-    struct TriangleNode *next;
-    int32_t texture_id;
-    TexturedTriangle tri;
-} TriangleNode;
+#define TILE_CHUNK_CAPACITY 61
 
-typedef struct TriangleNodePtrArray {
-    int64_t count;
-    TriangleNode **e;
-} TriangleNodePtrArray;
+// Tiles collect triangle indexes in fixed-size chunks, newest chunk first
+typedef struct TileChunk {
+    struct TileChunk *next;
+    int32_t count;
+    int32_t triangle_indexes[TILE_CHUNK_CAPACITY]; // Into the frame's TriangleSetupArray
+} TileChunk;
 
 typedef struct Tile {
-    TriangleNode *head;
+    TileChunk *chunks;
+    int32_t triangle_count;
 } Tile;
 
 typedef struct TileArray {
@@ -229,19 +352,130 @@ typedef struct TexturedVertexArray {
     TexturedVertex *e;
 } TexturedVertexArray;
 
-static int32_t triangle_node_ptr_compare(void *data, void *a_ptr, void *b_ptr) {
-    TriangleNode *a = *(TriangleNode **)a_ptr;
-    TriangleNode *b = *(TriangleNode **)b_ptr;
-    float a_z = a->tri.v[0].z + a->tri.v[1].z + a->tri.v[2].z;
-    float b_z = b->tri.v[0].z + b->tri.v[1].z + b->tri.v[2].z;
-    return a_z < b_z ? 1 : (b_z < a_z) ? -1 : 0;
+// ---- Tile scheduler begin ---------------------------------------------------
+
+#define SCHEDULER_THREAD_COUNT_MAX 64
+
+// One thread's share of the frame's tiles, ordered most expensive first. The owner pops from the
+// front and idle threads steal from the back. Both ends are packed into a single word so one
+// compare-exchange claims a tile from either end.
+typedef struct TileDeque {
+    _Alignas(64) int64_t volatile range; // begin in the low 32 bits, end in the high 32 bits
+    int32_t *tile_indexes;
+} TileDeque;
+
+typedef struct TileScheduler {
+    int64_t deque_count;
+    TileDeque deques[SCHEDULER_THREAD_COUNT_MAX];
+} TileScheduler;
+
+typedef struct SchedulerThreadStats {
+    _Alignas(64) uint64_t busy_time;
+    uint64_t idle_time;
+    uint64_t work_end; // When the thread ran out of tiles this frame
+    int64_t tile_count;
+    int64_t stolen_count;
+    int64_t shade_count; // Vectors of pixels shaded
+} SchedulerThreadStats;
+
+static int64_t tile_deque_range(int32_t begin, int32_t end) {
+    return (int64_t)(uint32_t)begin | ((int64_t)end << 32);
+}
+
+static int32_t tile_index_cost_compare(void *data, void *a_ptr, void *b_ptr) {
+    Tile *tiles = data;
+    int32_t a = tiles[*(int32_t *)a_ptr].triangle_count;
+    int32_t b = tiles[*(int32_t *)b_ptr].triangle_count;
+    return a < b ? 1 : (b < a) ? -1 : 0;
+}
+
+// Sorts tiles by triangle count, largest first, and deals them round-robin into one deque per
+// thread so every thread starts on the most expensive work it can get
+static void tile_scheduler_init(
+        TileScheduler *scheduler, JkArena *arena, TileArray tiles, int64_t thread_count) {
+    int32_t *order = jk_arena_push(arena, tiles.count * JK_SIZEOF(*order));
+    for (int32_t i = 0; i < tiles.count; i++) {
+        order[i] = i;
+    }
+    int32_t tmp;
+    jk_quicksort(order, tiles.count, JK_SIZEOF(*order), &tmp, tiles.e, tile_index_cost_compare);
+
+    scheduler->deque_count = JK_MIN(thread_count, SCHEDULER_THREAD_COUNT_MAX);
+    int64_t capacity = tiles.count / scheduler->deque_count + 1;
+    for (int64_t deque_index = 0; deque_index < scheduler->deque_count; deque_index++) {
+        TileDeque *deque = scheduler->deques + deque_index;
+        deque->tile_indexes = jk_arena_push(arena, capacity * JK_SIZEOF(*deque->tile_indexes));
+        int32_t count = 0;
+        for (int64_t i = deque_index; i < tiles.count; i += scheduler->deque_count) {
+            deque->tile_indexes[count++] = order[i];
+        }
+        deque->range = tile_deque_range(0, count);
+    }
 }
 
-static void quicksort_triangle_node_ptrs(TriangleNodePtrArray array) {
-    TriangleNode *tmp;
-    jk_quicksort(array.e, array.count, JK_SIZEOF(*array.e), &tmp, 0, triangle_node_ptr_compare);
+// Returns -1 if the deque is empty
+static int32_t tile_deque_pop(TileDeque *deque, b32 steal) {
+    for (;;) {
+        int64_t range = deque->range;
+        int32_t begin = (int32_t)(range & 0xffffffff);
+        int32_t end = (int32_t)(range >> 32);
+        if (end <= begin) {
+            return -1;
+        }
+        int64_t desired =
+                steal ? tile_deque_range(begin, end - 1) : tile_deque_range(begin + 1, end);
+        if (jk_atomic_compare_exchange_64(&deque->range, range, desired) == range) {
+            return deque->tile_indexes[steal ? end - 1 : begin];
+        }
+    }
 }
 
+// Returns -1 once every deque is empty
+static int32_t tile_scheduler_next(TileScheduler *scheduler, int64_t thread_index, b32 *stolen) {
+    int32_t result = -1;
+    *stolen = 0;
+    for (int64_t i = 0; result == -1 && i < scheduler->deque_count; i++) {
+        TileDeque *deque = scheduler->deques + (thread_index + i) % scheduler->deque_count;
+        result = tile_deque_pop(deque, i != 0);
+        *stolen = result != -1 && i != 0;
+    }
+    return result;
+}
+
+static void scheduler_stats_report(
+        SchedulerThreadStats *stats, int64_t thread_count, int64_t frame_count, int64_t frequency) {
+    if (!frame_count) {
+        return;
+    }
+    double ms_per_frame = 1000.0 / ((double)frequency * (double)frame_count);
+    JK_LOGF(JK_LOG_INFO,
+            jkfn("Rasterizer threads, averaged over "),
+            jkfi(frame_count),
+            jkfn(" frames"),
+            jkf_nl);
+    for (int64_t i = 0; i < thread_count; i++) {
+        uint64_t total = stats[i].busy_time + stats[i].idle_time;
+        JK_LOGF(JK_LOG_INFO,
+                jkfn("  Thread "),
+                jkfi(i),
+                jkfn(": busy "),
+                jkff(stats[i].busy_time * ms_per_frame, 3),
+                jkfn(" ms, idle "),
+                jkff(stats[i].idle_time * ms_per_frame, 3),
+                jkfn(" ms ("),
+                jkff(total ? 100.0 * stats[i].idle_time / total : 0, 1),
+                jkfn("%), tiles "),
+                jkff((double)stats[i].tile_count / frame_count, 1),
+                jkfn(", stolen "),
+                jkff((double)stats[i].stolen_count / frame_count, 1),
+                jkfn(", shaded vectors "),
+                jkff((double)stats[i].shade_count / frame_count, 1),
+                jkf_nl);
+    }
+}
+
+// ---- Tile scheduler end -----------------------------------------------------
+
 static JkIntRect segment_bounding_box(JkQ16Vec2 v0, JkQ16Vec2 v1, int32_t radius) {
     JkQ16Vec2 min = {.x = JK_MIN(v0.x, v1.x) - radius, .y = JK_MIN(v0.y, v1.y) - radius};
     JkQ16Vec2 max = {.x = JK_MAX(v0.x, v1.x) + radius, .y = JK_MAX(v0.y, v1.y) + radius};
@@ -968,10 +1202,6 @@ typedef enum SampleInterpolant {
     SAMPLE_INTERPOLANT_COUNT,
 } SampleInterpolant;
 
-typedef struct SampleInterpolants {
-    JkF32x8 e[SAMPLE_INTERPOLANT_COUNT];
-} SampleInterpolants;
-
 typedef enum PixelInterpolant {
     P_U,
     P_V,
@@ -979,76 +1209,74 @@ typedef enum PixelInterpolant {
     PIXEL_INTERPOLANT_COUNT,
 } PixelInterpolant;
 
-typedef struct PixelInterpolants {
-    JkF32x8 e[PIXEL_INTERPOLANT_COUNT];
-} PixelInterpolants;
-
-typedef struct ColorF32x8x4 {
-    JkF32x8 e[4];
-} ColorF32x8x4;
-
-static JkF32x8 channel_extract(JkI256 color, int32_t channel_index) {
-    switch (channel_index) {
-    case 1: {
-        color = JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(color, 8);
-    } break;
-
-    case 2: {
-        color = JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(color, 16);
-    } break;
-
-    case 3: {
-        color = JK_I256_SHIFT_RIGHT_ZERO_FILL_I32(color, 24);
-    } break;
-
-    default: {
-    } break;
-    }
-    return jk_f32x8_from_i32x8(jk_i256_and(color, jk_i256_broadcast_i32(0xff)));
+// Maps a depth to a key that sorts in descending depth order as an unsigned integer. Larger depths
+// are closer to the camera.
+static uint32_t depth_key_from_f32(float depth) {
+    uint32_t bits = ((JkConversionUnion){.f32 = depth}).uint32_v;
+    uint32_t ascending = (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+    return ~ascending;
 }
 
-static JkF32x8 bilerp(JkI256 *colors, int32_t channel_index, JkF32x8 xfrac, JkF32x8 yfrac) {
-    JkF32x8 colorsf[4];
-    for (int64_t i = 0; i < 4; i++) {
-        colorsf[i] = channel_extract(colors[i], channel_index);
+// Sorts items by their high 32 bits with a least significant digit radix sort, one byte per pass.
+// Passes where every item has the same byte are skipped, which covers most of them when a tile's
+// depths are close together. Returns whichever of items or tmp holds the result.
+static uint64_t *radix_sort_by_high_u32(uint64_t *items, uint64_t *tmp, int64_t count) {
+    for (int32_t shift = 32; shift < 64; shift += 8) {
+        int64_t offsets[256] = {0};
+        for (int64_t i = 0; i < count; i++) {
+            offsets[(items[i] >> shift) & 0xff]++;
+        }
+        if (count && offsets[(items[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+        int64_t total = 0;
+        for (int64_t digit = 0; digit < 256; digit++) {
+            int64_t digit_count = offsets[digit];
+            offsets[digit] = total;
+            total += digit_count;
+        }
+        for (int64_t i = 0; i < count; i++) {
+            tmp[offsets[(items[i] >> shift) & 0xff]++] = items[i];
+        }
+        JK_SWAP(items, tmp, uint64_t *);
     }
-    JkF32x8 top = jk_f32x8_lerp(colorsf[0], colorsf[1], xfrac);
-    JkF32x8 bottom = jk_f32x8_lerp(colorsf[2], colorsf[3], xfrac);
-    return jk_f32x8_lerp(top, bottom, yfrac);
+    return items;
 }
 
-static ColorF32x8x4 color_broadcast(JkColor color) {
-    ColorF32x8x4 result;
-    for (int64_t i = 0; i < 4; i++) {
-        result.e[i] = jk_f32x8_broadcast(color.v[i]);
-    }
-    result.e[3] = jk_f32x8_div(result.e[3], jk_f32x8_broadcast(255));
-    return result;
-}
+// Everything triangle_fill needs from a triangle that doesn't depend on which tile it's filling.
+// Computed once during binning and shared by every tile the triangle touches.
+typedef struct TriangleSetup {
+    JkIntRect bounding_box;
+    int32_t texture_id;
+    uint32_t depth_key; // Ascending order is front to back
 
-static void color_blend(ColorF32x8x4 *fg, ColorF32x8x4 bg) {
-    JkF32x8 complement = jk_f32x8_sub(jk_f32x8_broadcast(1), fg->e[3]);
-    fg->e[3] = jk_f32x8_add(fg->e[3], jk_f32x8_mul(bg.e[3], complement));
-    for (int64_t i = 0; i < 3; i++) {
-        fg->e[i] = jk_f32x8_add(fg->e[i], jk_f32x8_mul(jk_f32x8_mul(bg.e[i], bg.e[3]), complement));
-    }
-}
+    // Unnormalized barycentric edge functions: constant, x coefficient, y coefficient
+    float edges[3][3];
+    float barycentric_divisor;
 
-static void triangle_fill(
-        Environment *env, TriangleNode *node, Texture *texture, JkIntRect bounding_box) {
-    TexturedTriangle *tri = &node->tri;
+    float z[3];
+    JkVec2 t[3];
+    float light[3];
 
-    JkIntRect bounds = jk_int_rect_intersect(
-            bounding_box, triangle_bounding_box(tri->v[0], tri->v[1], tri->v[2]));
-    if (!(bounds.min.x < bounds.max.x && bounds.min.y < bounds.max.y)) {
-        return;
-    }
-    bounds.min.x &= ~(8 - 1);
+    // Per-step increments: deltas[0] for one pixel along x, deltas[1] for one row along y
+    float deltas[2][SAMPLE_INTERPOLANT_COUNT + PIXEL_INTERPOLANT_COUNT];
+    float inv_deriv_z[2];
+    float inv_deriv[4]; // Usage: inv_deriv[2 * axis + tex_axis]
+} TriangleSetup;
 
-    ColorF32x8x4 bg = color_broadcast(texture->bg);
-    ColorF32x8x4 colors[4];
-    for (int64_t i = 0; i < 4; i++) {
-        colors[i] = color_broadcast(texture->colors[i]);
+typedef struct TriangleSetupArray {
+    int64_t count;
+    TriangleSetup *e;
+} TriangleSetupArray;
+
+static void triangle_setup(TriangleSetup *setup, TexturedTriangle *tri, int32_t texture_id) {
+    setup->bounding_box = triangle_bounding_box(tri->v[0], tri->v[1], tri->v[2]);
+    setup->texture_id = texture_id;
+    setup->depth_key = depth_key_from_f32(tri->v[0].z + tri->v[1].z + tri->v[2].z);
+    for (int64_t i = 0; i < 3; i++) {
+        setup->z[i] = tri->v[i].z;
+        setup->t[i] = tri->t[i];
+        setup->light[i] = tri->light[i];
     }
 
     JkVec2 verts_2d[3];
@@ -1056,45 +1284,27 @@ static void triangle_fill(
         verts_2d[i] = jk_vec2_from_3(tri->v[i]);
     }
 
-    SampleInterpolants s_interpolants_row[SAMPLE_COUNT] = {0};
-    PixelInterpolants p_interpolants_row = {0};
-    float deltas[2][SAMPLE_INTERPOLANT_COUNT + PIXEL_INTERPOLANT_COUNT] = {0};
+    float (*deltas)[SAMPLE_INTERPOLANT_COUNT + PIXEL_INTERPOLANT_COUNT] = setup->deltas;
+    jk_memset(deltas, 0, JK_SIZEOF(setup->deltas));
 
-    JkF32x8 init_pos[2][SAMPLE_COUNT];
-    for (int64_t axis_index = 0; axis_index < 2; axis_index++) {
-        JkF32x8 pixel_coord = jk_f32x8_add(jk_f32x8_broadcast(bounds.min.v[axis_index]),
-                jk_f32x8_load(lane_offsets[axis_index]));
-        for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-            init_pos[axis_index][sample_index] = jk_f32x8_add(
-                    pixel_coord, jk_f32x8_broadcast(sample_offsets[axis_index][sample_index]));
-        }
-    }
-
-    float barycentric_divisor = 0;
+    setup->barycentric_divisor = 0;
     for (int64_t i = 0; i < 3; i++) {
         int64_t a = (i + 1) % 3;
         int64_t b = (i + 2) % 3;
         float cross = jk_vec2_cross(verts_2d[a], verts_2d[b]);
-        barycentric_divisor += cross;
+        setup->barycentric_divisor += cross;
         float x_delta = verts_2d[a].y - verts_2d[b].y;
         float y_delta = verts_2d[b].x - verts_2d[a].x;
-        deltas[0][S_BARYCENTRIC_0 + i] = 8 * x_delta;
+        setup->edges[i][0] = cross;
+        setup->edges[i][1] = x_delta;
+        setup->edges[i][2] = y_delta;
+        deltas[0][S_BARYCENTRIC_0 + i] = x_delta;
         deltas[1][S_BARYCENTRIC_0 + i] = y_delta;
-        JkF32x8 cross_wide = jk_f32x8_broadcast(cross);
-        JkF32x8 x_delta_wide = jk_f32x8_broadcast(x_delta);
-        JkF32x8 y_delta_wide = jk_f32x8_broadcast(y_delta);
-        for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-            JkF32x8 coord =
-                    jk_f32x8_add(cross_wide, jk_f32x8_mul(x_delta_wide, init_pos[0][sample_index]));
-            coord = jk_f32x8_add(coord, jk_f32x8_mul(y_delta_wide, init_pos[1][sample_index]));
-            s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i] = coord;
-        }
     }
 
-    JkF32x8 barycentric_divisor_wide = jk_f32x8_broadcast(barycentric_divisor);
     for (int64_t i = 0; i < 3; i++) {
         for (int64_t axis_index = 0; axis_index < 2; axis_index++) {
-            deltas[axis_index][S_BARYCENTRIC_0 + i] /= barycentric_divisor;
+            deltas[axis_index][S_BARYCENTRIC_0 + i] /= setup->barycentric_divisor;
             deltas[axis_index][S_Z] += deltas[axis_index][S_BARYCENTRIC_0 + i] * tri->v[i].z;
 
             deltas[axis_index][SAMPLE_INTERPOLANT_COUNT + P_U] +=
@@ -1104,201 +1314,93 @@ static void triangle_fill(
             deltas[axis_index][SAMPLE_INTERPOLANT_COUNT + P_LIGHT] +=
                     deltas[axis_index][S_BARYCENTRIC_0 + i] * tri->light[i];
         }
-        for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-            s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i] =
-                    jk_f32x8_div(s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i],
-                            barycentric_divisor_wide);
-            s_interpolants_row[sample_index].e[S_Z] =
-                    jk_f32x8_add(s_interpolants_row[sample_index].e[S_Z],
-                            jk_f32x8_mul(s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i],
-                                    jk_f32x8_broadcast(tri->v[i].z)));
-        }
-        p_interpolants_row.e[P_U] = jk_f32x8_add(p_interpolants_row.e[P_U],
-                jk_f32x8_mul(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
-                        jk_f32x8_broadcast(tri->t[i].x)));
-        p_interpolants_row.e[P_V] = jk_f32x8_add(p_interpolants_row.e[P_V],
-                jk_f32x8_mul(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
-                        jk_f32x8_broadcast(tri->t[i].y)));
-        p_interpolants_row.e[P_LIGHT] = jk_f32x8_add(p_interpolants_row.e[P_LIGHT],
-                jk_f32x8_mul(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
-                        jk_f32x8_broadcast(tri->light[i])));
-    }
-
-    float inv_deriv_z[2] = {
-        deltas[0][S_Z] / 8,
-        deltas[1][S_Z],
-    };
-
-    float inv_deriv[4]; // Usage: inv_deriv[2 * axis + tex_axis]
-    inv_deriv[0] = deltas[0][SAMPLE_INTERPOLANT_COUNT + P_U] / 8; // dU/dx
-    inv_deriv[1] = deltas[0][SAMPLE_INTERPOLANT_COUNT + P_V] / 8; // dV/dx
-    inv_deriv[2] = deltas[1][SAMPLE_INTERPOLANT_COUNT + P_U]; // dU/dy
-    inv_deriv[3] = deltas[1][SAMPLE_INTERPOLANT_COUNT + P_V]; // dV/dy
-
-    for (int32_t y = bounds.min.y; y < bounds.max.y; y++) {
-        PixelInterpolants p_interpolants = p_interpolants_row;
-        SampleInterpolants s_interpolants_col[SAMPLE_COUNT];
-        jk_memcpy(s_interpolants_col, s_interpolants_row, sizeof(s_interpolants_row));
-        for (int32_t x = bounds.min.x; x < bounds.max.x; x += 8) {
-            b32 found_color = 0;
-            ColorF32x8x4 pixel_color = color_broadcast((JkColor){0});
-            for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-                SampleInterpolants *s_interpolants = s_interpolants_col + sample_index;
-                JkF32x8 outside_triangle =
-                        jk_f32x8_to_mask(jk_f32x8_or(s_interpolants->e[S_BARYCENTRIC_0],
-                                jk_f32x8_or(s_interpolants->e[S_BARYCENTRIC_1],
-                                        s_interpolants->e[S_BARYCENTRIC_2])));
-                if (!jk_f32x8_all(outside_triangle)) {
-                    int32_t index = PIXEL_COUNT * sample_index + DRAW_BUFFER_SIDE_LENGTH * y + x;
-                    JkF32x8 z_buffer = jk_f32x8_load(env->z_buffer + index);
-                    JkF32x8 in_front = jk_f32x8_less_than(z_buffer, s_interpolants->e[S_Z]);
-                    JkF32x8 visible = jk_f32x8_andnot(outside_triangle, in_front);
-                    if (jk_f32x8_any(visible)) {
-                        jk_f32x8_store(env->z_buffer + index,
-                                jk_f32x8_blend(z_buffer, s_interpolants->e[S_Z], visible));
-
-                        if (!found_color) {
-                            found_color = 1;
-
-                            JkF32x8 inv_z = jk_f32x8_div(
-                                    jk_f32x8_broadcast(1), s_interpolants_col[0].e[S_Z]);
-
-                            JkF32x8 uv[2];
-                            JkF32x8 frac[2];
-                            JkI256 coords[2][2];
-                            for (int32_t axis = 0; axis < 2; axis++) {
-                                uv[axis] = jk_f32x8_mul(p_interpolants.e[P_U + axis], inv_z);
-
-                                JkF32x8 tex = jk_f32x8_mul(jk_f32x8_broadcast(TEXTURE_SIDE_LENGTH),
-                                        jk_f32x8_sub(uv[axis], jk_f32x8_floor(uv[axis])));
-                                frac[axis] = jk_f32x8_sub(tex, jk_f32x8_floor(tex));
-                                coords[axis][0] = jk_i256_and(jk_i32x8_from_f32x8_truncate(tex),
-                                        jk_i256_broadcast_i32(TEXTURE_MASK));
-                                coords[axis][1] = jk_i256_and(
-                                        jk_i256_add_i32(coords[axis][0], jk_i256_broadcast_i32(1)),
-                                        jk_i256_broadcast_i32(TEXTURE_MASK));
-                            }
-
-                            JkF32x8 pixel_size = jk_f32x8_broadcast(0);
-                            for (int32_t axis = 0; axis < 2; axis++) {
-                                for (int32_t tex_axis = 0; tex_axis < 2; tex_axis++) {
-                                    JkF32x8 dUV =
-                                            jk_f32x8_broadcast(inv_deriv[2 * axis + tex_axis]);
-                                    JkF32x8 dZ = jk_f32x8_broadcast(inv_deriv_z[axis]);
-                                    JkF32x8 deriv = jk_f32x8_mul(inv_z,
-                                            jk_f32x8_sub(dUV, jk_f32x8_mul(uv[tex_axis], dZ)));
-                                    pixel_size = jk_f32x8_add(pixel_size, jk_f32x8_abs(deriv));
-                                }
-                            }
-                            pixel_size = jk_f32x8_mul(pixel_size, jk_f32x8_broadcast(0.5));
-                            pixel_size = jk_f32x8_min(
-                                    pixel_size, jk_f32x8_broadcast(18.4f / TEXTURE_SIDE_LENGTH));
-
-                            JkI256 dist[4];
-                            for (int32_t row_i = 0; row_i < 2; row_i++) {
-                                JkI256 row =
-                                        JK_I256_SHIFT_LEFT_I32(coords[1][row_i], TEXTURE_POW_2);
-                                for (int32_t col_i = 0; col_i < 2; col_i++) {
-                                    dist[2 * row_i + col_i] = jk_i256_from_f32x8_reinterpret(
-                                            jk_f32x8_gather(texture->data,
-                                                    jk_i256_add_i32(row, coords[0][col_i])));
-                                }
-                            }
-
-                            for (int64_t channel_index = 0;
-                                    jk_f32x8_any(jk_f32x8_less_than(
-                                            pixel_color.e[3], jk_f32x8_broadcast(1)))
-                                    && channel_index < 4;
-                                    channel_index++) {
-                                JkF32x8 distance = bilerp(dist, channel_index, frac[0], frac[1]);
-                                JkF32x8 dir = jk_f32x8_sub(
-                                        jk_f32x8_mul(jk_f32x8_broadcast(2.0f / 255), distance),
-                                        jk_f32x8_broadcast(1));
-                                JkF32x8 spread_pixels = jk_f32x8_mul(
-                                        jk_f32x8_broadcast(SDF_SPREAD / TEXTURE_SIDE_LENGTH),
-                                        jk_f32x8_reciprocal_approx(pixel_size));
-
-                                JkF32x8 coverage = jk_f32x8_add(
-                                        jk_f32x8_broadcast(0.5), jk_f32x8_mul(dir, spread_pixels));
-                                coverage = jk_f32x8_max(coverage, jk_f32x8_broadcast(0));
-                                coverage = jk_f32x8_min(coverage, jk_f32x8_broadcast(1));
-                                ColorF32x8x4 color = colors[channel_index];
-                                color.e[3] = jk_f32x8_mul(color.e[3], coverage);
-                                color_blend(&pixel_color, color);
-                            }
-                            if (jk_f32x8_any(jk_f32x8_less_than(
-                                        pixel_color.e[3], jk_f32x8_broadcast(1)))) {
-                                color_blend(&pixel_color, bg);
-                            }
-                            if (jk_f32x8_any(jk_f32x8_less_than(
-                                        pixel_color.e[3], jk_f32x8_broadcast(0.95)))) {
-                                JkF32x8 inv = jk_f32x8_reciprocal_approx(pixel_color.e[3]);
-                                for (int64_t i = 0; i < 3; i++) {
-                                    pixel_color.e[i] = jk_f32x8_mul(pixel_color.e[i], inv);
-                                }
-                            }
-                            JkF32x8 light = jk_f32x8_blend(jk_f32x8_broadcast(1),
-                                    jk_f32x8_broadcast(1.05),
-                                    jk_f32x8_less_than(
-                                            jk_f32x8_broadcast(0.65), p_interpolants.e[P_LIGHT]));
-                            light = jk_f32x8_blend(light,
-                                    jk_f32x8_broadcast(0.92),
-                                    jk_f32x8_less_than(
-                                            p_interpolants.e[P_LIGHT], jk_f32x8_broadcast(-0.25)));
-                            for (int64_t i = 0; i < 3; i++) {
-                                pixel_color.e[i] = jk_f32x8_mul(pixel_color.e[i], light);
-                                pixel_color.e[i] =
-                                        jk_f32x8_max(pixel_color.e[i], jk_f32x8_broadcast(0));
-                                pixel_color.e[i] =
-                                        jk_f32x8_min(pixel_color.e[i], jk_f32x8_broadcast(255));
-                            }
-                        }
-
-                        JkI256 color_i32 = jk_i32x8_from_f32x8_truncate(pixel_color.e[0]);
-                        color_i32 = jk_i256_or(color_i32,
-                                JK_I256_SHIFT_LEFT_I32(
-                                        jk_i32x8_from_f32x8_truncate(pixel_color.e[1]), 8));
-                        color_i32 = jk_i256_or(color_i32,
-                                JK_I256_SHIFT_LEFT_I32(
-                                        jk_i32x8_from_f32x8_truncate(pixel_color.e[2]), 16));
-
-                        JkF32x8 alpha_threshold = jk_f32x8_broadcast(0.234375 * sample_index);
-                        JkF32x8 should_draw = jk_f32x8_and(
-                                visible, jk_f32x8_less_than(alpha_threshold, pixel_color.e[3]));
-
-                        JkF32x8 color_buffer = jk_f32x8_load((float *)(env->draw_buffer + index));
-                        jk_f32x8_store((float *)(env->draw_buffer + index),
-                                jk_f32x8_blend(color_buffer,
-                                        jk_f32x8_from_i256_reinterpret(color_i32),
-                                        should_draw));
-                    }
-                }
+    }
 
-                for (int64_t i = 0; i < SAMPLE_INTERPOLANT_COUNT; i++) {
-                    s_interpolants->e[i] =
-                            jk_f32x8_add(s_interpolants->e[i], jk_f32x8_broadcast(deltas[0][i]));
-                }
-            }
+    setup->inv_deriv_z[0] = deltas[0][S_Z];
+    setup->inv_deriv_z[1] = deltas[1][S_Z];
 
-            for (int64_t i = 0; i < PIXEL_INTERPOLANT_COUNT; i++) {
-                p_interpolants.e[i] = jk_f32x8_add(p_interpolants.e[i],
-                        jk_f32x8_broadcast(deltas[0][SAMPLE_INTERPOLANT_COUNT + i]));
-            }
-        }
+    setup->inv_deriv[0] = deltas[0][SAMPLE_INTERPOLANT_COUNT + P_U]; // dU/dx
+    setup->inv_deriv[1] = deltas[0][SAMPLE_INTERPOLANT_COUNT + P_V]; // dV/dx
+    setup->inv_deriv[2] = deltas[1][SAMPLE_INTERPOLANT_COUNT + P_U]; // dU/dy
+    setup->inv_deriv[3] = deltas[1][SAMPLE_INTERPOLANT_COUNT + P_V]; // dV/dy
+}
 
-        for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-            for (int64_t i = 0; i < SAMPLE_INTERPOLANT_COUNT; i++) {
-                s_interpolants_row[sample_index].e[i] = jk_f32x8_add(
-                        s_interpolants_row[sample_index].e[i], jk_f32x8_broadcast(deltas[1][i]));
-            }
-        }
-        for (int64_t i = 0; i < PIXEL_INTERPOLANT_COUNT; i++) {
-            p_interpolants_row.e[i] = jk_f32x8_add(p_interpolants_row.e[i],
-                    jk_f32x8_broadcast(deltas[1][SAMPLE_INTERPOLANT_COUNT + i]));
-        }
+// ---- triangle_fill variants begin -------------------------------------------
+
+#define LANES 8
+#define LANE_TARGET
+#define LANE_INLINE
+#define LANE_NAME(name) name##_x8
+#define F32xN JkF32x8
+#define I32xN JkI256
+#define f32xn(op) jk_f32x8_##op
+#define i32xn(op) jk_i256_##op
+#define f32xn_from_i32xn jk_f32x8_from_i32x8
+#define f32xn_from_i32xn_reinterpret jk_f32x8_from_i256_reinterpret
+#define i32xn_from_f32xn_reinterpret jk_i256_from_f32x8_reinterpret
+#define i32xn_from_f32xn_truncate jk_i32x8_from_f32x8_truncate
+#define I32XN_SHIFT_LEFT JK_I256_SHIFT_LEFT_I32
+#define I32XN_SHIFT_RIGHT_ZERO_FILL JK_I256_SHIFT_RIGHT_ZERO_FILL_I32
+#include "triangle_fill.c"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#define LANES 16
+#define LANE_TARGET JK_TARGET_AVX512
+#define LANE_INLINE JK_FORCE_INLINE
+#define LANE_NAME(name) name##_x16
+#define F32xN JkF32x16
+#define I32xN JkI512
+#define f32xn(op) jk_f32x16_##op
+#define i32xn(op) jk_i512_##op
+#define f32xn_from_i32xn jk_f32x16_from_i32x16
+#define f32xn_from_i32xn_reinterpret jk_f32x16_from_i512_reinterpret
+#define i32xn_from_f32xn_reinterpret jk_i512_from_f32x16_reinterpret
+#define i32xn_from_f32xn_truncate jk_i32x16_from_f32x16_truncate
+#define I32XN_SHIFT_LEFT JK_I512_SHIFT_LEFT_I32
+#define I32XN_SHIFT_RIGHT_ZERO_FILL JK_I512_SHIFT_RIGHT_ZERO_FILL_I32
+#include "triangle_fill.c"
+
+#endif
+
+typedef int64_t TriangleFillFunction(
+        TileSamples *samples, TriangleSetup *setup, Texture *texture, JkIntRect bounding_box);
+
+typedef void TriangleFillVisibilityFunction(TileSamples *samples,
+        TriangleSetup *setup,
+        int32_t triangle_index,
+        JkIntRect bounding_box);
+
+typedef int64_t TileShadeFunction(TileSamples *samples,
+        TriangleSetupArray triangle_setups,
+        TextureArray textures,
+        JkIntRect bounding_box);
+
+// Picked once at startup, all at the same width. The 8-lane variant is whatever the build's
+// baseline ISA provides: AVX2 on x86-64, NEON on ARM, and plain loops elsewhere. eight_lanes forces
+// it, so a machine with AVX-512 can check both widths.
+static TriangleFillFunction *triangle_fill;
+static TriangleFillVisibilityFunction *triangle_fill_visibility;
+static TileShadeFunction *tile_shade;
+
+static void triangle_fill_select(b32 eight_lanes) {
+#if defined(__x86_64__) || defined(_M_X64)
+    if (!eight_lanes && jk_cpu_supports_avx512()) {
+        jk_log(JK_LOG_INFO, JKS("Rasterizing with 16-lane AVX-512\n"));
+        triangle_fill = triangle_fill_x16;
+        triangle_fill_visibility = triangle_fill_visibility_x16;
+        tile_shade = tile_shade_x16;
+        return;
     }
+#endif
+    jk_log(JK_LOG_INFO, JKS("Rasterizing with 8 lanes\n"));
+    triangle_fill = triangle_fill_x8;
+    triangle_fill_visibility = triangle_fill_visibility_x8;
+    tile_shade = tile_shade_x8;
 }
 
+// ---- triangle_fill variants end ---------------------------------------------
+
 static void add_textured_vertex(
         JkArena *arena, JkMat4 screen_from_ndc, JkVec4 v, JkVec2 t, float light) {
     TexturedVertex *new = jk_arena_push(arena, sizeof(*new));
@@ -1307,16 +1409,6 @@ static void add_textured_vertex(
     new->light = light;
 }
 
-static JkColor blend_alpha(JkColor foreground, JkColor background, uint8_t alpha) {
-    JkColor result = {0, 0, 0, 255};
-    for (uint8_t i = 0; i < 3; i++) {
-        result.v[i] = ((int32_t)foreground.v[i] * (int32_t)alpha
-                              + background.v[i] * (255 - (int32_t)alpha))
-                / 255;
-    }
-    return result;
-}
-
 typedef struct TextLayout {
     JkVec2 offset;
     JkVec2 dimensions;
@@ -1358,6 +1450,147 @@ static JkMat4 object_compute_world_from_local(ObjectArray objects, ObjectId id)
     return result;
 }
 
+// Picks the most detailed faces whose triangles would still average at least
+// LOD_TRIANGLE_PIXELS_MIN pixels, estimating the screen area from the object's bounding sphere.
+// pixels_per_unit is how many pixels a unit length spans at a view depth of one.
+static JkSpan object_lod_select(
+        Object *object, JkMat4 world_from_local, JkMat4 clip_from_world, float pixels_per_unit) {
+    JkSpan result = object->faces;
+
+    float scale = 0;
+    for (int64_t j = 0; j < 3; j++) {
+        JkVec3 column = {
+            world_from_local.e[0][j],
+            world_from_local.e[1][j],
+            world_from_local.e[2][j],
+        };
+        scale = JK_MAX(scale, jk_vec3_magnitude(column));
+    }
+    float radius = scale * object->bounds_radius;
+    JkVec3 center = jk_mat4_mul_point(world_from_local, object->bounds_center);
+    float depth = jk_mat4_mul_vec4(clip_from_world, jk_vec4_from_3(center, 1)).w;
+
+    // Keep full detail when the camera is inside or very near the bounds
+    if (radius < depth) {
+        float radius_pixels = pixels_per_unit * radius / depth;
+        float area = JK_PI * radius_pixels * radius_pixels;
+        for (int64_t i = 0; i < LOD_COUNT - 1; i++) {
+            int64_t face_count = result.size / JK_SIZEOF(Face);
+            if (!face_count || LOD_TRIANGLE_PIXELS_MIN * face_count <= area) {
+                break;
+            }
+            result = object->lods[i];
+        }
+    }
+
+    return result;
+}
+
+// ---- Vertex SoA begin -------------------------------------------------------
+
+typedef enum VertexComponent {
+    V_X,
+    V_Y,
+    V_Z,
+    V_W,
+    V_COMPONENT_COUNT,
+} VertexComponent;
+
+// Structure-of-arrays vertex storage. count is padded up to a multiple of LANE_COUNT so the
+// kernels below can process LANE_COUNT vertices per iteration without a scalar tail.
+typedef struct VertexSoa {
+    int64_t count;
+    float *e[V_COMPONENT_COUNT];
+} VertexSoa;
+
+static VertexSoa vertex_soa_alloc(JkArena *arena, int64_t count, int32_t component_count) {
+    VertexSoa result = {.count = JK_ALIGN_UP(count, LANE_COUNT)};
+    for (int32_t i = 0; i < component_count; i++) {
+        result.e[i] = jk_arena_push_zero(arena, result.count * JK_SIZEOF(*result.e[i]));
+    }
+    return result;
+}
+
+static VertexSoa vertex_soa_from_vec3s(JkArena *arena, JkVec3Array vertices) {
+    VertexSoa result = vertex_soa_alloc(arena, vertices.count, 3);
+    for (int64_t i = 0; i < vertices.count; i++) {
+        for (int32_t component = 0; component < 3; component++) {
+            result.e[component][i] = vertices.e[i].v[component];
+        }
+    }
+    return result;
+}
+
+static JkVec3 vertex_soa_get_vec3(VertexSoa soa, int64_t i) {
+    return (JkVec3){soa.e[V_X][i], soa.e[V_Y][i], soa.e[V_Z][i]};
+}
+
+static JkVec4 vertex_soa_get_vec4(VertexSoa soa, int64_t i) {
+    return (JkVec4){soa.e[V_X][i], soa.e[V_Y][i], soa.e[V_Z][i], soa.e[V_W][i]};
+}
+
+// Transforms points (implicit w of 1) by m. Only the first component_count rows of m are
+// evaluated, so pass 3 for an affine transform or 4 to get clip-space w.
+static VertexSoa vertex_soa_transform(
+        JkArena *arena, JkMat4 m, VertexSoa points, int32_t component_count) {
+    VertexSoa result = vertex_soa_alloc(arena, points.count, component_count);
+
+    JkF32x8 m_x8[4][4];
+    for (int32_t row = 0; row < component_count; row++) {
+        for (int32_t col = 0; col < 4; col++) {
+            m_x8[row][col] = jk_f32x8_broadcast(m.e[row][col]);
+        }
+    }
+
+    for (int64_t i = 0; i < points.count; i += LANE_COUNT) {
+        JkF32x8 x = jk_f32x8_load(points.e[V_X] + i);
+        JkF32x8 y = jk_f32x8_load(points.e[V_Y] + i);
+        JkF32x8 z = jk_f32x8_load(points.e[V_Z] + i);
+        for (int32_t row = 0; row < component_count; row++) {
+            JkF32x8 value = jk_f32x8_add(jk_f32x8_mul(m_x8[row][0], x), m_x8[row][3]);
+            value = jk_f32x8_add(value, jk_f32x8_mul(m_x8[row][1], y));
+            value = jk_f32x8_add(value, jk_f32x8_mul(m_x8[row][2], z));
+            jk_f32x8_store(result.e[row] + i, value);
+        }
+    }
+
+    return result;
+}
+
+// Returns -dot(normalized(normal), light_normal) for each of the unnormalized normals
+static float *vertex_soa_light(JkArena *arena, VertexSoa normals, JkVec3 light_normal) {
+    float *result = jk_arena_push(arena, normals.count * JK_SIZEOF(*result));
+
+    JkF32x8 zero = jk_f32x8_zero();
+    JkF32x8 light_x = jk_f32x8_broadcast(-light_normal.x);
+    JkF32x8 light_y = jk_f32x8_broadcast(-light_normal.y);
+    JkF32x8 light_z = jk_f32x8_broadcast(-light_normal.z);
+
+    for (int64_t i = 0; i < normals.count; i += LANE_COUNT) {
+        JkF32x8 x = jk_f32x8_load(normals.e[V_X] + i);
+        JkF32x8 y = jk_f32x8_load(normals.e[V_Y] + i);
+        JkF32x8 z = jk_f32x8_load(normals.e[V_Z] + i);
+
+        JkF32x8 magnitude_sqr = jk_f32x8_mul(x, x);
+        magnitude_sqr = jk_f32x8_add(magnitude_sqr, jk_f32x8_mul(y, y));
+        magnitude_sqr = jk_f32x8_add(magnitude_sqr, jk_f32x8_mul(z, z));
+
+        JkF32x8 dot = jk_f32x8_mul(x, light_x);
+        dot = jk_f32x8_add(dot, jk_f32x8_mul(y, light_y));
+        dot = jk_f32x8_add(dot, jk_f32x8_mul(z, light_z));
+
+        // Zero-length normals belong to vertices no face references. Mask out the 0/0.
+        JkF32x8 light = jk_f32x8_div(dot, jk_f32x8_sqrt(magnitude_sqr));
+        light = jk_f32x8_and(jk_f32x8_less_than(zero, magnitude_sqr), light);
+
+        jk_f32x8_store(result + i, light);
+    }
+
+    return result;
+}
+
+// ---- Vertex SoA end ---------------------------------------------------------
+
 typedef struct ScreenFromWorldResult {
     b32 clipped;
     JkVec3 v;
@@ -1378,6 +1611,341 @@ static NavPoint closest_point_on_ring(JkVec3 p, NavRing *ring) {
     return result;
 }
 
+typedef struct NavCache {
+    JkArena *arena;
+    b32 valid;
+    Assets *assets;
+    JkVec2 origin; // In nav cells, always whole numbers
+    NavRingArray rings;
+} NavCache;
+
+// Places the nav_dimensions window so the position is in the middle cell
+static JkVec2 nav_origin_from_world(JkVec3 position) {
+    JkVec2 result = jk_vec2_sub(jk_vec2_mul(1 / nav_density, jk_vec2_from_3(position)),
+            jk_vec2_mul(0.5, jk_vec2_from_i32(nav_dimensions)));
+    result.x = jk_floor_f32(result.x);
+    result.y = jk_floor_f32(result.y);
+    return result;
+}
+
+// Whether the cache was built for these assets and the position is far enough from the edges of
+// its window for a frame of movement
+static b32 nav_cache_covers(NavCache *cache, Assets *assets, JkVec3 position) {
+    if (!cache->valid || cache->assets != assets) {
+        return 0;
+    }
+    JkVec2 offset = jk_vec2_sub(
+            jk_vec2_mul(1 / nav_density, jk_vec2_from_3(position)), cache->origin);
+    return NAV_CACHE_MARGIN <= offset.x && offset.x < nav_dimensions.x - NAV_CACHE_MARGIN
+            && NAV_CACHE_MARGIN <= offset.y && offset.y < nav_dimensions.y - NAV_CACHE_MARGIN;
+}
+
+// Builds the rings for the nav_dimensions window at cache->origin. Only the rings outlive the
+// build, and they live in cache->arena.
+static void nav_cache_build(NavCache *cache) {
+    ObjectArray objects;
+    JK_ARRAY_FROM_SPAN(objects, cache->assets, cache->assets->objects);
+    JkVec2 nav_origin = cache->origin;
+
+    JkArenaScope scratch0 = jk_arena_scratch_begin();
+    JkArenaScope scratch1 = jk_arena_scratch_begin_not(scratch0.arena);
+    cache->arena->pos = 0;
+
+    JkMat4 nav_from_world = jk_mat4_scale((JkVec3){1 / nav_density, 1 / nav_density, 1});
+    nav_from_world = jk_mat4_mul(
+            jk_mat4_translate(jk_vec3_from_2(jk_vec2_mul(-1, nav_origin), 0)), nav_from_world);
+
+    int32_t nav_player_radius = jk_q16_from_f32(player_radius / nav_density);
+    int32_t nav_player_radius_sqr = jk_q16_mul(nav_player_radius, nav_player_radius);
+
+    JkArenaScope build_navmesh_scope = jk_arena_scope_begin(scratch0.arena);
+
+    // Collect navigation triangles
+    JkArenaScope nav_triangle_transform_scope = jk_arena_scope_begin(scratch1.arena);
+
+    for (ObjectId object_id = {1}; object_id.i < objects.count; object_id.i++) {
+        Object *object = objects.e + object_id.i;
+
+        JkVec3Array vertices;
+        JK_ARRAY_FROM_SPAN(vertices, cache->assets, object->vertices);
+
+        FaceArray faces;
+        JK_ARRAY_FROM_SPAN(faces, cache->assets, object->faces);
+
+        JkMat4 world_from_local = object_compute_world_from_local(objects, object_id);
+
+        VertexSoa local_vertices = vertex_soa_from_vec3s(scratch1.arena, vertices);
+        VertexSoa world_vertices =
+                vertex_soa_transform(scratch1.arena, world_from_local, local_vertices, 3);
+        VertexSoa nav_vertices_f32 =
+                vertex_soa_transform(scratch1.arena, nav_from_world, world_vertices, 3);
+
+        JkQ16Vec3 *nav_vertices =
+                jk_arena_push(scratch1.arena, vertices.count * JK_SIZEOF(*nav_vertices));
+        for (int64_t i = 0; i < vertices.count; i++) {
+            nav_vertices[i] = jk_q16_vec3_from_f32(vertex_soa_get_vec3(nav_vertices_f32, i));
+        }
+
+        // Process faces in world space for navigation grid
+        for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+            Face face = faces.e[face_index];
+
+            JkVec3 normal = jk_triangle_normal(vertex_soa_get_vec3(world_vertices, face.v[0]),
+                    vertex_soa_get_vec3(world_vertices, face.v[1]),
+                    vertex_soa_get_vec3(world_vertices, face.v[2]));
+            b32 walkable = 0.49f < jk_vec3_dot(normal, (JkVec3){0, 0, 1});
+
+            Q16Triangle triangle = {0};
+            for (int64_t i = 0; i < 3; i++) {
+                triangle.v[i] = nav_vertices[face.v[i]];
+            }
+
+            nav_triangle_setup(scratch0.arena, nav_dimensions, triangle, walkable);
+        }
+    }
+
+    jk_arena_scope_end(nav_triangle_transform_scope);
+
+    NavTriangleArray nav_triangles;
+    JK_ARRAY_FROM_ARENA_SCOPE(nav_triangles, build_navmesh_scope);
+
+    // Rasterize navigation triangles
+    NavContact **nav_contacts = jk_arena_push(
+            scratch0.arena, nav_dimensions.x * nav_dimensions.y * JK_SIZEOF(NavContact *));
+    for (int64_t i = 0; i < nav_dimensions.x * nav_dimensions.y; i++) {
+        nav_contacts[i] = &nil_contact;
+    }
+
+    JkArenaScope contacts_scope = jk_arena_scope_begin(scratch0.arena);
+    for (int64_t i = 0; i < nav_triangles.count; i++) {
+        nav_triangle_rasterize(
+                scratch0.arena, nav_contacts, nav_dimensions, nav_triangles.e + i);
+    }
+    NavContactArray nav_contacts_array;
+    JK_ARRAY_FROM_ARENA_SCOPE(nav_contacts_array, contacts_scope);
+
+    // Remove invalid contacts
+    for (int64_t i = 0; i < nav_dimensions.x * nav_dimensions.y; i++) {
+        nav_remove_invalid_contacts(
+                nav_dimensions, 0, (JkQ16Vec2){0}, nav_contacts + i, nav_player_radius_sqr);
+    }
+
+    scratch1.arena->pos = JK_ALIGN_UP(scratch1.arena->pos, 8);
+    JkArenaScope pass1_scope = jk_arena_scope_begin(scratch1.arena);
+    NavRingArray pass1_rings = nav_find_rings(scratch1.arena, nav_contacts);
+
+    // Find edges
+    NavEdge **nav_edges = jk_arena_push_zero(
+            scratch0.arena, nav_dimensions.x * nav_dimensions.y * JK_SIZEOF(NavEdge *));
+    for (int64_t ring_index = 0; ring_index < pass1_rings.count; ring_index++) {
+        NavRing *ring = pass1_rings.e + ring_index;
+
+        nav_ring_find_edges(scratch1.arena, nav_triangles, 0, nav_player_radius_sqr, ring);
+
+        int64_t point_count = 0;
+        JkQ16Vec3 points[3];
+        for (int64_t edge_index = 0; edge_index < 4; edge_index++) {
+            if (JK_FLAG_GET(ring->flags, NAV_RING_FOUND_EDGE_UP + edge_index)) {
+                points[point_count++] = ring->found_points[edge_index];
+            }
+            if (point_count == 1 && JK_FLAG_GET(ring->flags, NAV_RING_HAS_CORNER)) {
+                points[point_count++] = ring->corner;
+            }
+        }
+
+        for (int64_t i = 1; i < point_count; i++) {
+            nav_add_edge(scratch0.arena,
+                    nav_edges,
+                    nav_contacts,
+                    nav_dimensions,
+                    nav_player_radius,
+                    nav_player_radius_sqr,
+                    points[i - 1],
+                    points[i]);
+        }
+    }
+
+    jk_arena_scope_end(pass1_scope);
+
+    for (int64_t contact_index = 0; contact_index < nav_contacts_array.count; contact_index++) {
+        for (int64_t i = 0; i < 4; i++) {
+            nav_contacts_array.e[contact_index].rings[i] = &nil_ring;
+        }
+    }
+
+    cache->rings = nav_find_rings(cache->arena, nav_contacts);
+    for (int64_t ring_index = 0; ring_index < cache->rings.count; ring_index++) {
+        NavRing *ring = cache->rings.e + ring_index;
+
+        nav_ring_find_edges(
+                scratch1.arena, nav_triangles, nav_edges, nav_player_radius_sqr, ring);
+
+        int64_t first_inside = 0;
+        while (ring->corners[first_inside] == &nil_contact) {
+            first_inside++;
+        }
+
+        int64_t pivot = 0;
+        JkQ16Vec3 points[JK_ARRAY_COUNT(ring->vertices)];
+        for (int64_t i = 0; i < 4; i++) {
+            int64_t edge_index = JK_MOD(i + first_inside, 4);
+
+            if (ring->corners[edge_index] != &nil_contact) {
+                points[ring->vertex_count++] = jk_q16_vec3_from_2(
+                        jk_q16_vec2_from_i32(
+                                jk_int_vec2_add(ring->pos, nav_corner_offset[edge_index])),
+                        ring->corners[edge_index]->z);
+            }
+            if (JK_FLAG_GET(ring->flags, NAV_RING_FOUND_EDGE_UP + edge_index)) {
+                points[ring->vertex_count++] = ring->found_points[edge_index];
+                if (JK_FLAG_GET(ring->flags, NAV_RING_HAS_CORNER)) {
+                    JK_FLAG_SET(ring->flags, NAV_RING_HAS_CORNER, 0);
+                    pivot = ring->vertex_count++;
+                    points[pivot] = ring->corner;
+                }
+            }
+        }
+
+        if (pivot == 0 && 4 <= ring->vertex_count
+                && JK_ABS(points[1].z - points[3].z) < JK_ABS(points[0].z - points[2].z)) {
+            pivot = 1;
+        }
+
+        for (int64_t dest = 0; dest < ring->vertex_count; dest++) {
+            int64_t source = JK_MOD(dest + pivot, ring->vertex_count);
+            ring->vertices[dest] = world_from_nav(nav_origin, points[source]);
+        }
+    }
+
+    jk_arena_scope_end(build_navmesh_scope);
+    jk_arena_scope_end(scratch1);
+    jk_arena_scope_end(scratch0);
+
+    cache->valid = 1;
+}
+
+// ---- Dynamic resolution begin -----------------------------------------------
+
+#define RESOLUTION_HISTORY_COUNT 8
+#define RESOLUTION_SCALE_MIN 0.5f
+
+// Aim below the frame budget so a frame that runs a little long doesn't miss it
+#define RESOLUTION_TARGET_MS (0.85f * 1000.0f / FPS)
+
+typedef struct ResolutionController {
+    float scale; // Render dimensions relative to the output dimensions
+    int32_t sample_count;
+    int64_t frame_count; // Frames measured since the last adjustment
+    float frame_ms[RESOLUTION_HISTORY_COUNT];
+} ResolutionController;
+
+static void resolution_controller_reset(ResolutionController *controller, int32_t sample_count) {
+    *controller = (ResolutionController){
+        .scale = 1,
+        .sample_count = 1 << sample_count_log2_get(sample_count),
+    };
+}
+
+// Adjusts once a full history has been measured at the current settings. Raster cost is roughly
+// proportional to pixel count, so the scale moves by the square root of how far the average frame
+// is from the target. Samples are only dropped once the scale bottoms out, and only restored at
+// full scale.
+static void resolution_controller_update(
+        ResolutionController *controller, float frame_ms, int32_t sample_count_max) {
+    controller->frame_ms[controller->frame_count++ % RESOLUTION_HISTORY_COUNT] = frame_ms;
+    if (controller->frame_count < RESOLUTION_HISTORY_COUNT) {
+        return;
+    }
+
+    float average_ms = 0;
+    for (int64_t i = 0; i < RESOLUTION_HISTORY_COUNT; i++) {
+        average_ms += controller->frame_ms[i] / RESOLUTION_HISTORY_COUNT;
+    }
+    float ratio = RESOLUTION_TARGET_MS / average_ms;
+
+    if (ratio < 0.95f) {
+        if (RESOLUTION_SCALE_MIN < controller->scale) {
+            controller->scale =
+                    JK_MAX(RESOLUTION_SCALE_MIN, controller->scale * jk_sqrt_f32(ratio));
+        } else if (1 < controller->sample_count) {
+            controller->sample_count /= 2;
+        }
+        controller->frame_count = 0;
+    } else if (1.15f < ratio) {
+        if (controller->scale < 1) {
+            controller->scale = JK_MIN(1, controller->scale * jk_sqrt_f32(ratio));
+            controller->frame_count = 0;
+        } else if (controller->sample_count < sample_count_max) {
+            controller->sample_count *= 2;
+            controller->frame_count = 0;
+        }
+    }
+}
+
+// Maps each output pixel along an axis to the render pixel it copies when upscaling
+static int32_t *upscale_source_map(JkArena *arena, int32_t output_size, int32_t render_size) {
+    int32_t *result = jk_arena_push(arena, output_size * JK_SIZEOF(*result));
+    for (int32_t i = 0; i < output_size; i++) {
+        result[i] = (int32_t)((int64_t)i * render_size / output_size);
+    }
+    return result;
+}
+
+// First output pixel along an axis whose source is at or after the given render pixel
+static int32_t upscale_output_begin(int32_t render_pos, int32_t output_size, int32_t render_size) {
+    int64_t result = ((int64_t)render_pos * output_size + render_size - 1) / render_size;
+    return (int32_t)JK_MIN(result, output_size);
+}
+
+// ---- Dynamic resolution end -------------------------------------------------
+
+// The front end's output for one frame, which is everything the rasterizer and the overlay pass
+// need. Pipelined mode bins into one of these while rasterizing the other.
+typedef struct FrameBins {
+    JkIntVec2 dimensions; // Render dimensions, which may be scaled down from the output's
+    JkIntVec2 output_dimensions;
+    int32_t sample_count;
+    int32_t *upscale_sources[2]; // Per-axis upscale_source_map, or null when rendering unscaled
+    JkMat4 clip_from_world;
+    JkMat4 screen_from_ndc;
+    int64_t frame_id;
+    b32 visibility_buffer;
+    JkIntRect tiles_rect;
+    TileArray tiles;
+    TriangleSetupArray triangle_setups;
+    TileScheduler scheduler;
+} FrameBins;
+
+// Nearest-neighbor upscales a resolved tile into every output pixel whose source lies within it.
+// Each output pixel has exactly one source, so tiles never write the same output pixel.
+static void tile_upscale(
+        JkColor *draw_buffer, FrameBins *bins, JkColor *tile_colors, JkIntRect tile_rect) {
+    JkIntRect output_rect;
+    for (int64_t axis = 0; axis < 2; axis++) {
+        int32_t output_size = bins->output_dimensions.v[axis];
+        int32_t render_size = bins->dimensions.v[axis];
+        output_rect.min.v[axis] =
+                upscale_output_begin(tile_rect.min.v[axis], output_size, render_size);
+        output_rect.max.v[axis] =
+                upscale_output_begin(tile_rect.max.v[axis], output_size, render_size);
+    }
+
+    for (int32_t y = output_rect.min.y; y < output_rect.max.y; y++) {
+        JkColor *source_row =
+                tile_colors + TILE_SIDE_LENGTH * (bins->upscale_sources[1][y] - tile_rect.min.y);
+        JkColor *output_row = draw_buffer + DRAW_BUFFER_SIDE_LENGTH * y;
+        for (int32_t x = output_rect.min.x; x < output_rect.max.x; x++) {
+            output_row[x] = source_row[bins->upscale_sources[0][x] - tile_rect.min.x];
+        }
+    }
+}
+
+static JkMat4 screen_from_ndc_get(JkIntVec2 dimensions) {
+    JkMat4 result = jk_mat4_translate((JkVec3){1, -1, 0});
+    return jk_mat4_mul(
+            jk_mat4_scale((JkVec3){dimensions.x / 2.0f, -dimensions.y / 2.0f, 1}), result);
+}
+
 static int64_t recorded_frame_count(Environment *env) {
     return (env->record_arena.pos - JK_SIZEOF(Recording)) / JK_SIZEOF(RecordedFrame);
 }
@@ -1389,10 +1957,19 @@ void render(JkContext *context, Environment *env) {
 
     light_normal = jk_vec3_normalized(light_dir);
 
-    static JkIntRect volatile tiles_rect_shared;
-    static TileArray volatile tiles_shared;
+    static FrameBins frame_bins[2];
+    static int64_t bins_latest;
+    static b32 pipelined;
+
+    static ResolutionController resolution;
+    static int64_t cpu_frequency;
 
-    _Alignas(64) static int32_t volatile next_tile_index;
+    static NavCache nav_caches[2];
+    static int64_t nav_cache_front;
+    static b32 nav_build_pending;
+
+    static SchedulerThreadStats scheduler_stats[SCHEDULER_THREAD_COUNT_MAX];
+    static int64_t scheduler_stats_frame_count;
 
     JkArenaScope scratch0 = {0};
     JkArenaScope scratch1 = {0};
@@ -1403,18 +1980,35 @@ void render(JkContext *context, Environment *env) {
     JkMat4 clip_from_world = jk_mat4_i;
     JkMat4 screen_from_ndc = jk_mat4_i;
 
-    NavContact **nav_contacts = 0;
     NavRingArray nav_rings = {0};
-    NavPoint start = {.distance_sqr = jk_infinity_f32.f32};
+    NavPoint start = {.distance_sqr = jk_infinity_f32.f32, .ring = &nil_ring};
 
     TextureArray textures;
     JK_ARRAY_FROM_SPAN(textures, env->assets, env->assets->textures);
 
     Recording *recording = (Recording *)env->record_arena.memory.data;
 
+    // The front end always bins into the older slot. Normally the same frame rasterizes it. When
+    // pipelined, the rasterizer works on the slot binned last frame at the same time.
+    int64_t build_slot = !bins_latest;
+    int64_t raster_slot = pipelined ? bins_latest : build_slot;
+
+    // Narrow sections see a channel of one, so record the real thread count up front
+    int64_t thread_count = jk_context->channel.count;
+
     JK_CHANNEL_NARROW(0) {
         input = env->input;
 
+        if (!triangle_fill) {
+            triangle_fill_select(JK_FLAG_GET(env->flags, ENV_FLAG_EIGHT_LANES));
+
+            // Threads past this still rasterize, they just go uncounted in the scheduler stats
+            JK_SOFT_ASSERT(thread_count <= SCHEDULER_THREAD_COUNT_MAX);
+        }
+        if (!resolution.scale) {
+            resolution_controller_reset(&resolution, env->sample_count);
+        }
+
         if (env->record_arena.pos <= 0) {
             jk_arena_push_zero(&env->record_arena, sizeof(Recording));
         }
@@ -1553,264 +2147,116 @@ void render(JkContext *context, Environment *env) {
         // ---- Navigation begin ----------------------------------------------
         JK_PROFILE_ZONE_TIME_BEGIN(walk_manifold);
 
-        JkVec2 nav_origin = jk_vec2_sub(
-                jk_vec2_mul(1 / nav_density, jk_vec2_from_3(env->state.player_position)),
-                jk_vec2_mul(0.5, jk_vec2_from_i32(nav_dimensions)));
-        nav_origin.x = jk_floor_f32(nav_origin.x);
-        nav_origin.y = jk_floor_f32(nav_origin.y);
-
-        JkMat4 nav_from_world = jk_mat4_scale((JkVec3){1 / nav_density, 1 / nav_density, 1});
-        nav_from_world = jk_mat4_mul(
-                jk_mat4_translate(jk_vec3_from_2(jk_vec2_mul(-1, nav_origin), 0)), nav_from_world);
-
-        int32_t nav_player_radius = jk_q16_from_f32(player_radius / nav_density);
-        int32_t nav_player_radius_sqr = jk_q16_mul(nav_player_radius, nav_player_radius);
-
-        JkArenaScope build_navmesh_scope = jk_arena_scope_begin(scratch0.arena);
-
-        // Collect navigation triangles
-        JkArenaScope nav_triangle_transform_scope = jk_arena_scope_begin(scratch1.arena);
-
-        for (ObjectId object_id = {1}; object_id.i < objects.count; object_id.i++) {
-            Object *object = objects.e + object_id.i;
-
-            JkVec3Array vertices;
-            JK_ARRAY_FROM_SPAN(vertices, env->assets, object->vertices);
-
-            FaceArray faces;
-            JK_ARRAY_FROM_SPAN(faces, env->assets, object->faces);
-
-            JkMat4 world_from_local = object_compute_world_from_local(objects, object_id);
-
-            JkVec3 *world_vertices =
-                    jk_arena_push(scratch1.arena, vertices.count * JK_SIZEOF(*world_vertices));
-            for (int64_t i = 0; i < vertices.count; i++) {
-                world_vertices[i] = jk_mat4_mul_point(world_from_local, vertices.e[i]);
-            }
-
-            JkQ16Vec3 *nav_vertices =
-                    jk_arena_push(scratch1.arena, vertices.count * JK_SIZEOF(*nav_vertices));
-            for (int64_t i = 0; i < vertices.count; i++) {
-                JkVec3 vert_f32 = jk_mat4_mul_point(nav_from_world, world_vertices[i]);
-                nav_vertices[i] = jk_q16_vec3_from_f32(vert_f32);
-            }
-
-            // Process faces in world space for navigation grid
-            for (int64_t face_index = 0; face_index < faces.count; face_index++) {
-                Face face = faces.e[face_index];
-
-                JkVec3 normal = jk_triangle_normal(world_vertices[face.v[0]],
-                        world_vertices[face.v[1]],
-                        world_vertices[face.v[2]]);
-                b32 walkable = 0.49f < jk_vec3_dot(normal, (JkVec3){0, 0, 1});
-
-                Q16Triangle triangle = {0};
-                for (int64_t i = 0; i < 3; i++) {
-                    triangle.v[i] = nav_vertices[face.v[i]];
-                }
-
-                nav_triangle_setup(scratch0.arena, nav_dimensions, triangle, walkable);
-            }
-        }
-
-        jk_arena_scope_end(nav_triangle_transform_scope);
-
-        NavTriangleArray nav_triangles;
-        JK_ARRAY_FROM_ARENA_SCOPE(nav_triangles, build_navmesh_scope);
-
-        // Rasterize navigation triangles
-        nav_contacts = jk_arena_push(
-                scratch0.arena, nav_dimensions.x * nav_dimensions.y * JK_SIZEOF(NavContact *));
-        for (int64_t i = 0; i < nav_dimensions.x * nav_dimensions.y; i++) {
-            nav_contacts[i] = &nil_contact;
-        }
-
-        JkArenaScope contacts_scope = jk_arena_scope_begin(scratch0.arena);
-        for (int64_t i = 0; i < nav_triangles.count; i++) {
-            nav_triangle_rasterize(
-                    scratch0.arena, nav_contacts, nav_dimensions, nav_triangles.e + i);
+        // A build requested last frame ran alongside its rasterization and is complete by now
+        if (nav_build_pending) {
+            nav_build_pending = 0;
+            nav_cache_front = !nav_cache_front;
         }
-        NavContactArray nav_contacts_array;
-        JK_ARRAY_FROM_ARENA_SCOPE(nav_contacts_array, contacts_scope);
-
-        // Remove invalid contacts
-        for (int64_t i = 0; i < nav_dimensions.x * nav_dimensions.y; i++) {
-            nav_remove_invalid_contacts(
-                    nav_dimensions, 0, (JkQ16Vec2){0}, nav_contacts + i, nav_player_radius_sqr);
+        NavCache *nav = nav_caches + nav_cache_front;
+        if (nav_cache_covers(nav, env->assets, env->state.player_position)) {
+            nav_rings = nav->rings;
+            for (int64_t i = 0; i < nav_rings.count; i++) {
+                nav_rings.e[i].flags &= ~(JK_MASK(NAV_RING_ENQUEUED) | JK_MASK(NAV_RING_DRAWN));
+            }
         }
 
-        scratch1.arena->pos = JK_ALIGN_UP(scratch1.arena->pos, 8);
-        JkArenaScope pass1_scope = jk_arena_scope_begin(scratch1.arena);
-        NavRingArray pass1_rings = nav_find_rings(scratch1.arena, nav_contacts);
-
-        // Find edges
-        NavEdge **nav_edges = jk_arena_push_zero(
-                scratch0.arena, nav_dimensions.x * nav_dimensions.y * JK_SIZEOF(NavEdge *));
-        for (int64_t ring_index = 0; ring_index < pass1_rings.count; ring_index++) {
-            NavRing *ring = pass1_rings.e + ring_index;
-
-            nav_ring_find_edges(scratch1.arena, nav_triangles, 0, nav_player_radius_sqr, ring);
+        JkVec4 yaw_quat = jk_quat_angle_axis(env->state.camera_yaw, (JkVec3){0, 0, 1});
 
-            int64_t point_count = 0;
-            JkQ16Vec3 points[3];
-            for (int64_t edge_index = 0; edge_index < 4; edge_index++) {
-                if (JK_FLAG_GET(ring->flags, NAV_RING_FOUND_EDGE_UP + edge_index)) {
-                    points[point_count++] = ring->found_points[edge_index];
-                }
-                if (point_count == 1 && JK_FLAG_GET(ring->flags, NAV_RING_HAS_CORNER)) {
-                    points[point_count++] = ring->corner;
+        // The player can't move until a cache around them has been built
+        if (nav_rings.count) {
+            for (int64_t i = 0; i < nav_rings.count; i++) {
+                NavRing *ring = nav_rings.e + i;
+                NavPoint candidate = closest_point_on_ring(env->state.player_position, ring);
+                if (candidate.distance_sqr < start.distance_sqr) {
+                    start = candidate;
                 }
             }
 
-            for (int64_t i = 1; i < point_count; i++) {
-                nav_add_edge(scratch0.arena,
-                        nav_edges,
-                        nav_contacts,
-                        nav_dimensions,
-                        nav_player_radius,
-                        nav_player_radius_sqr,
-                        points[i - 1],
-                        points[i]);
+            JkVec3 target = start.p;
+            JkVec3 forward = {0};
+            if (jk_key_down(&input.keyboard, JK_KEY_W)) {
+                forward.y += 1;
             }
-        }
-
-        jk_arena_scope_end(pass1_scope);
-
-        for (int64_t contact_index = 0; contact_index < nav_contacts_array.count; contact_index++) {
-            for (int64_t i = 0; i < 4; i++) {
-                nav_contacts_array.e[contact_index].rings[i] = &nil_ring;
+            if (jk_key_down(&input.keyboard, JK_KEY_S)) {
+                forward.y -= 1;
             }
-        }
-
-        nav_rings = nav_find_rings(scratch1.arena, nav_contacts);
-        for (int64_t ring_index = 0; ring_index < nav_rings.count; ring_index++) {
-            NavRing *ring = nav_rings.e + ring_index;
-
-            nav_ring_find_edges(
-                    scratch1.arena, nav_triangles, nav_edges, nav_player_radius_sqr, ring);
-
-            int64_t first_inside = 0;
-            while (ring->corners[first_inside] == &nil_contact) {
-                first_inside++;
+            if (jk_key_down(&input.keyboard, JK_KEY_A)) {
+                forward.x -= 1;
             }
-
-            int64_t pivot = 0;
-            JkQ16Vec3 points[JK_ARRAY_COUNT(ring->vertices)];
-            for (int64_t i = 0; i < 4; i++) {
-                int64_t edge_index = JK_MOD(i + first_inside, 4);
-
-                if (ring->corners[edge_index] != &nil_contact) {
-                    points[ring->vertex_count++] = jk_q16_vec3_from_2(
-                            jk_q16_vec2_from_i32(
-                                    jk_int_vec2_add(ring->pos, nav_corner_offset[edge_index])),
-                            ring->corners[edge_index]->z);
-                }
-                if (JK_FLAG_GET(ring->flags, NAV_RING_FOUND_EDGE_UP + edge_index)) {
-                    points[ring->vertex_count++] = ring->found_points[edge_index];
-                    if (JK_FLAG_GET(ring->flags, NAV_RING_HAS_CORNER)) {
-                        JK_FLAG_SET(ring->flags, NAV_RING_HAS_CORNER, 0);
-                        pivot = ring->vertex_count++;
-                        points[pivot] = ring->corner;
-                    }
-                }
+            if (jk_key_down(&input.keyboard, JK_KEY_D)) {
+                forward.x += 1;
             }
-
-            if (pivot == 0 && 4 <= ring->vertex_count
-                    && JK_ABS(points[1].z - points[3].z) < JK_ABS(points[0].z - points[2].z)) {
-                pivot = 1;
+            forward = jk_quat_rotate(yaw_quat, forward);
+            JkVec3 right = {-forward.y, forward.x};
+
+            JkVec3 up;
+            {
+                JkVec3 a = start.ring->vertices[0];
+                JkVec3 b = start.ring->vertices[start.triangle_index - 1];
+                JkVec3 c = start.ring->vertices[start.triangle_index];
+                up = jk_vec3_cross(jk_vec3_sub(b, a), jk_vec3_sub(c, a));
             }
-
-            for (int64_t dest = 0; dest < ring->vertex_count; dest++) {
-                int64_t source = JK_MOD(dest + pivot, ring->vertex_count);
-                ring->vertices[dest] = world_from_nav(nav_origin, points[source]);
+            if (EPSILON < jk_vec3_magnitude_sqr(up)) {
+                up = jk_vec3_normalized(up);
+            } else {
+                up = (JkVec3){0, 0, 1};
             }
-        }
 
-        jk_arena_scope_end(build_navmesh_scope);
-
-        {
-            for (int64_t i = 0; i < nav_rings.count; i++) {
-                NavRing *ring = nav_rings.e + i;
-                NavPoint candidate = closest_point_on_ring(env->state.player_position, ring);
-                if (candidate.distance_sqr < start.distance_sqr) {
-                    start = candidate;
-                }
+            JkVec3 direction = jk_vec3_cross(right, up);
+            if (jk_vec3_magnitude_sqr(direction) < EPSILON) {
+                // project the forward vector onto the walk plane
+                direction = jk_vec3_sub(forward,
+                        jk_vec3_mul(jk_vec3_dot(forward, up) / jk_vec3_magnitude_sqr(up), up));
             }
-        }
-
-        JkVec4 yaw_quat = jk_quat_angle_axis(env->state.camera_yaw, (JkVec3){0, 0, 1});
-
-        JkVec3 target = start.p;
-        JkVec3 forward = {0};
-        if (jk_key_down(&input.keyboard, JK_KEY_W)) {
-            forward.y += 1;
-        }
-        if (jk_key_down(&input.keyboard, JK_KEY_S)) {
-            forward.y -= 1;
-        }
-        if (jk_key_down(&input.keyboard, JK_KEY_A)) {
-            forward.x -= 1;
-        }
-        if (jk_key_down(&input.keyboard, JK_KEY_D)) {
-            forward.x += 1;
-        }
-        forward = jk_quat_rotate(yaw_quat, forward);
-        JkVec3 right = {-forward.y, forward.x};
-
-        JkVec3 up;
-        {
-            JkVec3 a = start.ring->vertices[0];
-            JkVec3 b = start.ring->vertices[start.triangle_index - 1];
-            JkVec3 c = start.ring->vertices[start.triangle_index];
-            up = jk_vec3_cross(jk_vec3_sub(b, a), jk_vec3_sub(c, a));
-        }
-        if (EPSILON < jk_vec3_magnitude_sqr(up)) {
-            up = jk_vec3_normalized(up);
-        } else {
-            up = (JkVec3){0, 0, 1};
-        }
 
-        JkVec3 direction = jk_vec3_cross(right, up);
-        if (jk_vec3_magnitude_sqr(direction) < EPSILON) {
-            // project the forward vector onto the walk plane
-            direction = jk_vec3_sub(
-                    forward, jk_vec3_mul(jk_vec3_dot(forward, up) / jk_vec3_magnitude_sqr(up), up));
-        }
-
-        if (EPSILON < jk_vec3_magnitude_sqr(direction)) {
-            direction = jk_vec3_normalized(direction);
-            target = jk_vec3_add(target, jk_vec3_mul(SPEED * DELTA_TIME, direction));
-        }
-
-        // Compute max depth
-        float step_size = JK_SQRT_2 * nav_density;
-        int64_t max_steps = jk_ceil_f32((SPEED * DELTA_TIME) / step_size);
-        int64_t max_depth = 2 * max_steps + 1;
-
-        JK_ARENA_SCOPE(scratch0.arena) {
-            NavPoint destination = {.distance_sqr = jk_infinity_f32.f32};
-            NavRingQueue q = q_new(scratch0.arena, 1024);
-            q_enqueue(&q, start.ring);
-            int64_t depth = 0;
-            while (q.start < q.end && depth < max_depth) {
-                int64_t depth_end = q.end;
-                while (q.start < depth_end) {
-                    NavRing *ring = q_dequeue(&q);
+            if (EPSILON < jk_vec3_magnitude_sqr(direction)) {
+                direction = jk_vec3_normalized(direction);
+                target = jk_vec3_add(target, jk_vec3_mul(SPEED * DELTA_TIME, direction));
+            }
 
-                    NavPoint candidate = closest_point_on_ring(target, ring);
-                    if (candidate.distance_sqr <= destination.distance_sqr) {
-                        destination = candidate;
-                    }
+            // Compute max depth
+            float step_size = JK_SQRT_2 * nav_density;
+            int64_t max_steps = jk_ceil_f32((SPEED * DELTA_TIME) / step_size);
+            int64_t max_depth = 2 * max_steps + 1;
+
+            JK_ARENA_SCOPE(scratch0.arena) {
+                NavPoint destination = {.distance_sqr = jk_infinity_f32.f32};
+                NavRingQueue q = q_new(scratch0.arena, 1024);
+                q_enqueue(&q, start.ring);
+                int64_t depth = 0;
+                while (q.start < q.end && depth < max_depth) {
+                    int64_t depth_end = q.end;
+                    while (q.start < depth_end) {
+                        NavRing *ring = q_dequeue(&q);
+
+                        NavPoint candidate = closest_point_on_ring(target, ring);
+                        if (candidate.distance_sqr <= destination.distance_sqr) {
+                            destination = candidate;
+                        }
 
-                    for (int64_t i = 0; i < 4; i++) {
-                        if (!JK_FLAG_GET(ring->neighbors[i]->flags, NAV_RING_ENQUEUED)) {
-                            q_enqueue(&q, ring->neighbors[i]);
+                        for (int64_t i = 0; i < 4; i++) {
+                            if (!JK_FLAG_GET(ring->neighbors[i]->flags, NAV_RING_ENQUEUED)) {
+                                q_enqueue(&q, ring->neighbors[i]);
+                            }
                         }
                     }
+                    depth++;
                 }
-                depth++;
+                env->state.player_position = destination.p;
             }
-            env->state.player_position = destination.p;
+        }
+
+        // Request a cache centered on the player's new position. It gets built during this
+        // frame's rasterization and the current one stays in use until then.
+        JkVec2 nav_origin = nav_origin_from_world(env->state.player_position);
+        if (!nav->valid || nav->assets != env->assets || nav->origin.x != nav_origin.x
+                || nav->origin.y != nav_origin.y) {
+            nav_caches[!nav_cache_front] = (NavCache){
+                .arena = env->nav_arenas + !nav_cache_front,
+                .assets = env->assets,
+                .origin = nav_origin,
+            };
+            nav_build_pending = 1;
         }
 
         JK_PROFILE_ZONE_END(walk_manifold);
@@ -1830,26 +2276,56 @@ void render(JkContext *context, Environment *env) {
         clip_from_world = jk_mat4_mul(
                 jk_mat4_conversion_to((JkCoordinateSystem){JK_RIGHT, JK_UP, JK_BACKWARD}),
                 clip_from_world);
-        clip_from_world = jk_mat4_mul(
-                jk_mat4_perspective(input.dimensions, JK_PI / 3, NEAR_CLIP), clip_from_world);
+        JkMat4 projection = jk_mat4_perspective(input.dimensions, FOV_RADIANS, NEAR_CLIP);
+        clip_from_world = jk_mat4_mul(projection, clip_from_world);
 
-        screen_from_ndc = jk_mat4_translate((JkVec3){1, -1, 0});
-        screen_from_ndc = jk_mat4_mul(
-                jk_mat4_scale((JkVec3){input.dimensions.x / 2.0f, -input.dimensions.y / 2.0f, 1}),
-                screen_from_ndc);
+        JkIntVec2 render_dimensions;
+        for (int64_t i = 0; i < 2; i++) {
+            render_dimensions.v[i] =
+                    JK_MAX(1, (int32_t)(resolution.scale * input.dimensions.v[i] + 0.5f));
+        }
+        screen_from_ndc = screen_from_ndc_get(render_dimensions);
+        float pixels_per_unit = 0.5f * render_dimensions.y * projection.e[1][1];
 
         JkIntRect tiles_rect;
         tiles_rect.min = (JkIntVec2){0};
         for (int64_t i = 0; i < 2; i++) {
             tiles_rect.max.v[i] =
-                    JK_ALIGN_UP(input.dimensions.v[i], TILE_SIDE_LENGTH) / TILE_SIDE_LENGTH;
+                    JK_ALIGN_UP(render_dimensions.v[i], TILE_SIDE_LENGTH) / TILE_SIDE_LENGTH;
+        }
+        FrameBins *bins = frame_bins + build_slot;
+        JkArena *bin_arena = env->bin_arenas + build_slot;
+        bin_arena->pos = 0;
+        bins->dimensions = render_dimensions;
+        bins->output_dimensions = input.dimensions;
+        bins->sample_count = resolution.sample_count;
+        b32 scaled = render_dimensions.x != input.dimensions.x
+                || render_dimensions.y != input.dimensions.y;
+        for (int64_t i = 0; i < 2; i++) {
+            bins->upscale_sources[i] = scaled
+                    ? upscale_source_map(bin_arena, input.dimensions.v[i], render_dimensions.v[i])
+                    : 0;
         }
+        bins->clip_from_world = clip_from_world;
+        bins->screen_from_ndc = screen_from_ndc;
+        bins->frame_id = frame_id;
+        bins->visibility_buffer = JK_FLAG_GET(env->flags, ENV_FLAG_VISIBILITY_BUFFER);
+
         TileArray tiles;
         tiles.count = tiles_rect.max.x * tiles_rect.max.y;
-        tiles.e = jk_arena_push_zero(scratch0.arena, sizeof(*tiles.e) * tiles.count);
+        tiles.e = jk_arena_push_zero(bin_arena, sizeof(*tiles.e) * tiles.count);
+
+        // Near clipping can split a face into at most two triangles
+        int64_t face_count = 0;
+        for (ObjectId object_id = {1}; object_id.i < objects.count; object_id.i++) {
+            face_count += objects.e[object_id.i].faces.size / JK_SIZEOF(Face);
+        }
+        TriangleSetupArray triangle_setups = {
+            .e = jk_arena_push(bin_arena, 2 * face_count * JK_SIZEOF(TriangleSetup)),
+        };
 
-        tiles_rect_shared = tiles_rect;
-        tiles_shared = tiles;
+        bins->tiles_rect = tiles_rect;
+        bins->tiles = tiles;
 
         for (ObjectId object_id = {1}; object_id.i < objects.count; object_id.i++) {
             Object *object = objects.e + object_id.i;
@@ -1859,48 +2335,41 @@ void render(JkContext *context, Environment *env) {
             JkVec3Array vertices;
             JK_ARRAY_FROM_SPAN(vertices, env->assets, object->vertices);
 
-            FaceArray faces;
-            JK_ARRAY_FROM_SPAN(faces, env->assets, object->faces);
-
             JkMat4 world_from_local = object_compute_world_from_local(objects, object_id);
             JkMat4 clip_from_local = jk_mat4_mul(clip_from_world, world_from_local);
 
-            JkVec3Array world_vertices;
-            JK_ARENA_PUSH_ARRAY(scratch0.arena, world_vertices, vertices.count);
-            for (int64_t i = 0; i < world_vertices.count; i++) {
-                world_vertices.e[i] = jk_mat4_mul_point(world_from_local, vertices.e[i]);
-            }
-
-            // Compute vertex normals
-            JkVec3Array normals;
-            JK_ARENA_PUSH_ARRAY_ZERO(scratch0.arena, normals, vertices.count);
+            FaceArray faces;
+            JK_ARRAY_FROM_SPAN(faces,
+                    env->assets,
+                    object_lod_select(object, world_from_local, clip_from_world, pixels_per_unit));
+
+            VertexSoa local_vertices = vertex_soa_from_vec3s(scratch0.arena, vertices);
+            VertexSoa world_vertices =
+                    vertex_soa_transform(scratch0.arena, world_from_local, local_vertices, 3);
+            VertexSoa clip_vertices =
+                    vertex_soa_transform(scratch0.arena, clip_from_local, local_vertices, 4);
+
+            // Accumulate unnormalized vertex normals. vertex_soa_light normalizes them.
+            VertexSoa normals = vertex_soa_alloc(scratch0.arena, vertices.count, 3);
             for (int64_t face_index = 0; face_index < faces.count; face_index++) {
                 Face *face = faces.e + face_index;
-                JkVec3 normal = jk_triangle_normal(world_vertices.e[face->v[0]],
-                        world_vertices.e[face->v[1]],
-                        world_vertices.e[face->v[2]]);
+                JkVec3 normal = jk_triangle_normal(vertex_soa_get_vec3(world_vertices, face->v[0]),
+                        vertex_soa_get_vec3(world_vertices, face->v[1]),
+                        vertex_soa_get_vec3(world_vertices, face->v[2]));
                 for (int64_t i = 0; i < 3; i++) {
-                    normals.e[face->v[i]] = jk_vec3_add(normals.e[face->v[i]], normal);
+                    for (int32_t component = 0; component < 3; component++) {
+                        normals.e[component][face->v[i]] += normal.v[component];
+                    }
                 }
             }
-            for (int64_t i = 0; i < normals.count; i++) {
-                normals.e[i] = jk_vec3_normalized(normals.e[i]);
-            }
-
-            JkVec4Array clip_vertices;
-            JK_ARENA_PUSH_ARRAY(scratch0.arena, clip_vertices, vertices.count);
-            for (int64_t i = 0; i < clip_vertices.count; i++) {
-                clip_vertices.e[i] =
-                        jk_mat4_mul_vec4(clip_from_local, jk_vec4_from_3(vertices.e[i], 1));
-            }
+            float *vertex_light = vertex_soa_light(scratch0.arena, normals, light_normal);
 
-            JkVec3Array local_scale_verts = vertices;
+            VertexSoa local_scale_verts = local_vertices;
             if (object->repeat_size) {
-                JK_ARENA_PUSH_ARRAY(scratch0.arena, local_scale_verts, vertices.count);
-                for (int64_t i = 0; i < local_scale_verts.count; i++) {
-                    local_scale_verts.e[i] = jk_vec3_mul(1 / object->repeat_size,
-                            jk_vec3_hadamard_prod(vertices.e[i], object->transform.scale));
-                }
+                JkMat4 repeat_from_local = jk_mat4_scale(
+                        jk_vec3_mul(1 / object->repeat_size, object->transform.scale));
+                local_scale_verts =
+                        vertex_soa_transform(scratch0.arena, repeat_from_local, local_vertices, 3);
             }
 
             // Clip and bin faces for later rendering
@@ -1912,7 +2381,7 @@ void render(JkContext *context, Environment *env) {
                 if (object->repeat_size) {
                     JkVec3 local_points[3];
                     for (int64_t i = 0; i < 3; i++) {
-                        local_points[i] = local_scale_verts.e[face.v[i]];
+                        local_points[i] = vertex_soa_get_vec3(local_scale_verts, face.v[i]);
                     }
                     JkVec3 normal =
                             jk_triangle_normal(local_points[0], local_points[1], local_points[2]);
@@ -1956,15 +2425,16 @@ void render(JkContext *context, Environment *env) {
                 // Calculate lighting
                 float light[3];
                 if (JK_FLAG_GET(object->flags, OBJ_FLAT)) {
-                    JkVec3 normal = jk_triangle_normal(world_vertices.e[face.v[0]],
-                            world_vertices.e[face.v[1]],
-                            world_vertices.e[face.v[2]]);
+                    JkVec3 normal =
+                            jk_triangle_normal(vertex_soa_get_vec3(world_vertices, face.v[0]),
+                                    vertex_soa_get_vec3(world_vertices, face.v[1]),
+                                    vertex_soa_get_vec3(world_vertices, face.v[2]));
                     for (int64_t i = 0; i < 3; i++) {
                         light[i] = -jk_vec3_dot(normal, light_normal);
                     }
                 } else {
                     for (int64_t i = 0; i < 3; i++) {
-                        light[i] = -jk_vec3_dot(normals.e[face.v[i]], light_normal);
+                        light[i] = vertex_light[face.v[i]];
                     }
                 }
 
@@ -1972,8 +2442,8 @@ void render(JkContext *context, Environment *env) {
                 TexturedVertexArray vs = {.e = jk_arena_pointer_current(scratch0.arena)};
                 for (int64_t i = 0; i < 3; i++) {
                     int64_t b_i = (i + 1) % 3;
-                    JkVec4 a = clip_vertices.e[face.v[i]];
-                    JkVec4 b = clip_vertices.e[face.v[b_i]];
+                    JkVec4 a = vertex_soa_get_vec4(clip_vertices, face.v[i]);
+                    JkVec4 b = vertex_soa_get_vec4(clip_vertices, face.v[b_i]);
                     b32 a_inside = !!(a.z < a.w);
                     b32 b_inside = !!(b.z < b.w);
                     if (a_inside != b_inside) { // Crosses clip plane, add interpolated vertex
@@ -2013,6 +2483,7 @@ void render(JkContext *context, Environment *env) {
                                 triangle_bounding_box(
                                         tile_coords[0], tile_coords[1], tile_coords[2]),
                                 tiles_rect);
+                        int32_t triangle_index = -1;
                         for (JkIntVec2 tile_pos = coverage.min; tile_pos.y < coverage.max.y;
                                 tile_pos.y++) {
                             for (tile_pos.x = coverage.min.x; tile_pos.x < coverage.max.x;
@@ -2045,12 +2516,21 @@ void render(JkContext *context, Environment *env) {
                                     }
                                 }
                                 if (valid) {
-                                    TriangleNode *new_node =
-                                            jk_arena_push(scratch1.arena, sizeof(*new_node));
-                                    new_node->tri = tri;
-                                    new_node->texture_id = object->texture_id;
-                                    new_node->next = tile->head;
-                                    tile->head = new_node;
+                                    if (triangle_index == -1) {
+                                        triangle_index = triangle_setups.count++;
+                                        triangle_setup(triangle_setups.e + triangle_index,
+                                                &tri,
+                                                object->texture_id);
+                                    }
+                                    TileChunk *chunk = tile->chunks;
+                                    if (!chunk || chunk->count == TILE_CHUNK_CAPACITY) {
+                                        chunk = jk_arena_push(bin_arena, sizeof(*chunk));
+                                        chunk->next = tile->chunks;
+                                        chunk->count = 0;
+                                        tile->chunks = chunk;
+                                    }
+                                    chunk->triangle_indexes[chunk->count++] = triangle_index;
+                                    tile->triangle_count++;
                                 }
                             }
                         }
@@ -2066,22 +2546,71 @@ void render(JkContext *context, Environment *env) {
 
         JK_PROFILE_ZONE_END(transform);
 
-        next_tile_index = 0;
+        bins->triangle_setups = triangle_setups;
+
+        tile_scheduler_init(&bins->scheduler, bin_arena, tiles, thread_count);
+        scheduler_stats_frame_count++;
 
         static JkProfileZone zone_rasterize;
         jk_profile_zone_begin(&timing_rasterize, &zone_rasterize, JKS("rasterize"), 0);
     }
 
-    jk_channel_sync();
+    // When pipelined, the other threads start on the previous frame's bins right away and thread 0
+    // joins them once it's done binning
+    if (!pipelined) {
+        jk_channel_sync();
+    }
 
     JkI256 bg = jk_i256_broadcast_i32(*(int32_t *)&bg_color);
 
+    SchedulerThreadStats untracked_stats = {0};
+    SchedulerThreadStats *stats = jk_context->channel.index < SCHEDULER_THREAD_COUNT_MAX
+            ? scheduler_stats + jk_context->channel.index
+            : &untracked_stats;
+    uint64_t time_work_begin = jk_cpu_timer_get();
+    uint64_t time_work_end;
+
+    // One thread builds the requested nav cache before it starts on tiles while the others steal
+    // its share. When pipelined, that's the thread which just finished binning.
+    int64_t nav_builder_index = pipelined ? 0 : thread_count - 1;
+    if (nav_build_pending && jk_context->channel.index == nav_builder_index) {
+        nav_cache_build(nav_caches + !nav_cache_front);
+    }
+
     {
-        JkIntRect tiles_rect = tiles_rect_shared;
-        TileArray tiles = tiles_shared;
+        FrameBins *bins = frame_bins + raster_slot;
+        JkIntRect tiles_rect = bins->tiles_rect;
+        TileArray tiles = bins->tiles;
+        TriangleSetupArray triangle_setups = bins->triangle_setups;
+
+        JkF32x8 all_set = jk_f32x8_from_i256_reinterpret(jk_i256_broadcast_i32(-1));
+        JkArenaScope samples_scope = jk_arena_scratch_begin();
+        TileSamples samples = {.sample_count_log2 = sample_count_log2_get(bins->sample_count)};
+        samples.sample_count = 1 << samples.sample_count_log2;
+        samples.color = jk_arena_push(samples_scope.arena,
+                samples.sample_count * TILE_PIXEL_COUNT * JK_SIZEOF(*samples.color));
+        samples.z = jk_arena_push(samples_scope.arena,
+                samples.sample_count * TILE_PIXEL_COUNT * JK_SIZEOF(*samples.z));
+        samples.uniform =
+                jk_arena_push(samples_scope.arena, TILE_PIXEL_COUNT * JK_SIZEOF(*samples.uniform));
+        if (bins->visibility_buffer) {
+            samples.triangle_ids = jk_arena_push(samples_scope.arena,
+                    samples.sample_count * TILE_PIXEL_COUNT * JK_SIZEOF(*samples.triangle_ids));
+        }
+        JkF32x8 no_triangle = jk_f32x8_broadcast(-1);
+
+        // When upscaling, tiles resolve here first since their output pixels aren't 1:1
+        b32 upscale = bins->upscale_sources[0] != 0;
+        JkColor *tile_colors =
+                jk_arena_push(samples_scope.arena, TILE_PIXEL_COUNT * JK_SIZEOF(*tile_colors));
+
+        int64_t thread_index = jk_context->channel.index;
         int32_t tile_index;
-        while ((tile_index = jk_atomic_add(&next_tile_index, 1)) < tiles.count) {
+        b32 stolen;
+        while ((tile_index = tile_scheduler_next(&bins->scheduler, thread_index, &stolen)) != -1) {
             Tile *tile = tiles.e + tile_index;
+            stats->tile_count++;
+            stats->stolen_count += stolen;
 
             JkIntVec2 tile_coord = {tile_index % tiles_rect.max.x, tile_index / tiles_rect.max.x};
             JkIntRect bounding_box;
@@ -2090,83 +2619,181 @@ void render(JkContext *context, Environment *env) {
                 bounding_box.max.v[i] = bounding_box.min.v[i] + TILE_SIDE_LENGTH;
             }
 
-            for (int32_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-                for (int32_t y = bounding_box.min.y; y < bounding_box.max.y; y++) {
-                    for (int32_t x = bounding_box.min.x; x < bounding_box.max.x; x += 8) {
-                        int32_t pixel_index =
-                                PIXEL_COUNT * sample_index + DRAW_BUFFER_SIDE_LENGTH * y + x;
-                        jk_i256_store(env->draw_buffer + pixel_index, bg);
-                        jk_f32x8_store(env->z_buffer + pixel_index, jk_f32x8_zero());
-                    }
+            samples.origin = bounding_box.min;
+            for (int32_t i = 0; i < samples.sample_count * TILE_PIXEL_COUNT; i += 8) {
+                jk_i256_store(samples.color + i, bg);
+                jk_f32x8_store(samples.z + i, jk_f32x8_zero());
+            }
+            if (bins->visibility_buffer) {
+                for (int32_t i = 0; i < samples.sample_count * TILE_PIXEL_COUNT; i += 8) {
+                    jk_f32x8_store(samples.triangle_ids + i, no_triangle);
                 }
             }
+            for (int32_t i = 0; i < TILE_PIXEL_COUNT; i += 8) {
+                jk_f32x8_store(samples.uniform + i, all_set);
+            }
 
             JkArenaScope triangle_scope = jk_arena_scratch_begin();
-            for (TriangleNode *node = tile->head; node; node = node->next) {
-                TriangleNode **slot = jk_arena_push(triangle_scope.arena, sizeof(*slot));
-                *slot = node;
+            // Pack each triangle's depth key above its index so one sort orders both
+            uint64_t *items = jk_arena_push(
+                    triangle_scope.arena, tile->triangle_count * JK_SIZEOF(*items));
+            uint64_t *tmp = jk_arena_push(
+                    triangle_scope.arena, tile->triangle_count * JK_SIZEOF(*tmp));
+            int64_t item_count = 0;
+            for (TileChunk *chunk = tile->chunks; chunk; chunk = chunk->next) {
+                for (int32_t i = 0; i < chunk->count; i++) {
+                    int32_t triangle_index = chunk->triangle_indexes[i];
+                    items[item_count++] =
+                            ((uint64_t)triangle_setups.e[triangle_index].depth_key << 32)
+                            | (uint32_t)triangle_index;
+                }
             }
-            TriangleNodePtrArray triangles;
-            JK_ARRAY_FROM_ARENA_SCOPE(triangles, triangle_scope);
-            quicksort_triangle_node_ptrs(triangles);
-
-            for (int64_t i = 0; i < triangles.count; i++) {
-                triangle_fill(
-                        env, triangles.e[i], textures.e + triangles.e[i]->texture_id, bounding_box);
+            items = radix_sort_by_high_u32(items, tmp, item_count);
+
+            if (bins->visibility_buffer) {
+                for (int64_t i = 0; i < item_count; i++) {
+                    int32_t triangle_index = (int32_t)(items[i] & 0xffffffff);
+                    TriangleSetup *setup = triangle_setups.e + triangle_index;
+                    Texture *texture = textures.e + setup->texture_id;
+                    if (texture->bg.a < 0xff) {
+                        // Alpha to coverage can leave some of its samples unwritten, which
+                        // depends on the shaded alpha, so it can't be deferred to tile_shade
+                        stats->shade_count +=
+                                triangle_fill(&samples, setup, texture, bounding_box);
+                    } else {
+                        triangle_fill_visibility(&samples, setup, triangle_index, bounding_box);
+                    }
+                }
+                stats->shade_count += tile_shade(&samples, triangle_setups, textures, bounding_box);
+            } else {
+                for (int64_t i = 0; i < item_count; i++) {
+                    TriangleSetup *setup = triangle_setups.e + (int32_t)(items[i] & 0xffffffff);
+                    stats->shade_count += triangle_fill(
+                            &samples, setup, textures.e + setup->texture_id, bounding_box);
+                }
             }
 
             jk_arena_scope_end(triangle_scope);
 
+            JkI256 byte_mask = jk_i256_broadcast_i32(0xff);
+            JkI256 rgb_mask = jk_i256_broadcast_i32(0x00ffffff);
             for (int32_t y = bounding_box.min.y; y < bounding_box.max.y; y++) {
                 for (int32_t x = bounding_box.min.x; x < bounding_box.max.x; x += 8) {
-                    JkI256 channels[3] = {jk_i256_zero(), jk_i256_zero(), jk_i256_zero()};
-                    for (int64_t sample_index = 0; sample_index < SAMPLE_COUNT; sample_index++) {
-                        JkI256 sample = jk_i256_load(env->draw_buffer
-                                + (PIXEL_COUNT * sample_index + DRAW_BUFFER_SIDE_LENGTH * y + x));
-                        JkI256 byte_mask = jk_i256_broadcast_i32(0xff);
-                        channels[0] = jk_i256_add_i32(channels[0], jk_i256_and(sample, byte_mask));
-                        channels[1] = jk_i256_add_i32(channels[1],
-                                jk_i256_and(
-                                        JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sample, 8), byte_mask));
-                        channels[2] = jk_i256_add_i32(channels[2],
-                                jk_i256_and(
-                                        JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sample, 16), byte_mask));
-                    }
-                    for (int32_t channel_index = 0; channel_index < 3; channel_index++) {
-                        channels[channel_index] =
-                                JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(channels[channel_index], 2);
-                    }
+                    int32_t pixel_index = tile_samples_index(&samples, x, y);
+                    JkI256 color;
+                    if (jk_f32x8_all(jk_f32x8_load(samples.uniform + pixel_index))) {
+                        color = jk_i256_and(jk_i256_load(samples.color + pixel_index), rgb_mask);
+                    } else {
+                        JkI256 channels[3] = {jk_i256_zero(), jk_i256_zero(), jk_i256_zero()};
+                        for (int64_t sample_index = 0; sample_index < samples.sample_count;
+                                sample_index++) {
+                            JkI256 sample = jk_i256_load(samples.color
+                                    + (TILE_PIXEL_COUNT * sample_index + pixel_index));
+                            channels[0] =
+                                    jk_i256_add_i32(channels[0], jk_i256_and(sample, byte_mask));
+                            channels[1] = jk_i256_add_i32(channels[1],
+                                    jk_i256_and(JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sample, 8),
+                                            byte_mask));
+                            channels[2] = jk_i256_add_i32(channels[2],
+                                    jk_i256_and(JK_I256_SHIFT_RIGHT_SIGN_FILL_I32(sample, 16),
+                                            byte_mask));
+                        }
+                        for (int32_t channel_index = 0; channel_index < 3; channel_index++) {
+                            channels[channel_index] = sample_sum_divide(
+                                    channels[channel_index], samples.sample_count_log2);
+                        }
 
-                    JkI256 color = channels[0];
-                    color = jk_i256_or(color, JK_I256_SHIFT_LEFT_I32(channels[1], 8));
-                    color = jk_i256_or(color, JK_I256_SHIFT_LEFT_I32(channels[2], 16));
+                        color = channels[0];
+                        color = jk_i256_or(color, JK_I256_SHIFT_LEFT_I32(channels[1], 8));
+                        color = jk_i256_or(color, JK_I256_SHIFT_LEFT_I32(channels[2], 16));
+                    }
 
-                    jk_i256_store(env->draw_buffer + (DRAW_BUFFER_SIDE_LENGTH * y + x), color);
+                    JkColor *resolved = upscale
+                            ? tile_colors + pixel_index
+                            : env->draw_buffer + (DRAW_BUFFER_SIDE_LENGTH * y + x);
+                    jk_i256_store(resolved, color);
                 }
             }
+
+            if (upscale) {
+                tile_upscale(env->draw_buffer, bins, tile_colors, bounding_box);
+            }
         }
+
+        jk_arena_scope_end(samples_scope);
+        time_work_end = jk_cpu_timer_get();
     }
 
     if (jk_context->channel.index == 0) {
         JK_FLAG_SET(env->flags, ENV_FLAG_RUNNING, !env->shutdown_requested);
     }
+
+    stats->busy_time += time_work_end - time_work_begin;
+    stats->work_end = time_work_end;
     jk_channel_sync();
 
     JK_CHANNEL_NARROW(0) {
+        // Every thread waited at the sync above from the end of its work until now
+        uint64_t time_synced = jk_cpu_timer_get();
+        int64_t stats_count = JK_MIN(thread_count, SCHEDULER_THREAD_COUNT_MAX);
+        for (int64_t i = 0; i < stats_count; i++) {
+            scheduler_stats[i].idle_time += time_synced - scheduler_stats[i].work_end;
+        }
+
         jk_profile_zone_end(&timing_rasterize);
 
-        jk_profile_frame_end();
+        int64_t frame_elapsed = jk_profile_frame_end();
+        if (JK_FLAG_GET(env->flags, ENV_FLAG_DYNAMIC_RESOLUTION)) {
+            if (!cpu_frequency) {
+                cpu_frequency = env->estimate_cpu_frequency(100);
+            }
+            float frame_ms = 1000.0f * frame_elapsed / cpu_frequency;
+            resolution_controller_update(&resolution, frame_ms, env->sample_count);
+
+            FrameBins *bins = frame_bins + raster_slot;
+            JK_LOGF(JK_LOG_INFO,
+                    jkfn("Frame "),
+                    jkfi(bins->frame_id),
+                    jkfn(": "),
+                    jkff(frame_ms, 2),
+                    jkfn(" ms at "),
+                    jkfi(bins->dimensions.x),
+                    jkfn("x"),
+                    jkfi(bins->dimensions.y),
+                    jkfn(" with "),
+                    jkfi(bins->sample_count),
+                    jkfn(" samples, next scale "),
+                    jkff(resolution.scale, 3),
+                    jkfn(" with "),
+                    jkfi(resolution.sample_count),
+                    jkfn(" samples"),
+                    jkf_nl);
+        } else {
+            resolution_controller_reset(&resolution, env->sample_count);
+        }
 
         if (jk_key_pressed(&input.keyboard, JK_KEY_P)) {
+            int64_t frequency = env->estimate_cpu_frequency(100);
             JK_ARENA_SCRATCH(log_scratch) {
-                jk_log(JK_LOG_INFO,
-                        jk_profile_report(log_scratch.arena, env->estimate_cpu_frequency(100)));
+                jk_log(JK_LOG_INFO, jk_profile_report(log_scratch.arena, frequency));
             }
+            scheduler_stats_report(scheduler_stats,
+                    JK_MIN(thread_count, SCHEDULER_THREAD_COUNT_MAX),
+                    scheduler_stats_frame_count,
+                    frequency);
+            jk_memset(scheduler_stats, 0, JK_SIZEOF(scheduler_stats));
+            scheduler_stats_frame_count = 0;
         }
 
+        // Overlays describe the frame that was just rasterized, which lags by one when pipelined
+        FrameBins *bins = frame_bins + raster_slot;
         if (JK_FLAG_GET(env->flags, ENV_FLAG_DEBUG_DISPLAY)) {
             JkColor nav_color = {.r = 0, .g = 255, .b = 0, .a = 255};
-            nav_draw_rings(env, screen_from_ndc, clip_from_world, nav_color, start.ring);
+            nav_draw_rings(env,
+                    screen_from_ndc_get(bins->output_dimensions),
+                    bins->clip_from_world,
+                    nav_color,
+                    start.ring);
 
             for (int64_t ring_index = 0; ring_index < nav_rings.count; ring_index++) {
             }
@@ -2174,15 +2801,16 @@ void render(JkContext *context, Environment *env) {
             JkShapesRenderer renderer;
             JkShapeArray shapes = (JkShapeArray){
                 .count = JK_ARRAY_COUNT(env->assets->shapes), .e = env->assets->shapes};
-            float pixels_per_unit = JK_MIN(input.dimensions.x, input.dimensions.y) / 64.0f;
+            JkIntVec2 output_dimensions = bins->output_dimensions;
+            float pixels_per_unit = JK_MIN(output_dimensions.x, output_dimensions.y) / 64.0f;
             JkVec2 ui_dimensions =
-                    jk_vec2_mul(1.0f / pixels_per_unit, jk_vec2_from_i32(input.dimensions));
+                    jk_vec2_mul(1.0f / pixels_per_unit, jk_vec2_from_i32(output_dimensions));
             jk_shapes_renderer_init(
                     &renderer, pixels_per_unit, env->assets, shapes, scratch0.arena);
 
             float padding = 0.5f;
             float text_scale = 0.005f;
-            JkBuffer frame_id_text = JK_FORMAT(scratch0.arena, jkfu(frame_id));
+            JkBuffer frame_id_text = JK_FORMAT(scratch0.arena, jkfu(bins->frame_id));
             TextLayout layout = text_layout_monospace(env, frame_id_text, text_scale);
             JkVec2 top_left = {(ui_dimensions.x - padding) - layout.dimensions.x, padding};
             draw_text(&renderer,
@@ -2191,27 +2819,15 @@ void render(JkContext *context, Environment *env) {
                     text_scale,
                     text_color);
 
-            JkShapesDrawCommandArray draw_commands = jk_shapes_draw_commands_get(&renderer);
-            JkIntRect screen_rect = {.max = input.dimensions};
-            for (int64_t i = 0; i < draw_commands.count; i++) {
-                JkShapesDrawCommand *command = draw_commands.e + i;
-                JkIntRect rect = jk_int_rect_intersect(screen_rect, command->rect);
-                for (JkIntVec2 pos = rect.min; pos.y < rect.max.y; pos.y++) {
-                    for (pos.x = rect.min.x; pos.x < rect.max.x; pos.x++) {
-                        int32_t index = DRAW_BUFFER_SIDE_LENGTH * pos.y + pos.x;
-                        uint8_t alpha = 255;
-                        if (command->alpha_map) {
-                            JkIntVec2 pos_in_rect = jk_int_vec2_sub(pos, command->rect.min);
-                            int32_t width = (command->rect.max.x - command->rect.min.x);
-                            alpha = command->alpha_map[pos_in_rect.y * width + pos_in_rect.x];
-                        }
-                        env->draw_buffer[index] =
-                                blend_alpha(command->color, env->draw_buffer[index], alpha);
-                    }
-                }
+            JkShapesTiles tiles = jk_shapes_tiles_get(&renderer, output_dimensions);
+            for (int64_t i = 0; i < (int64_t)tiles.counts.x * tiles.counts.y; i++) {
+                jk_shapes_tile_composite(&tiles, i, env->draw_buffer, DRAW_BUFFER_SIDE_LENGTH);
             }
         }
 
+        bins_latest = build_slot;
+        pipelined = JK_FLAG_GET(env->flags, ENV_FLAG_PIPELINED);
+
         jk_arena_scope_end(scratch0);
         jk_arena_scope_end(scratch1);
     }
@@ -9,19 +9,41 @@
 #define FPS 60
 #define DELTA_TIME (1.0f / FPS)
 
-#define SAMPLE_COUNT 4
+#define SAMPLE_COUNT_DEFAULT 4
+#define SAMPLE_COUNT_MAX 8
 #define LANE_COUNT 8
 #define TILE_SIDE_LENGTH 64
+#define TILE_PIXEL_COUNT (TILE_SIDE_LENGTH * TILE_SIDE_LENGTH)
 
 #define TEXTURE_POW_2 8
 #define TEXTURE_SIDE_LENGTH (1 << TEXTURE_POW_2)
 #define TEXTURE_PIXEL_COUNT (TEXTURE_SIDE_LENGTH * TEXTURE_SIDE_LENGTH)
 #define TEXTURE_MASK (TEXTURE_SIDE_LENGTH - 1)
 
+// Texture data holds a mip chain, each level half the side length of the one before it, stored
+// back to back starting with the full-size level. Texels within a level are in Morton order.
+#define TEXTURE_MIP_COUNT 5
+#define TEXTURE_MIP_OFFSET(level) \
+    ((4 * TEXTURE_PIXEL_COUNT - ((4 * TEXTURE_PIXEL_COUNT) >> (2 * (level)))) / 3)
+
+// A texture can be smaller than TEXTURE_SIDE_LENGTH, down to the side length of the last mip
+// level. Its chain then has the same layout as the tail of a full-size one, starting at the level
+// with its side length, and stops at the same smallest level.
+#define TEXTURE_POW_2_MIN (TEXTURE_POW_2 - TEXTURE_MIP_COUNT + 1)
+#define TEXTURE_DATA_COUNT(pow_2) \
+    (TEXTURE_MIP_OFFSET(TEXTURE_MIP_COUNT) - TEXTURE_MIP_OFFSET(TEXTURE_POW_2 - (pow_2)))
+
+// Objects carry this many levels of detail. Each level past the first has about a quarter of the
+// faces of the one before it and indexes the same vertices.
+#define LOD_COUNT 3
+
 #define DRAW_BUFFER_SIDE_LENGTH 4096ll
 #define PIXEL_COUNT (DRAW_BUFFER_SIDE_LENGTH * DRAW_BUFFER_SIDE_LENGTH)
-#define DRAW_BUFFER_SIZE (SAMPLE_COUNT * PIXEL_COUNT * JK_SIZEOF(JkColor))
-#define Z_BUFFER_SIZE (SAMPLE_COUNT * PIXEL_COUNT * JK_SIZEOF(float))
+#define DRAW_BUFFER_SIZE (PIXEL_COUNT * JK_SIZEOF(JkColor))
+
+// Camera parameters graphics_scene_gen also needs to frame its scenes
+#define PLAYER_EYE_HEIGHT 1.4f
+#define FOV_RADIANS (JK_PI / 3)
 
 #define CLEAR_COLOR_R 0x00
 #define CLEAR_COLOR_G 0x00
@@ -34,6 +56,10 @@ typedef enum Flag {
 typedef enum EnvironmentFlag {
     ENV_FLAG_RUNNING,
     ENV_FLAG_DEBUG_DISPLAY,
+    ENV_FLAG_PIPELINED, // Bin the next frame while rasterizing this one, at a frame of latency
+    ENV_FLAG_DYNAMIC_RESOLUTION, // Trade resolution and MSAA samples for frame time
+    ENV_FLAG_VISIBILITY_BUFFER, // Resolve visibility for a whole tile before shading anything
+    ENV_FLAG_EIGHT_LANES, // Rasterize 8 pixels at a time even where the CPU has wider vectors
 } EnvironmentFlag;
 
 typedef struct Face {
@@ -46,10 +72,18 @@ typedef struct FaceArray {
     Face *e;
 } FaceArray;
 
+typedef enum TextureFlag {
+    // Channels 0 to 2 hold one shape as a multi-channel SDF, read back by taking their median.
+    // Corners stay sharp where a single channel would round them off.
+    TEXTURE_FLAG_MSDF,
+} TextureFlag;
+
 typedef struct Texture {
+    uint32_t flags;
+    int32_t pow_2; // The full-size level has a side length of 1 << pow_2
     JkColor bg;
     JkColor colors[4];
-    JkColor data[TEXTURE_PIXEL_COUNT];
+    JkSpan data; // JkColor mip chain, offset from the Texture itself so it can be sampled alone
 } Texture;
 
 typedef struct TextureArray {
@@ -73,7 +107,10 @@ typedef struct Object {
     ObjectId parent;
     JkTransform transform;
     JkSpan vertices; // JkVec3Array
-    JkSpan faces; // FaceArray
+    JkSpan faces; // FaceArray, full detail. Collision and navigation always use these.
+    JkSpan lods[LOD_COUNT - 1]; // FaceArray per reduced level of detail
+    JkVec3 bounds_center; // Local space bounding sphere, used to pick a level of detail
+    float bounds_radius;
     int32_t texture_id;
     float repeat_size;
 } Object;
@@ -159,8 +196,10 @@ typedef struct Environment {
     Assets *assets;
     int64_t (*estimate_cpu_frequency)(int64_t);
     JkColor *draw_buffer; // DRAW_BUFFER_SIZE
-    float *z_buffer; // Z_BUFFER_SIZE
+    int32_t sample_count; // MSAA samples per pixel: 1, 2, 4 or 8. Other values use the default.
     JkArena record_arena;
+    JkArena nav_arenas[2]; // Navigation caches, rebuilt in place as the player moves
+    JkArena bin_arenas[2]; // Binned triangles, one per frame in flight
 
     // Negative means we're recording to the clip, positive means we're playing it back, zero means
     // there's no active clip
@@ -178,4 +217,9 @@ typedef struct Environment {
 typedef void RenderFunction(JkContext *context, Environment *env);
 RenderFunction render;
 
+// Shared with the tools that build textures offline
+int32_t texture_morton_index(int32_t x, int32_t y);
+JkColor *texture_data_get(Texture *tex);
+void texture_mips_generate(JkColor *data, int32_t pow_2);
+
 #endif
@@ -9,9 +9,6 @@
 #include <jk_src/stb/stb_truetype.h>
 // #jk_build dependencies_end
 
-#define SVG_SIDE_LENGTH 64
-#define SDF_SUBPIXEL_PRECISION (1 / 64.0f)
-
 static JkBuffer file_path = JKSI("../jk_assets/pikuma/graphics/terrain.fbx");
 static JkCoordinateSystem coordinate_system = {JK_LEFT, JK_BACKWARD, JK_UP};
 
@@ -49,6 +46,9 @@ struct Thing {
     JkVec3 transform[TRANSFORM_TYPE_COUNT];
 
     JkSpan faces;
+    JkSpan lods[LOD_COUNT - 1];
+    JkVec3 bounds_center;
+    float bounds_radius;
     int32_t texture_id;
 
     int64_t vertices_base;
@@ -162,6 +162,7 @@ typedef struct Context {
     JkArena *result_arena;
     JkArena *verts_arena;
     JkArena *texcoords_arena;
+    JkArena *texels_arena;
     JkArena *scratch_arena;
     int64_t texture_count;
 } Context;
@@ -172,462 +173,85 @@ static JkBuffer fbx_prop_string_read(uint8_t *base, int64_t *cursor) {
     return (JkBuffer){.size = string->length, .data = string->data};
 }
 
-// ---- SVG begin --------------------------------------------------------------
-
-static b32 is_numeric(int c) {
-    return isdigit(c) || c == '.' || c == '-';
-}
-
-static JkFloatArray svg_parse_numbers(JkArena *arena, JkBuffer shape_string, int64_t *pos) {
-    JkFloatArray result = {.e = jk_arena_pointer_current(arena)};
-    int c;
-    while ((c = jk_buffer_character_get(shape_string, *pos)) != EOF
-            && (is_numeric(c) || jk_is_space(c) || c == ',')) {
-        if (is_numeric(c)) {
-            int64_t start = *pos;
-            while (is_numeric(jk_buffer_character_get(shape_string, *pos))) {
-                (*pos)++;
-            }
-            JkBuffer number_string = {
-                .size = *pos - start,
-                .data = shape_string.data + start,
-            };
-            float *new_number = jk_arena_push(arena, JK_SIZEOF(*new_number));
-            *new_number = (float)jk_parse_double(number_string);
-        } else {
-            (*pos)++;
-        }
-    }
-    result.count = (float *)jk_arena_pointer_current(arena) - result.e;
-    return result;
-}
-
-JkBuffer read_string(JkBuffer buffer, int64_t *cursor, int32_t delim) {
-    int64_t start = *cursor;
-    int c;
-    do {
-        c = jk_buffer_character_next(buffer, cursor);
-    } while (!(c == delim || c == JK_OOB));
-    return c == delim ? (JkBuffer){.data = buffer.data + start, .size = *cursor - start - 1}
-                      : (JkBuffer){0};
-}
-
-b32 is_xml_tag_name_character(int32_t c) {
-    c = jk_char_to_lower(c);
-    return ('a' <= c && c <= 'z') || jk_char_is_digit(c) || c == '-' || c == '_' || c == ':'
-            || c == '.';
-}
-
-b32 is_css_attribute_name_character(int32_t c) {
-    c = jk_char_to_lower(c);
-    return ('a' <= c && c <= 'z') || jk_char_is_digit(c) || c == '-' || c == '_';
-}
-
-uint8_t read_hex_byte(JkBuffer buffer, int64_t *cursor) {
-    uint8_t result = 0;
-    for (int64_t i = 0; i < 2; i++) {
-        result <<= 4;
-        int32_t c = jk_char_to_lower(jk_buffer_character_next(buffer, cursor));
-        if (!jk_char_is_hex_digit(c)) {
-            return 0;
-        }
-        result |= jk_char_hex_value(c);
-    }
-    return result;
-}
-
-b32 svg_iterate_attributes(JkBuffer svg, int64_t *cursor, JkBuffer *key, JkBuffer *value) {
-    // Key
-    jk_buffer_skip_whitespace(svg, cursor);
-    int64_t start = *cursor;
-    int32_t c;
-    while ((c = jk_buffer_character_get(svg, *cursor)) != '=' && !jk_is_space(c) && c != '"'
-            && c != '\'' && c != JK_OOB) {
-        *cursor += 1;
-    }
-    *key = (JkBuffer){.data = svg.data + start, .size = *cursor - start};
-
-    // =
-    jk_buffer_skip_whitespace(svg, cursor);
-    if (jk_buffer_character_get(svg, *cursor) != '=') {
-        return 0;
-    }
-    *cursor += 1;
-
-    // Value
-    jk_buffer_skip_whitespace(svg, cursor);
-    int32_t delim = jk_buffer_character_next(svg, cursor);
-    if (delim != '"' && delim != '\'') {
-        return 0;
-    }
-    *value = read_string(svg, cursor, delim);
-
-    return 1;
-}
-
-int64_t generate_sdf_texture(Context *context, JkBuffer name) {
-    JkArena *arena = context->result_arena;
-
-    Texture *tex = jk_arena_push(arena, JK_SIZEOF(*tex));
-
-    JkBuffer shape_strings[4] = {0};
-    JkShape shapes[4] = {0};
-
-    JkArenaScope scratch = jk_arena_scratch_begin_not(arena);
-
-    b32 error = 0;
-    double page_opacity = -1;
+#include "svg_texture.c"
 
-    // Parse SVG data
-    JK_ARENA_SCOPE(arena) {
-        JkBuffer svg = jk_platform_file_read(arena,
-                JK_FORMAT(arena, jkfn("../jk_assets/pikuma/graphics/"), jkfs(name), jkfn(".svg")));
-        if (svg.size == 0) {
-            error = 1;
-        }
-        int64_t cursor = 0;
-        while (cursor < svg.size) {
-            int first = jk_buffer_character_next(svg, &cursor);
-            switch (first) {
-            case '"':
-            case '\'': {
-                read_string(svg, &cursor, first);
-            } break;
-
-            case '<': {
-                jk_buffer_skip_whitespace(svg, &cursor);
-                int64_t tag_start = cursor;
-                while (is_xml_tag_name_character(jk_buffer_character_get(svg, cursor))) {
-                    cursor++;
-                }
-                JkBuffer tag = {.data = svg.data + tag_start, .size = cursor - tag_start};
-                if (jk_string_equal(tag, JKS("path"))) {
-                    int64_t id = -1;
-                    JkBuffer shape_string = {0};
-                    JkColor color = {.a = 0xff};
-
-                    cursor += 4;
-                    JkBuffer key;
-                    JkBuffer value;
-                    while (svg_iterate_attributes(svg, &cursor, &key, &value)) {
-                        if (jk_string_equal(key, JKS("d"))) {
-                            shape_string = value;
-                        } else if (jk_string_equal(key, JKS("id"))) {
-                            if (value.size == 1) {
-                                int64_t num = value.data[0] - '0';
-                                if (0 <= num && num < 4) {
-                                    id = num;
-                                }
-                            }
-                        } else if (jk_string_equal(key, JKS("style"))) {
-                            int64_t style_cursor = 0;
-                            while (style_cursor < value.size) {
-                                while (!is_css_attribute_name_character(
-                                               jk_buffer_character_get(value, style_cursor))
-                                        && style_cursor < value.size) {
-                                    style_cursor++;
-                                }
-                                int64_t start = style_cursor;
-                                while (is_css_attribute_name_character(
-                                        jk_buffer_character_get(value, style_cursor))) {
-                                    style_cursor++;
-                                }
-                                JkBuffer attribute_name = {
-                                    .data = value.data + start, .size = style_cursor - start};
-
-                                jk_buffer_skip_whitespace(value, &style_cursor);
-                                if (jk_buffer_character_get(value, style_cursor) != ':') {
-                                    continue;
-                                }
-                                style_cursor++;
-                                jk_buffer_skip_whitespace(value, &style_cursor);
-
-                                if (jk_string_equal(attribute_name, JKS("fill"))) {
-                                    if (jk_buffer_character_get(value, style_cursor) != '#') {
-                                        continue;
-                                    }
-                                    style_cursor++;
-                                    color.r = read_hex_byte(value, &style_cursor);
-                                    color.g = read_hex_byte(value, &style_cursor);
-                                    color.b = read_hex_byte(value, &style_cursor);
-                                } else if (jk_string_equal(attribute_name, JKS("fill-opacity"))) {
-                                    jk_buffer_skip_whitespace(value, &style_cursor);
-                                    int64_t alpha_start = style_cursor;
-                                    while (jk_char_is_digit(
-                                                   jk_buffer_character_get(value, style_cursor))
-                                            || jk_buffer_character_get(value, style_cursor)
-                                                    == '.') {
-                                        style_cursor++;
-                                    }
-                                    JkBuffer number = {
-                                        .data = value.data + alpha_start,
-                                        .size = style_cursor - alpha_start,
-                                    };
-                                    float alpha = jk_parse_double(number);
-                                    color.a = (uint8_t)JK_CLAMP(255 * alpha, 0, 255);
-                                }
-                            }
-                        }
-                    }
-
-                    if (id != -1) {
-                        shape_strings[id] = shape_string;
-                        tex->colors[id] = color;
-                    }
-                } else if (jk_string_equal(tag, JKS("sodipodi:namedview"))) {
-                    JkBuffer key;
-                    JkBuffer value;
-                    while (svg_iterate_attributes(svg, &cursor, &key, &value)) {
-                        if (jk_string_equal(key, JKS("pagecolor"))) {
-                            int64_t value_cursor = 0;
-                            jk_buffer_skip_whitespace(value, &value_cursor);
-                            if (jk_buffer_character_get(value, value_cursor) == '#') {
-                                value_cursor++;
-                                tex->bg.r = read_hex_byte(value, &value_cursor);
-                                tex->bg.g = read_hex_byte(value, &value_cursor);
-                                tex->bg.b = read_hex_byte(value, &value_cursor);
-                                tex->bg.a = 0xff;
-                            }
-                        } else if (jk_string_equal(key, JKS("inkscape:pageopacity"))) {
-                            page_opacity = jk_parse_double(value);
-                        }
-                    }
-                }
-            } break;
-            }
-        }
-
-        if (page_opacity != -1) {
-            tex->bg.a = (uint8_t)JK_CLAMP(255 * page_opacity, 0, 255);
-        }
-
-        // Parse the path data
-        for (int32_t shape_index = 0; shape_index < 4; shape_index++) {
-            JkBuffer piece_string = shape_strings[shape_index];
-            JkShape *shape = shapes + shape_index;
-
-            shape->dimensions.x = 64.0f;
-            shape->dimensions.y = 64.0f;
-            shape->commands.offset = scratch.arena->pos;
-
-            JkVec2 prev_pos = {0};
-
-            JkVec2 first_pos = {0};
-            int64_t pos = 0;
-            int c;
-            while ((c = jk_buffer_token_character_next(piece_string, &pos)) != EOF) {
-                JkArenaScope command_scope = jk_arena_scope_begin(arena);
-
-                switch (c) {
-                case 'M':
-                case 'L': {
-                    JkFloatArray numbers = svg_parse_numbers(arena, piece_string, &pos);
-                    JK_ASSERT(numbers.count && numbers.count % 2 == 0);
-                    for (int64_t i = 0; i < numbers.count; i += 2) {
-                        JkShapesPenCommand *new_command =
-                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
-                        new_command->type =
-                                c == 'M' ? JK_SHAPES_PEN_COMMAND_MOVE : JK_SHAPES_PEN_COMMAND_LINE;
-                        new_command->v[0] = (JkVec2){numbers.e[i], numbers.e[i + 1]};
-                        prev_pos = new_command->v[0];
-
-                        if (c == 'M') {
-                            first_pos = new_command->v[0];
-                        }
-                    }
-                } break;
-
-                case 'H':
-                case 'V': {
-                    JkFloatArray numbers = svg_parse_numbers(arena, piece_string, &pos);
-                    JK_ASSERT(numbers.count);
-                    for (int64_t i = 0; i < numbers.count; i++) {
-                        JkShapesPenCommand *new_command =
-                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
-                        new_command->type = JK_SHAPES_PEN_COMMAND_LINE;
-                        new_command->v[0] = c == 'H' ? (JkVec2){numbers.e[i], prev_pos.y}
-                                                     : (JkVec2){prev_pos.x, numbers.e[i]};
-                        prev_pos = new_command->v[0];
-                    }
-                } break;
-
-                case 'Q': {
-                    JkFloatArray numbers = svg_parse_numbers(arena, piece_string, &pos);
-                    JK_ASSERT(numbers.count && numbers.count % 4 == 0);
-                    for (int64_t i = 0; i < numbers.count; i += 4) {
-                        JkShapesPenCommand *new_command =
-                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
-                        new_command->type = JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC;
-                        for (int32_t j = 0; j < 2; j++) {
-                            new_command->v[j] =
-                                    (JkVec2){numbers.e[i + (j * 2)], numbers.e[i + (j * 2) + 1]};
-                        }
-                        prev_pos = new_command->v[1];
-                    }
-                } break;
-
-                case 'C': {
-                    JkFloatArray numbers = svg_parse_numbers(arena, piece_string, &pos);
-                    JK_ASSERT(numbers.count && numbers.count % 6 == 0);
-                    for (int64_t i = 0; i < numbers.count; i += 6) {
-                        JkShapesPenCommand *new_command =
-                                jk_arena_push(scratch.arena, JK_SIZEOF(*new_command));
-                        new_command->type = JK_SHAPES_PEN_COMMAND_CURVE_CUBIC;
-                        for (int32_t j = 0; j < 3; j++) {
-                            new_command->v[j] =
-                                    (JkVec2){numbers.e[i + (j * 2)], numbers.e[i + (j * 2) + 1]};
-                        }
-                        prev_pos = new_command->v[2];
-                    }
-                } break;
-
-                case 'A': {
-                    JkFloatArray numbers = svg_parse_numbers(arena, piece_string, &pos);
-                    JK_ASSERT(numbers.count && numbers.count % 7 == 0);
-                    for (int64_t i = 0; i < numbers.count; i += 7) {
-                        JkShapesPenCommand *new_command =
-                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
-                        new_command->type = JK_SHAPES_PEN_COMMAND_ARC;
-                        new_command->arc.dimensions.x = numbers.e[i];
-                        new_command->arc.dimensions.y = numbers.e[i + 1];
-                        new_command->arc.rotation = numbers.e[i + 2] * (float)JK_PI / 180.0f;
-                        if (numbers.e[i + 3]) {
-                            new_command->arc.flags |= JK_SHAPES_ARC_FLAG_LARGE;
-                        }
-                        if (numbers.e[i + 4]) {
-                            new_command->arc.flags |= JK_SHAPES_ARC_FLAG_SWEEP;
-                        }
-                        new_command->arc.point_end.x = numbers.e[i + 5];
-                        new_command->arc.point_end.y = numbers.e[i + 6];
-                        prev_pos = new_command->arc.point_end;
-                    }
-                } break;
-
-                case 'z':
-                case 'Z': {
-                    JkShapesPenCommand *new_command =
-                            jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
-                    new_command->type = JK_SHAPES_PEN_COMMAND_LINE;
-                    new_command->v[0] = first_pos;
-                } break;
-
-                default: {
-                    JK_ASSERT(0 && "Unknown SVG shape command character");
-                } break;
-                }
-
-                jk_arena_scope_end(command_scope);
-            }
-
-            shape->commands.size = scratch.arena->pos - shape->commands.offset;
-        }
-    }
-
-    float pixels_per_unit = (float)TEXTURE_SIDE_LENGTH / SVG_SIDE_LENGTH;
-    for (int64_t shape_index = 0; shape_index < 4; shape_index++) {
-        JkArenaScope shape_scope = jk_arena_scope_begin(scratch.arena);
-
-        JkShape *shape = shapes + shape_index;
-
-        JkShapesPenCommandArray commands;
-        commands.count = shape->commands.size / JK_SIZEOF(commands.e[0]);
-        commands.e = (JkShapesPenCommand *)(scratch.arena->memory.data + shape->commands.offset);
-        JkEdgeArray edges = jk_shapes_edges_get(
-                scratch.arena, commands, (JkVec2){0}, pixels_per_unit, SDF_SUBPIXEL_PRECISION, 0);
-
-        float *fill_right = jk_arena_push(scratch.arena, TEXTURE_SIDE_LENGTH * sizeof(*fill_right));
-        for (JkIntVec2 pos = {0}; pos.y < TEXTURE_SIDE_LENGTH; pos.y++) {
-            jk_memset(fill_right, 0, TEXTURE_SIDE_LENGTH * sizeof(*fill_right));
-            float sample_y = pos.y + 0.5f;
-
-            for (int64_t edge_index = 0; edge_index < edges.count; edge_index++) {
-                JkEdge *edge = edges.e + edge_index;
-                if (edge->segment.p0.y == edge->segment.p1.y) {
-                    continue;
-                }
-
-                if (!(edge->segment.p0.y <= sample_y && sample_y < edge->segment.p1.y)) {
-                    continue;
-                }
-
-                float scanline_intersect_x = jk_segment_y_intersection(edge->segment, sample_y);
-                float leftmost_sample_x = jk_ceil_f32(scanline_intersect_x - 0.5f);
-                if (0 <= leftmost_sample_x && leftmost_sample_x < TEXTURE_SIDE_LENGTH) {
-                    fill_right[(int32_t)leftmost_sample_x] += edge->direction;
-                }
-            }
-
-            float winding = 0;
-            for (pos.x = 0; pos.x < TEXTURE_SIDE_LENGTH; pos.x++) {
-                winding += fill_right[pos.x];
-                float sign = winding == 0 ? 1 : -1;
-
-                JkVec2 posf = jk_vec2_add(jk_vec2_from_i32(pos), (JkVec2){0.5f, 0.5f});
-                float distance_sqr = jk_infinity_f32.f32;
-                for (int64_t i = 0; i < edges.count; i++) {
-                    float candidate = jk_distance_to_segment_2d(posf, edges.e[i].segment);
-                    if (candidate < distance_sqr) {
-                        distance_sqr = candidate;
-                    }
-                }
-
-                float value = 127.5f;
-                if ((SDF_SUBPIXEL_PRECISION * SDF_SUBPIXEL_PRECISION) < distance_sqr) {
-                    float signed_distance = sign * jk_sqrt_f32(distance_sqr);
-                    value = jk_remap_clamped_f32(signed_distance, SDF_SPREAD, -SDF_SPREAD, 0, 255);
-                }
-                int32_t tex_y = TEXTURE_SIDE_LENGTH - pos.y - 1;
-                tex->data[TEXTURE_SIDE_LENGTH * tex_y + pos.x].v[shape_index] = (uint8_t)value;
-            }
-        }
-
-        jk_arena_scope_end(shape_scope);
-    }
-
-    jk_arena_scope_end(scratch);
+// SVGs packed as an MSDF of their only shape, which keeps its corners sharp at a fraction of the
+// side length a plain SDF would need. Every other SVG packs as a plain SDF of up to four shapes at
+// full size.
+static struct {
+    char *name;
+    int32_t pow_2;
+} msdf_textures[] = {
+    {"rock", TEXTURE_POW_2 - 2},
+};
 
+static void texture_bitmap_write(JkBuffer name, Texture *tex, JkColor *data) {
+    int32_t side_length = 1 << tex->pow_2;
     JK_ARENA_SCRATCH(file_arena) {
-        // Write sdf to a bitmap file
-        JkBuffer bitmap_buffer = jk_arena_push_buffer(
-                file_arena.arena, sizeof(JkBitmapHeader) + sizeof(JkColor) * TEXTURE_PIXEL_COUNT);
+        JkBuffer bitmap_buffer = jk_arena_push_buffer(file_arena.arena,
+                sizeof(JkBitmapHeader) + sizeof(JkColor) * side_length * side_length);
         JkBitmapHeader *bitmap = (JkBitmapHeader *)bitmap_buffer.data;
         jk_memset(bitmap, 0, sizeof(*bitmap));
         bitmap->identifier = 0x4d42;
         bitmap->size = bitmap_buffer.size;
         bitmap->data_offset = sizeof(JkBitmapHeader);
         bitmap->dib_header_size = 108;
-        bitmap->width = TEXTURE_SIDE_LENGTH;
-        bitmap->height = TEXTURE_SIDE_LENGTH;
+        bitmap->width = side_length;
+        bitmap->height = side_length;
         bitmap->color_plane_count = 1;
         bitmap->bits_per_pixel = 32;
         bitmap->compression_method = 3;
-        bitmap->data_size = sizeof(JkColor) * TEXTURE_PIXEL_COUNT;
+        bitmap->data_size = sizeof(JkColor) * side_length * side_length;
         bitmap->masks[0] = 0x00ff0000;
         bitmap->masks[1] = 0x0000ff00;
         bitmap->masks[2] = 0x000000ff;
         bitmap->masks[3] = 0xff000000;
         bitmap->color_space_type = 0x73524742; // 'sRGB' (LCS_sRGB)
         JkColor *bitmap_data = (JkColor *)(bitmap_buffer.data + bitmap->data_offset);
-        for (JkIntVec2 pos = {0}; pos.y < TEXTURE_SIDE_LENGTH; pos.y++) {
-            for (pos.x = 0; pos.x < TEXTURE_SIDE_LENGTH; pos.x++) {
-                int32_t index = TEXTURE_SIDE_LENGTH * pos.y + pos.x;
-                bitmap_data[index] = tex->data[index];
+        for (JkIntVec2 pos = {0}; pos.y < side_length; pos.y++) {
+            for (pos.x = 0; pos.x < side_length; pos.x++) {
+                bitmap_data[side_length * pos.y + pos.x] =
+                        data[texture_morton_index(pos.x, pos.y)];
             }
         }
         jk_platform_file_write(
                 JK_FORMAT(file_arena.arena, jkfs(name), jkfn(".bmp")), bitmap_buffer);
     }
+}
+
+// Packs the SVG with the given name into the next texture and writes its full-size level to
+// <name>.bmp for debugging. Returns the texture's index, or 0 if it couldn't be packed.
+int64_t generate_sdf_texture(Context *context, JkBuffer name) {
+    int32_t pow_2 = TEXTURE_POW_2;
+    b32 msdf = 0;
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(msdf_textures); i++) {
+        if (jk_string_equal(name, jk_buffer_from_null_terminated(msdf_textures[i].name))) {
+            pow_2 = msdf_textures[i].pow_2;
+            msdf = 1;
+        }
+    }
 
-    if (error) {
-        jk_arena_pop(arena, JK_SIZEOF(*tex));
-        return 0;
+    JkArenaScope scratch = jk_arena_scratch_begin_not(context->result_arena);
+    JkBuffer svg = jk_platform_file_read(scratch.arena,
+            JK_FORMAT(scratch.arena,
+                    jkfn("../jk_assets/pikuma/graphics/"),
+                    jkfs(name),
+                    jkfn(".svg")));
+    Texture *tex = jk_arena_push(context->result_arena, JK_SIZEOF(*tex));
+    JkArenaScope texels_scope = jk_arena_scope_begin(context->texels_arena);
+    int64_t result = 0;
+    if (texture_from_svg(tex, context->texels_arena, svg, pow_2, msdf)) {
+        texture_bitmap_write(
+                name, tex, (JkColor *)(context->texels_arena->memory.data + tex->data.offset));
+        result = context->texture_count++;
     } else {
-        return context->texture_count++;
+        jk_arena_pop(context->result_arena, JK_SIZEOF(*tex));
+        jk_arena_scope_end(texels_scope);
     }
+    jk_arena_scope_end(scratch);
+    return result;
 }
 
-// ---- SVG end ----------------------------------------------------------------
-
 static int32_t texture_get(Context *c, JkBuffer image_file_name) {
     JkBuffer name = jk_path_stem(image_file_name);
     JkHashTableKey hash = jk_buffer_hash(name);
@@ -896,6 +520,391 @@ static void process_fbx_nodes(Context *c, JkBuffer file, int64_t pos, Thing *thi
     }
 }
 
+// ---- Mesh simplification begin ----------------------------------------------
+
+// Fewest faces a level of detail is allowed to go down to
+#define LOD_FACE_COUNT_MIN 8
+
+// A collapse is rejected if it turns any surviving face further than this from its original normal
+#define LOD_NORMAL_DOT_MIN 0.5f
+
+// Edges between faces whose normals have a dot product below this are treated as creases
+#define LOD_CREASE_DOT_MAX 0.0f
+
+// Largest root mean square distance a collapse may put between the surface and the planes it
+// replaces, relative to the mesh's bounding radius, at the first reduced level. Each further
+// level doubles it.
+#define LOD_ERROR_RELATIVE 0.02f
+
+// Upper triangle of the symmetric 4x4 matrix that sums squared distances to a set of planes
+typedef struct Quadric {
+    double e[10];
+} Quadric;
+
+typedef struct Collapse {
+    double cost;
+    int32_t from;
+    int32_t to;
+} Collapse;
+
+// For each vertex, the indexes of the faces that use it
+typedef struct Incidence {
+    int32_t *offsets; // vertex_count + 1 entries
+    int32_t *faces;
+} Incidence;
+
+static void quadric_add_plane(Quadric *q, JkVec3 n, double d, double weight) {
+    double p[4] = {n.x, n.y, n.z, d};
+    int64_t k = 0;
+    for (int64_t i = 0; i < 4; i++) {
+        for (int64_t j = i; j < 4; j++) {
+            q->e[k++] += weight * p[i] * p[j];
+        }
+    }
+}
+
+static void quadric_add(Quadric *dest, Quadric *src) {
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(dest->e); i++) {
+        dest->e[i] += src->e[i];
+    }
+}
+
+// Mean squared distance from v to the planes of both quadrics, weighted by area. Plane normals are
+// unit length, so the diagonal terms of the normal part sum to the total weight.
+static double quadric_error(Quadric *a, Quadric *b, JkVec3 v) {
+    double p[4] = {v.x, v.y, v.z, 1};
+    double error = 0;
+    int64_t k = 0;
+    for (int64_t i = 0; i < 4; i++) {
+        for (int64_t j = i; j < 4; j++) {
+            double e = a->e[k] + b->e[k];
+            error += (i == j ? 1 : 2) * e * p[i] * p[j];
+            k++;
+        }
+    }
+    double weight = a->e[0] + a->e[4] + a->e[7] + b->e[0] + b->e[4] + b->e[7];
+    return 0 < weight ? error / weight : 0;
+}
+
+static int32_t collapse_compare(void *data, void *a_ptr, void *b_ptr) {
+    double a = ((Collapse *)a_ptr)->cost;
+    double b = ((Collapse *)b_ptr)->cost;
+    return a < b ? -1 : (b < a) ? 1 : 0;
+}
+
+static Incidence incidence_build(JkArena *arena, int64_t vertex_count, FaceArray faces) {
+    Incidence result;
+    result.offsets = jk_arena_push_zero(arena, (vertex_count + 1) * JK_SIZEOF(*result.offsets));
+    result.faces = jk_arena_push(arena, 3 * faces.count * JK_SIZEOF(*result.faces));
+    for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+        for (int64_t i = 0; i < 3; i++) {
+            result.offsets[faces.e[face_index].v[i] + 1]++;
+        }
+    }
+    for (int64_t i = 0; i < vertex_count; i++) {
+        result.offsets[i + 1] += result.offsets[i];
+    }
+    int32_t *cursors = jk_arena_push(arena, vertex_count * JK_SIZEOF(*cursors));
+    jk_memcpy(cursors, result.offsets, vertex_count * JK_SIZEOF(*cursors));
+    for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+        for (int64_t i = 0; i < 3; i++) {
+            result.faces[cursors[faces.e[face_index].v[i]]++] = (int32_t)face_index;
+        }
+    }
+    return result;
+}
+
+static b32 face_has_vertex(Face *face, int32_t v) {
+    return face->v[0] == v || face->v[1] == v || face->v[2] == v;
+}
+
+static JkVec3 face_cross(JkVec3 *vertices, Face *face) {
+    JkVec3 a = vertices[face->v[0]];
+    return jk_vec3_cross(
+            jk_vec3_sub(vertices[face->v[1]], a), jk_vec3_sub(vertices[face->v[2]], a));
+}
+
+// Collapsing an edge is only safe if its endpoints share exactly the two neighbors opposite the
+// edge. More than that would pinch the surface into a non-manifold fold.
+static b32 collapse_topology_valid(Incidence *incidence, FaceArray faces, Collapse collapse) {
+    int32_t shared[3];
+    int64_t shared_count = 0;
+    for (int32_t i = incidence->offsets[collapse.from]; i < incidence->offsets[collapse.from + 1];
+            i++) {
+        Face *face = faces.e + incidence->faces[i];
+        for (int64_t corner = 0; corner < 3; corner++) {
+            int32_t v = face->v[corner];
+            if (v == collapse.from || v == collapse.to) {
+                continue;
+            }
+            b32 seen = 0;
+            for (int64_t j = 0; j < shared_count; j++) {
+                seen |= shared[j] == v;
+            }
+            if (seen) {
+                continue;
+            }
+            for (int32_t k = incidence->offsets[collapse.to];
+                    k < incidence->offsets[collapse.to + 1];
+                    k++) {
+                if (face_has_vertex(faces.e + incidence->faces[k], v)) {
+                    if (shared_count == JK_ARRAY_COUNT(shared)) {
+                        return 0;
+                    }
+                    shared[shared_count++] = v;
+                    break;
+                }
+            }
+        }
+    }
+    return shared_count == 2;
+}
+
+static b32 collapse_geometry_valid(
+        JkVec3 *vertices, Incidence *incidence, FaceArray faces, Collapse collapse) {
+    for (int32_t i = incidence->offsets[collapse.from]; i < incidence->offsets[collapse.from + 1];
+            i++) {
+        Face face = faces.e[incidence->faces[i]];
+        if (face_has_vertex(&face, collapse.to)) {
+            continue;
+        }
+        JkVec3 before = face_cross(vertices, &face);
+        for (int64_t corner = 0; corner < 3; corner++) {
+            if (face.v[corner] == collapse.from) {
+                face.v[corner] = collapse.to;
+            }
+        }
+        JkVec3 after = face_cross(vertices, &face);
+        float magnitudes = jk_vec3_magnitude(before) * jk_vec3_magnitude(after);
+        if (magnitudes <= 0
+                || jk_vec3_dot(before, after) < LOD_NORMAL_DOT_MIN * magnitudes) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Moves collapse.from onto collapse.to, deleting the two faces that shared the edge. Deleted faces
+// get a negative first vertex index and are compacted away by the caller.
+static void collapse_apply(
+        Incidence *incidence, FaceArray faces, Quadric *quadrics, b32 *locked, Collapse collapse) {
+    // Surviving corners at the old vertex take the texcoords the new vertex had in the deleted
+    // faces, matched on which side of any texcoord seam they were on
+    int32_t texcoords_from[2] = {-1, -1};
+    int32_t texcoords_to[2] = {-1, -1};
+    int64_t removed_count = 0;
+    for (int32_t i = incidence->offsets[collapse.from]; i < incidence->offsets[collapse.from + 1];
+            i++) {
+        Face *face = faces.e + incidence->faces[i];
+        if (face_has_vertex(face, collapse.to) && removed_count < 2) {
+            for (int64_t corner = 0; corner < 3; corner++) {
+                if (face->v[corner] == collapse.from) {
+                    texcoords_from[removed_count] = face->t[corner];
+                } else if (face->v[corner] == collapse.to) {
+                    texcoords_to[removed_count] = face->t[corner];
+                }
+            }
+            removed_count++;
+        }
+    }
+
+    for (int32_t i = incidence->offsets[collapse.from]; i < incidence->offsets[collapse.from + 1];
+            i++) {
+        Face *face = faces.e + incidence->faces[i];
+        for (int64_t corner = 0; corner < 3; corner++) {
+            locked[face->v[corner]] = 1;
+        }
+        if (face_has_vertex(face, collapse.to)) {
+            face->v[0] = -1;
+        } else {
+            for (int64_t corner = 0; corner < 3; corner++) {
+                if (face->v[corner] == collapse.from) {
+                    face->v[corner] = collapse.to;
+                    face->t[corner] = face->t[corner] == texcoords_from[1] ? texcoords_to[1]
+                                                                             : texcoords_to[0];
+                }
+            }
+        }
+    }
+
+    quadric_add(quadrics + collapse.to, quadrics + collapse.from);
+}
+
+// Reduces faces in place to about target_count by greedily collapsing the edges with the least
+// quadric error, skipping any that cost more than max_error. Vertices on an open boundary never
+// move, so neighboring meshes stay sealed to each other at any level. Returns the new face count.
+static int64_t mesh_simplify(JkArena *arena,
+        JkVec3 *vertices,
+        int64_t vertex_count,
+        Quadric *quadrics,
+        b32 *boundary,
+        FaceArray faces,
+        int64_t target_count,
+        double max_error) {
+    JK_ARENA_SCOPE(arena) {
+        Collapse *collapses = jk_arena_push(arena, 3 * faces.count * JK_SIZEOF(*collapses));
+        b32 *locked = jk_arena_push(arena, vertex_count * JK_SIZEOF(*locked));
+
+        // Each pass collapses a set of edges that don't touch each other's faces, so the
+        // incidence lists only need rebuilding between passes
+        b32 progress = 1;
+        while (target_count < faces.count && progress) {
+            JkArenaScope pass_scope = jk_arena_scope_begin(arena);
+            Incidence incidence = incidence_build(arena, vertex_count, faces);
+
+            int64_t collapse_count = 0;
+            for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+                Face *face = faces.e + face_index;
+                for (int64_t i = 0; i < 3; i++) {
+                    Collapse collapse = {.from = face->v[i], .to = face->v[(i + 1) % 3]};
+                    if (!boundary[collapse.from]) {
+                        collapse.cost = quadric_error(quadrics + collapse.from,
+                                quadrics + collapse.to,
+                                vertices[collapse.to]);
+                        if (collapse.cost <= max_error) {
+                            collapses[collapse_count++] = collapse;
+                        }
+                    }
+                }
+            }
+            Collapse tmp;
+            jk_quicksort(collapses, collapse_count, JK_SIZEOF(tmp), &tmp, 0, collapse_compare);
+
+            jk_memset(locked, 0, vertex_count * JK_SIZEOF(*locked));
+            int64_t remaining_count = faces.count;
+            progress = 0;
+            for (int64_t i = 0; i < collapse_count && target_count < remaining_count; i++) {
+                Collapse collapse = collapses[i];
+                if (locked[collapse.from] || locked[collapse.to]
+                        || !collapse_topology_valid(&incidence, faces, collapse)
+                        || !collapse_geometry_valid(vertices, &incidence, faces, collapse)) {
+                    continue;
+                }
+                collapse_apply(&incidence, faces, quadrics, locked, collapse);
+                remaining_count -= 2;
+                progress = 1;
+            }
+
+            int64_t kept_count = 0;
+            for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+                if (0 <= faces.e[face_index].v[0]) {
+                    faces.e[kept_count++] = faces.e[face_index];
+                }
+            }
+            faces.count = kept_count;
+
+            jk_arena_scope_end(pass_scope);
+        }
+    }
+    return faces.count;
+}
+
+// Finds the thing's bounds and appends LOD_COUNT - 1 successively simpler copies of its faces to
+// the arena
+static void lods_generate(
+        JkArena *arena, JkArena *scratch_arena, JkVec3 *vertices, Thing *thing) {
+    FaceArray faces;
+    JK_ARRAY_FROM_SPAN(faces, arena->memory.data, thing->faces);
+
+    int64_t vertex_count = 0;
+    for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+        for (int64_t i = 0; i < 3; i++) {
+            vertex_count = JK_MAX(vertex_count, faces.e[face_index].v[i] + 1);
+        }
+    }
+
+    JkVec3 min = vertices[0];
+    JkVec3 max = vertices[0];
+    for (int64_t i = 1; i < vertex_count; i++) {
+        for (int64_t j = 0; j < 3; j++) {
+            min.v[j] = JK_MIN(min.v[j], vertices[i].v[j]);
+            max.v[j] = JK_MAX(max.v[j], vertices[i].v[j]);
+        }
+    }
+    thing->bounds_center = jk_vec3_mul(0.5f, jk_vec3_add(min, max));
+    thing->bounds_radius = 0.5f * jk_vec3_magnitude(jk_vec3_sub(max, min));
+
+    JK_ARENA_SCOPE(scratch_arena) {
+        // Quadrics come from the full detail mesh and accumulate through every collapse, so
+        // coarse levels still measure error against the original surface
+        Quadric *quadrics =
+                jk_arena_push_zero(scratch_arena, vertex_count * JK_SIZEOF(*quadrics));
+        for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+            Face *face = faces.e + face_index;
+            JkVec3 cross = face_cross(vertices, face);
+            float double_area = jk_vec3_magnitude(cross);
+            if (0 < double_area) {
+                JkVec3 normal = jk_vec3_mul(1 / double_area, cross);
+                double d = -jk_vec3_dot(normal, vertices[face->v[0]]);
+                for (int64_t i = 0; i < 3; i++) {
+                    quadric_add_plane(quadrics + face->v[i], normal, d, double_area);
+                }
+            }
+        }
+
+        // A vertex is on the boundary if any of its edges isn't shared by exactly two faces. Sharp
+        // creases get extra planes through the edge, perpendicular to each face, so thin parts
+        // can't shrink by sliding their vertices along their own surface.
+        b32 *boundary = jk_arena_push_zero(scratch_arena, vertex_count * JK_SIZEOF(*boundary));
+        JK_ARENA_SCOPE(scratch_arena) {
+            Incidence incidence = incidence_build(scratch_arena, vertex_count, faces);
+            for (int64_t face_index = 0; face_index < faces.count; face_index++) {
+                Face *face = faces.e + face_index;
+                JkVec3 normal = jk_vec3_normalized(face_cross(vertices, face));
+                for (int64_t i = 0; i < 3; i++) {
+                    int32_t a = face->v[i];
+                    int32_t b = face->v[(i + 1) % 3];
+                    int64_t edge_face_count = 0;
+                    float min_dot = 1;
+                    for (int32_t j = incidence.offsets[a]; j < incidence.offsets[a + 1]; j++) {
+                        Face *other = faces.e + incidence.faces[j];
+                        if (face_has_vertex(other, b)) {
+                            edge_face_count++;
+                            JkVec3 other_normal = jk_vec3_normalized(face_cross(vertices, other));
+                            min_dot = JK_MIN(min_dot, jk_vec3_dot(normal, other_normal));
+                        }
+                    }
+                    if (edge_face_count != 2) {
+                        boundary[a] = 1;
+                        boundary[b] = 1;
+                    } else if (min_dot < LOD_CREASE_DOT_MAX) {
+                        JkVec3 edge = jk_vec3_sub(vertices[b], vertices[a]);
+                        JkVec3 plane_normal = jk_vec3_normalized(jk_vec3_cross(edge, normal));
+                        double d = -jk_vec3_dot(plane_normal, vertices[a]);
+                        double weight = jk_vec3_magnitude_sqr(edge);
+                        quadric_add_plane(quadrics + a, plane_normal, d, weight);
+                        quadric_add_plane(quadrics + b, plane_normal, d, weight);
+                    }
+                }
+            }
+        }
+
+        FaceArray level = {.count = faces.count};
+        level.e = jk_arena_push(scratch_arena, faces.count * JK_SIZEOF(*level.e));
+        jk_memcpy(level.e, faces.e, faces.count * JK_SIZEOF(*level.e));
+        double max_distance = LOD_ERROR_RELATIVE * thing->bounds_radius;
+        for (int64_t lod_index = 0; lod_index < LOD_COUNT - 1; lod_index++) {
+            int64_t target_count = JK_MAX(LOD_FACE_COUNT_MIN, level.count / 4);
+            level.count = mesh_simplify(scratch_arena,
+                    vertices,
+                    vertex_count,
+                    quadrics,
+                    boundary,
+                    level,
+                    target_count,
+                    max_distance * max_distance);
+            max_distance *= 2;
+
+            JkSpan *lod = thing->lods + lod_index;
+            lod->offset = arena->pos;
+            lod->size = level.count * JK_SIZEOF(*level.e);
+            jk_memcpy(jk_arena_push(arena, lod->size), level.e, lod->size);
+        }
+    }
+}
+
+// ---- Mesh simplification end ------------------------------------------------
+
 static ObjectId object_new(JkArenaScope objects_scope) {
     Object *object = jk_arena_push(objects_scope.arena, JK_SIZEOF(*object));
     return (ObjectId){object - (Object *)(objects_scope.arena->memory.data + objects_scope.base)};
@@ -958,6 +967,11 @@ static void process_thing(
         Object *object = object_get(objects_scope, object_id);
         if (thing->faces.size) {
             object->faces = thing->faces;
+            for (int64_t i = 0; i < LOD_COUNT - 1; i++) {
+                object->lods[i] = thing->lods[i];
+            }
+            object->bounds_center = thing->bounds_center;
+            object->bounds_radius = thing->bounds_radius;
             int64_t max_vert = 0;
             FaceArray faces;
             JK_ARRAY_FROM_SPAN(faces, objects_scope.arena->memory.data, object->faces);
@@ -968,6 +982,7 @@ static void process_thing(
             }
             object->vertices.offset = vertices_base + thing->vertices_base;
             object->vertices.size = JK_SIZEOF(JkVec3) * (max_vert + 1);
+
         }
         if (thing->texture_id) {
             object->texture_id = thing->texture_id;
@@ -1024,6 +1039,9 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
     JkArena texcoords_arena = jk_platform_arena_virtual_init(1 * JK_GIGABYTE);
     c->texcoords_arena = &texcoords_arena;
 
+    JkArena texels_arena = jk_platform_arena_virtual_init(1 * JK_GIGABYTE);
+    c->texels_arena = &texels_arena;
+
     JkArena scratch_arena = jk_platform_arena_virtual_init(1 * JK_GIGABYTE);
     c->scratch_arena = &scratch_arena;
 
@@ -1135,18 +1153,35 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
                 } break;
                 }
             }
+
+            // Debug text is small, so the finest edge level would go unused
+            jk_shapes_edges_pack(&result_arena, result_arena.memory.data, shape, 2);
         }
     }
 
     assets->textures.offset = result_arena.pos;
-    Texture *error_texture = jk_arena_push(&result_arena, JK_SIZEOF(*error_texture));
+    Texture *error_texture = jk_arena_push_zero(&result_arena, JK_SIZEOF(*error_texture));
     error_texture->bg = (JkColor){.r = 0xff, .g = 0x00, .b = 0xff, .a = 0xff};
+    // Its shapes are all transparent, so the smallest chain of zeros does
+    error_texture->pow_2 = TEXTURE_POW_2_MIN;
+    error_texture->data.size = JK_SIZEOF(JkColor) * TEXTURE_DATA_COUNT(TEXTURE_POW_2_MIN);
+    error_texture->data.offset = texels_arena.pos;
+    jk_arena_push_zero(&texels_arena, error_texture->data.size);
     c->texture_count++;
 
     process_fbx_nodes(c, file, header->first_node - file.data, 0);
 
     assets->textures.size = result_arena.pos - assets->textures.offset;
 
+    // Texture data offsets become relative to their Textures
+    int64_t texels_base = append_arena(&result_arena, &texels_arena).offset;
+    TextureArray textures;
+    JK_ARRAY_FROM_SPAN(textures, result_arena.memory.data, assets->textures);
+    for (int64_t i = 0; i < textures.count; i++) {
+        Texture *tex = textures.e + i;
+        tex->data.offset += texels_base - ((uint8_t *)tex - result_arena.memory.data);
+    }
+
     int64_t vertices_base = append_arena(&result_arena, c->verts_arena).offset;
     assets->texcoords = append_arena(&result_arena, c->texcoords_arena);
 
@@ -1184,6 +1219,9 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
         if (faces_base < result_arena.pos) {
             thing->faces.offset = faces_base;
             thing->faces.size = result_arena.pos - faces_base;
+            JkVec3 *vertices =
+                    (JkVec3 *)(result_arena.memory.data + vertices_base + thing->vertices_base);
+            lods_generate(&result_arena, &scratch_arena, vertices, thing);
         }
     }
 
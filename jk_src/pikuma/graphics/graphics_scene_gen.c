@@ -0,0 +1,479 @@
+// #jk_build single_translation_unit
+
+// #jk_build dependencies_begin
+#include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/pikuma/graphics/graphics.h>
+// #jk_build dependencies_end
+
+// Synthetic stress scenes for the rasterizer. Writes a graphics_assets blob with the same layout
+// the asset packer produces, plus a recording holding a camera path through it as clip 1.
+//
+// Every object is a square panel tessellated into a grid and bumped a little so lighting varies.
+// Panels stand in walls facing the camera, one wall per layer, each layer a little further back
+// so they overlap on screen. Panels are sized so their triangles come out at the requested size in
+// pixels at the wall's distance, which the camera path holds constant while it pans and sways.
+
+#define DEFAULT_ASSETS_FILE_PATH "graphics_assets"
+#define DEFAULT_RECORDING_FILE_PATH "recording"
+
+#define DEFAULT_OBJECT_COUNT 256
+#define DEFAULT_DEPTH 1
+#define DEFAULT_TRIANGLE_COUNT 512
+#define DEFAULT_TRIANGLE_SIZE 16.0
+#define DEFAULT_LAYER_COUNT 1
+#define DEFAULT_FRAME_COUNT 600
+#define DEFAULT_WIDTH 1920
+#define DEFAULT_HEIGHT 1080
+
+#define GENERATED_TEXTURE_COUNT 4
+
+#define WALL_DISTANCE 10.0f
+#define PANEL_SPACING 1.125f // Distance between panel centers relative to panel size
+#define LAYER_GAP 0.1f // Relative to panel size
+#define BUMP_HEIGHT 0.02f // Relative to panel size
+
+typedef enum Opt {
+    OPT_DEPTH,
+    OPT_FRAMES,
+    OPT_HEIGHT,
+    OPT_HELP,
+    OPT_LAYERS,
+    OPT_OBJECTS,
+    OPT_SEED,
+    OPT_TRIANGLES,
+    OPT_TRIANGLE_SIZE,
+    OPT_WIDTH,
+    OPT_COUNT,
+} Opt;
+
+static JkOption opts[OPT_COUNT] = {
+    {
+        .flag = 'd',
+        .long_name = "depth",
+        .arg_name = "DEPTH",
+        .description = "\n"
+                       "\t\tChain objects into hierarchies DEPTH deep, each one parented to\n"
+                       "\t\tthe one before it. Defaults to 1, meaning no parents.\n",
+    },
+    {
+        .flag = 'f',
+        .long_name = "frames",
+        .arg_name = "FRAME_COUNT",
+        .description = "\n"
+                       "\t\tLength of the camera path in frames. Defaults to 600.\n",
+    },
+    {
+        .flag = 'y',
+        .long_name = "height",
+        .arg_name = "PIXELS",
+        .description = "\n"
+                       "\t\tRender height recorded with each frame. Defaults to 1080.\n",
+    },
+    {
+        .flag = '\0',
+        .long_name = "help",
+        .arg_name = NULL,
+        .description = "\tDisplay this help text and exit.\n",
+    },
+    {
+        .flag = 'l',
+        .long_name = "layers",
+        .arg_name = "LAYER_COUNT",
+        .description = "\n"
+                       "\t\tSpread the objects over LAYER_COUNT walls, one behind the other,\n"
+                       "\t\tso each pixel is covered up to LAYER_COUNT times. Defaults to 1.\n",
+    },
+    {
+        .flag = 'n',
+        .long_name = "objects",
+        .arg_name = "OBJECT_COUNT",
+        .description = "\n"
+                       "\t\tNumber of objects in the scene. Defaults to 256.\n",
+    },
+    {
+        .flag = 's',
+        .long_name = "seed",
+        .arg_name = "SEED",
+        .description = "\n"
+                       "\t\tHashed to seed the random number generator, so any text works. The\n"
+                       "\t\tsame options and seed always produce the same files. Defaults to 0.\n",
+    },
+    {
+        .flag = 't',
+        .long_name = "triangles",
+        .arg_name = "TRIANGLE_COUNT",
+        .description = "\n"
+                       "\t\tTriangles per mesh at full detail, rounded to the nearest square\n"
+                       "\t\tgrid. Defaults to 512.\n",
+    },
+    {
+        .flag = 'z',
+        .long_name = "triangle-size",
+        .arg_name = "PIXELS",
+        .description = "\n"
+                       "\t\tLength of a triangle's short sides in pixels as seen from the\n"
+                       "\t\tcamera path. Defaults to 16.\n",
+    },
+    {
+        .flag = 'x',
+        .long_name = "width",
+        .arg_name = "PIXELS",
+        .description = "\n"
+                       "\t\tRender width recorded with each frame. Defaults to 1920.\n",
+    },
+};
+
+static JkOptionResult opt_results[OPT_COUNT] = {0};
+
+static JkOptionsParseResult opts_parse = {0};
+
+static char *program_name = "<program_name global should be overwritten with argv[0]>";
+
+static void option_parse_positive_integer(Opt opt, int32_t *value) {
+    if (opt_results[opt].present) {
+        int32_t parsed = jk_parse_positive_integer(opt_results[opt].arg);
+        if (parsed < 1) {
+            fprintf(stderr,
+                    "%s: Invalid argument for option -%c (--%s): Expected a positive integer, got "
+                    "'%s'\n",
+                    program_name,
+                    opts[opt].flag,
+                    opts[opt].long_name,
+                    opt_results[opt].arg);
+            opts_parse.usage_error = 1;
+        } else {
+            *value = parsed;
+        }
+    }
+}
+
+static float random_f32(JkRandomGeneratorU64 *generator) {
+    return (float)(jk_random_u64(generator) >> 40) * (1.0f / (1 << 24));
+}
+
+// ---- Textures begin ---------------------------------------------------------
+
+static uint8_t sdf_value(float signed_distance) {
+    return (uint8_t)jk_remap_clamped_f32(signed_distance, SDF_SPREAD, -SDF_SPREAD, 0, 255);
+}
+
+static JkColor const palette[GENERATED_TEXTURE_COUNT][3] = {
+    {{.r = 0x2e, .g = 0x4a, .b = 0x62, .a = 0xff},
+            {.r = 0xf2, .g = 0xc1, .b = 0x4e, .a = 0xff},
+            {.r = 0xe8, .g = 0xe8, .b = 0xe8, .a = 0xff}},
+    {{.r = 0x5b, .g = 0x3a, .b = 0x29, .a = 0xff},
+            {.r = 0x9b, .g = 0xc5, .b = 0x3d, .a = 0xff},
+            {.r = 0x1d, .g = 0x1d, .b = 0x1d, .a = 0xff}},
+    {{.r = 0xd9, .g = 0xd4, .b = 0xc7, .a = 0xff},
+            {.r = 0xc0, .g = 0x39, .b = 0x2b, .a = 0xff},
+            {.r = 0x29, .g = 0x80, .b = 0xb9, .a = 0xff}},
+    {{.r = 0x3c, .g = 0x3c, .b = 0x46, .a = 0xff},
+            {.r = 0xe6, .g = 0x7e, .b = 0x22, .a = 0xff},
+            {.r = 0x8e, .g = 0x44, .b = 0xad, .a = 0xff}},
+};
+
+// A disc in channel 0 and a ring around it in channel 1, sized differently per texture. The
+// remaining channels stay fully outside their shape and get transparent colors. Pushes the texels
+// onto arena, which must be the one tex is in.
+static void texture_generate(JkArena *arena, Texture *tex, int64_t index) {
+    tex->pow_2 = TEXTURE_POW_2;
+    tex->data.size = JK_SIZEOF(JkColor) * TEXTURE_DATA_COUNT(TEXTURE_POW_2);
+    JkColor *data = jk_arena_push_zero(arena, tex->data.size);
+    tex->data.offset = (uint8_t *)data - (uint8_t *)tex;
+
+    tex->bg = palette[index][0];
+    tex->colors[0] = palette[index][1];
+    tex->colors[1] = palette[index][2];
+
+    float center = TEXTURE_SIDE_LENGTH / 2.0f;
+    float disc_radius = (0.15f + 0.05f * index) * TEXTURE_SIDE_LENGTH;
+    float ring_radius = 0.4f * TEXTURE_SIDE_LENGTH;
+    float ring_half_width = (0.02f + 0.01f * index) * TEXTURE_SIDE_LENGTH;
+    for (int32_t y = 0; y < TEXTURE_SIDE_LENGTH; y++) {
+        for (int32_t x = 0; x < TEXTURE_SIDE_LENGTH; x++) {
+            JkVec2 offset = {x + 0.5f - center, y + 0.5f - center};
+            float distance = jk_sqrt_f32(offset.x * offset.x + offset.y * offset.y);
+            JkColor *texel = data + texture_morton_index(x, y);
+            texel->v[0] = sdf_value(distance - disc_radius);
+            texel->v[1] = sdf_value(JK_ABS(distance - ring_radius) - ring_half_width);
+        }
+    }
+
+    texture_mips_generate(data, TEXTURE_POW_2);
+}
+
+// ---- Textures end -----------------------------------------------------------
+
+// ---- Panel mesh begin -------------------------------------------------------
+
+static void panel_quad_push(JkArena *arena, int32_t cells, int32_t x0, int32_t z0, int32_t x1,
+        int32_t z1) {
+    int32_t corners[4] = {
+        z0 * (cells + 1) + x0,
+        z0 * (cells + 1) + x1,
+        z1 * (cells + 1) + x1,
+        z1 * (cells + 1) + x0,
+    };
+    int32_t triangles[2][3] = {{0, 1, 2}, {0, 2, 3}};
+    for (int64_t i = 0; i < 2; i++) {
+        Face *face = jk_arena_push(arena, JK_SIZEOF(*face));
+        for (int64_t j = 0; j < 3; j++) {
+            face->v[j] = corners[triangles[i][j]];
+            face->t[j] = corners[triangles[i][j]];
+        }
+    }
+}
+
+// Covers the grid with quads stride cells on a side, clipping the last row and column to the
+// edge. A stride of 1 is full detail. Each doubling of the stride is a level of detail with a
+// quarter of the faces that reuses the same vertices.
+static JkSpan panel_faces_push(JkArena *arena, int32_t cells, int32_t stride) {
+    int64_t base = arena->pos;
+    for (int32_t z = 0; z < cells; z += stride) {
+        for (int32_t x = 0; x < cells; x += stride) {
+            panel_quad_push(
+                    arena, cells, x, z, JK_MIN(x + stride, cells), JK_MIN(z + stride, cells));
+        }
+    }
+    return (JkSpan){.size = arena->pos - base, .offset = base};
+}
+
+// Local space panel in the XZ plane, centered on the origin and facing -Y
+static JkSpan panel_vertices_push(JkArena *arena,
+        JkRandomGeneratorU64 *generator,
+        int32_t cells,
+        float size) {
+    JkVec2 phase = {2 * JK_PI * random_f32(generator), 2 * JK_PI * random_f32(generator)};
+    float frequency = 2 * JK_PI * (1 + (jk_random_u64(generator) % 3));
+    int64_t base = arena->pos;
+    for (int32_t z = 0; z <= cells; z++) {
+        for (int32_t x = 0; x <= cells; x++) {
+            JkVec2 t = {(float)x / cells, (float)z / cells};
+            JkVec3 *vertex = jk_arena_push(arena, JK_SIZEOF(*vertex));
+            vertex->x = (t.x - 0.5f) * size;
+            vertex->y = BUMP_HEIGHT * size * jk_sin_f32(frequency * t.x + phase.x)
+                    * jk_sin_f32(frequency * t.y + phase.y);
+            vertex->z = (t.y - 0.5f) * size;
+        }
+    }
+    return (JkSpan){.size = arena->pos - base, .offset = base};
+}
+
+// ---- Panel mesh end ---------------------------------------------------------
+
+int32_t jk_platform_entry_point(int32_t argc, char **argv) {
+    program_name = argv[0];
+
+    // Parse command line arguments
+    int32_t object_count = DEFAULT_OBJECT_COUNT;
+    int32_t depth = DEFAULT_DEPTH;
+    int32_t triangle_count = DEFAULT_TRIANGLE_COUNT;
+    double triangle_size = DEFAULT_TRIANGLE_SIZE;
+    int32_t layer_count = DEFAULT_LAYER_COUNT;
+    int32_t frame_count = DEFAULT_FRAME_COUNT;
+    JkIntVec2 dimensions = {DEFAULT_WIDTH, DEFAULT_HEIGHT};
+    JkBuffer seed = JKS("0");
+    char *assets_file_path = DEFAULT_ASSETS_FILE_PATH;
+    char *recording_file_path = DEFAULT_RECORDING_FILE_PATH;
+    {
+        jk_options_parse(argc, argv, opts, opt_results, OPT_COUNT, &opts_parse);
+        if (opts_parse.operand_count > 2 && !opt_results[OPT_HELP].present) {
+            fprintf(stderr,
+                    "%s: Expected 0-2 operands, got %lld\n",
+                    program_name,
+                    (long long)opts_parse.operand_count);
+            opts_parse.usage_error = 1;
+        } else {
+            if (opts_parse.operand_count >= 1) {
+                assets_file_path = opts_parse.operands[0];
+            }
+            if (opts_parse.operand_count >= 2) {
+                recording_file_path = opts_parse.operands[1];
+            }
+        }
+        option_parse_positive_integer(OPT_OBJECTS, &object_count);
+        option_parse_positive_integer(OPT_DEPTH, &depth);
+        option_parse_positive_integer(OPT_TRIANGLES, &triangle_count);
+        option_parse_positive_integer(OPT_LAYERS, &layer_count);
+        option_parse_positive_integer(OPT_FRAMES, &frame_count);
+        option_parse_positive_integer(OPT_WIDTH, &dimensions.x);
+        option_parse_positive_integer(OPT_HEIGHT, &dimensions.y);
+        if (opt_results[OPT_TRIANGLE_SIZE].present) {
+            triangle_size = jk_parse_double(opt_results[OPT_TRIANGLE_SIZE].buf);
+            if (!(0 < triangle_size)) {
+                fprintf(stderr,
+                        "%s: Invalid argument for option -z (--triangle-size): Expected a positive "
+                        "number, got '%s'\n",
+                        program_name,
+                        opt_results[OPT_TRIANGLE_SIZE].arg);
+                opts_parse.usage_error = 1;
+            }
+        }
+        if (opt_results[OPT_SEED].present) {
+            seed = opt_results[OPT_SEED].buf;
+        }
+        if (opt_results[OPT_HELP].present || opts_parse.usage_error) {
+            printf("NAME\n"
+                   "\tgraphics_scene_gen - generates synthetic scenes for rasterizer benchmarks\n\n"
+                   "SYNOPSIS\n"
+                   "\tgraphics_scene_gen [-n OBJECT_COUNT] [-d DEPTH] [-t TRIANGLE_COUNT]\n"
+                   "\t\t[-z PIXELS] [-l LAYER_COUNT] [-f FRAME_COUNT] [-x PIXELS] [-y PIXELS]\n"
+                   "\t\t[-s SEED] [ASSETS_FILE] [RECORDING_FILE]\n\n"
+                   "DESCRIPTION\n"
+                   "\tgraphics_scene_gen writes a scene of textured panels to ASSETS_FILE in\n"
+                   "\tthe format graphics_assets_pack produces, and a camera path through it to\n"
+                   "\tRECORDING_FILE as clip 1. Load the recording with -r to play it back, or\n"
+                   "\thold Alt and press 1 to profile it. ASSETS_FILE defaults to\n"
+                   "\t" DEFAULT_ASSETS_FILE_PATH ". RECORDING_FILE defaults to "
+                   DEFAULT_RECORDING_FILE_PATH ".\n\n");
+            jk_options_print_help(stdout, opts, OPT_COUNT);
+            exit(opts_parse.usage_error);
+        }
+    }
+
+    JkRandomGeneratorU64 generator = jk_random_generator_new_u64(jk_buffer_hash(seed));
+
+    // Size panels so a grid cell spans triangle_size pixels at the wall's distance
+    int32_t cells = JK_MAX(1, jk_round(jk_sqrt_f32(triangle_count / 2.0f)));
+    float pixels_per_unit = 0.5f * dimensions.y / jk_tan_f32(FOV_RADIANS / 2);
+    float panel_size = (float)triangle_size * cells * WALL_DISTANCE / pixels_per_unit;
+    float spacing = PANEL_SPACING * panel_size;
+
+    int32_t layer_object_count = (object_count + layer_count - 1) / layer_count;
+    float aspect_ratio = (float)dimensions.x / dimensions.y;
+    int32_t columns =
+            JK_MAX(1, (int32_t)jk_ceil_f32(jk_sqrt_f32(layer_object_count * aspect_ratio)));
+    int32_t rows = (layer_object_count + columns - 1) / columns;
+
+    JkArena arena = jk_platform_arena_virtual_init(8 * JK_GIGABYTE);
+    JkArena scratch_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+
+    Assets *assets = jk_arena_push_zero(&arena, JK_SIZEOF(*assets));
+
+    assets->textures.offset = arena.pos;
+    Texture *error_texture = jk_arena_push_zero(&arena, JK_SIZEOF(*error_texture));
+    error_texture->bg = (JkColor){.r = 0xff, .g = 0x00, .b = 0xff, .a = 0xff};
+    Texture *textures = jk_arena_push_zero(&arena, GENERATED_TEXTURE_COUNT * JK_SIZEOF(Texture));
+    assets->textures.size = arena.pos - assets->textures.offset;
+
+    // Its shapes are all transparent, so the smallest chain of zeros does
+    error_texture->pow_2 = TEXTURE_POW_2_MIN;
+    error_texture->data.size = JK_SIZEOF(JkColor) * TEXTURE_DATA_COUNT(TEXTURE_POW_2_MIN);
+    error_texture->data.offset = arena.pos - assets->textures.offset;
+    jk_arena_push_zero(&arena, error_texture->data.size);
+    for (int64_t i = 0; i < GENERATED_TEXTURE_COUNT; i++) {
+        texture_generate(&arena, textures + i, i);
+    }
+
+    // Every panel shares the same grid, so texcoords are indexed like vertices
+    assets->texcoords.offset = arena.pos;
+    for (int32_t z = 0; z <= cells; z++) {
+        for (int32_t x = 0; x <= cells; x++) {
+            JkVec2 *texcoord = jk_arena_push(&arena, JK_SIZEOF(*texcoord));
+            *texcoord = (JkVec2){(float)x / cells, 1 - (float)z / cells};
+        }
+    }
+    assets->texcoords.size = arena.pos - assets->texcoords.offset;
+
+    // Faces are shared too. Only the vertices differ between panels.
+    JkSpan faces = panel_faces_push(&arena, cells, 1);
+    JkSpan lods[LOD_COUNT - 1];
+    for (int64_t i = 0; i < LOD_COUNT - 1; i++) {
+        lods[i] = panel_faces_push(&arena, cells, 2 << i);
+    }
+
+    JkSpan *vertices = jk_arena_push(&scratch_arena, object_count * JK_SIZEOF(*vertices));
+    for (int64_t i = 0; i < object_count; i++) {
+        vertices[i] = panel_vertices_push(&arena, &generator, cells, panel_size);
+    }
+
+    // Lay the objects out in walls, then express each one relative to its parent
+    JkVec3 *positions = jk_arena_push(&scratch_arena, object_count * JK_SIZEOF(*positions));
+    for (int64_t i = 0; i < object_count; i++) {
+        int64_t layer = i / layer_object_count;
+        int64_t index = i % layer_object_count;
+        JkVec2 jitter = {0};
+        if (layer) {
+            jitter = (JkVec2){
+                (random_f32(&generator) - 0.5f) * spacing,
+                (random_f32(&generator) - 0.5f) * spacing,
+            };
+        }
+        positions[i] = (JkVec3){
+            (index % columns - (columns - 1) / 2.0f) * spacing + jitter.x,
+            WALL_DISTANCE + layer * LAYER_GAP * panel_size,
+            PLAYER_EYE_HEIGHT + ((rows - 1) / 2.0f - index / columns) * spacing + jitter.y,
+        };
+    }
+
+    JkArenaScope objects_scope = jk_arena_scope_begin(&arena);
+    jk_arena_push_zero(&arena, JK_SIZEOF(Object)); // Push nil object
+    for (int64_t i = 0; i < object_count; i++) {
+        Object *object = jk_arena_push_zero(&arena, JK_SIZEOF(*object));
+        JkVec3 translation = positions[i];
+        if (i % depth) {
+            object->parent.i = i; // Object IDs are one past their index
+            translation = jk_vec3_sub(translation, positions[i - 1]);
+        }
+        object->transform = (JkTransform){
+            .translation = translation,
+            .rotation = jk_quat_angle_axis(0, (JkVec3){0, 0, 1}),
+            .scale = {1, 1, 1},
+        };
+        object->vertices = vertices[i];
+        object->faces = faces;
+        for (int64_t j = 0; j < LOD_COUNT - 1; j++) {
+            object->lods[j] = lods[j];
+        }
+        object->bounds_radius = (0.7072f + BUMP_HEIGHT) * panel_size; // Half diagonal plus bumps
+        object->texture_id = 1 + jk_random_u64(&generator) % GENERATED_TEXTURE_COUNT;
+    }
+    assets->objects = (JkSpan){
+        .size = arena.pos - objects_scope.base,
+        .offset = objects_scope.base,
+    };
+
+    if (!jk_platform_file_write(
+                jk_buffer_from_null_terminated(assets_file_path), jk_buffer_from_arena(&arena))) {
+        return 1;
+    }
+
+    // Sweep across the walls and sway a little so tiles don't see the same work every frame. Each
+    // frame is flagged discontinuous so playback loads its state directly.
+    JkVec2 view = {2 * WALL_DISTANCE * jk_tan_f32(FOV_RADIANS / 2) * aspect_ratio,
+            2 * WALL_DISTANCE * jk_tan_f32(FOV_RADIANS / 2)};
+    JkVec2 pan = {
+        JK_MAX(0, (columns * spacing - view.x) / 2) + 0.5f * spacing,
+        JK_MAX(0, (rows * spacing - view.y) / 2),
+    };
+    JkArena record_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    Recording *recording = jk_arena_push_zero(&record_arena, JK_SIZEOF(*recording));
+    recording->clips[1] = (Clip){.start = 0, .end = frame_count};
+    recording->frame_count = frame_count;
+    for (int64_t i = 0; i < frame_count; i++) {
+        float t = 2 * JK_PI * i / frame_count;
+        RecordedFrame *frame = jk_arena_push_zero(&record_arena, JK_SIZEOF(*frame));
+        frame->flags = JK_MASK(FRAME_DISCONTINUOUS);
+        frame->input.dimensions = dimensions;
+        frame->state = (State){
+            .flags = JK_MASK(FLAG_INITIALIZED),
+            .camera_yaw = 0.1f * jk_sin_f32(2 * t),
+            .camera_pitch = 0.05f * jk_sin_f32(3 * t),
+            .player_position = {-pan.x * jk_cos_f32(t), 0, pan.y * jk_sin_f32(2 * t)},
+        };
+    }
+    if (!jk_platform_file_write(jk_buffer_from_null_terminated(recording_file_path),
+                jk_buffer_from_arena(&record_arena))) {
+        return 1;
+    }
+
+    printf("%d objects, %d faces each (%d cells per side), panel size %.3f, %d x %d per layer\n",
+            object_count,
+            2 * cells * cells,
+            cells,
+            panel_size,
+            columns,
+            rows);
+
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include <stdio.h>
+
+// #jk_build run jk_src/pikuma/graphics/graphics_assets_pack.c
+// #jk_build single_translation_unit
+
+// #jk_build dependencies_begin
+#include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/pikuma/graphics/graphics.h>
+// #jk_build dependencies_end
+
+// Renders a fixed set of camera poses from the packed assets without a window and compares each
+// one against a stored reference image. Run with --update after an intentional visual change to
+// rewrite the references.
+
+#define REFERENCE_DIRECTORY "../jk_assets/pikuma/graphics/golden/"
+
+#define TEST_WIDTH 384
+#define TEST_HEIGHT 216
+
+// Frames rendered before the one that gets checked. The player settles onto the walkable surface
+// and the navigation cache around them gets built over the first few.
+#define WARMUP_FRAME_COUNT 4
+#define TIMED_FRAME_COUNT 8
+
+#define DEFAULT_TOLERANCE 8
+#define DEFAULT_MAX_PIXELS 32
+
+typedef struct Pose {
+    char *name;
+    int32_t sample_count;
+    float camera_yaw;
+    float camera_pitch;
+    JkVec3 player_position;
+} Pose;
+
+static Pose poses[] = {
+    {"rocks", 4, JK_PI / 2, 0, {20, 0, 0}},
+    {"rocks_aliased", 1, JK_PI / 2, 0, {20, 0, 0}},
+    {"rocks_8x", 8, JK_PI / 2, 0, {20, 0, 0}},
+    {"plane", 4, JK_PI, 0.1f, {20, 0, 0}},
+    {"wall_close", 4, JK_PI / 2, 0, {0, -20, 0}},
+    {"face_down", 4, JK_PI, -0.6f, {-20, 0, 0}},
+    {"horizon", 4, JK_PI, 0, {0, 20, 0}},
+    // The rocks' texture is an MSDF, magnified here enough to show its corners
+    {"rocks_close", 4, JK_PI / 2 + 0.5f, 0, {12, 0, 0}},
+};
+
+typedef enum Opt {
+    OPT_HELP,
+    OPT_EIGHT_LANES,
+    OPT_MAX_PIXELS,
+    OPT_PIPELINED,
+    OPT_TOLERANCE,
+    OPT_UPDATE,
+    OPT_VISIBILITY_BUFFER,
+    OPT_COUNT,
+} Opt;
+
+static JkOption opts[OPT_COUNT] = {
+    {
+        .flag = '\0',
+        .long_name = "help",
+        .arg_name = NULL,
+        .description = "\tDisplay this help text and exit.\n",
+    },
+    {
+        .flag = 'e',
+        .long_name = "eight-lanes",
+        .arg_name = NULL,
+        .description = "\n"
+                       "\t\tRasterize with the 8-lane variant even if the CPU supports AVX-512.\n"
+                       "\t\tBoth variants are checked against the same references.\n",
+    },
+    {
+        .flag = 'm',
+        .long_name = "max-pixels",
+        .arg_name = "COUNT",
+        .description = "\n"
+                       "\t\tFail a pose when more than COUNT pixels are out of tolerance.\n"
+                       "\t\tDefaults to 32.\n",
+    },
+    {
+        .flag = 'p',
+        .long_name = "pipelined",
+        .arg_name = NULL,
+        .description = "\n"
+                       "\t\tRender in pipelined mode.\n",
+    },
+    {
+        .flag = 't',
+        .long_name = "tolerance",
+        .arg_name = "LEVEL",
+        .description = "\n"
+                       "\t\tLargest difference in any color channel, out of 255, for a pixel\n"
+                       "\t\tto still match. Defaults to 8.\n",
+    },
+    {
+        .flag = 'u',
+        .long_name = "update",
+        .arg_name = NULL,
+        .description = "\n"
+                       "\t\tOverwrite the reference images with the current output instead of\n"
+                       "\t\tcomparing against them.\n",
+    },
+    {
+        .flag = 'v',
+        .long_name = "visibility-buffer",
+        .arg_name = NULL,
+        .description = "\n"
+                       "\t\tRender in visibility buffer mode.\n",
+    },
+};
+
+static JkOptionResult opt_results[OPT_COUNT] = {0};
+
+static JkOptionsParseResult opts_parse = {0};
+
+static char *program_name = "<program_name global should be overwritten with argv[0]>";
+
+static Environment env;
+
+// Packs pixels with the given row stride into a top-down 32-bit BMP. Alpha in the draw buffer is
+// 0, so it's written as opaque to match the alpha mask.
+static JkBuffer bitmap_from_pixels(JkArena *arena, JkColor *pixels, int64_t stride) {
+    int64_t data_size = JK_SIZEOF(JkColor) * TEST_WIDTH * TEST_HEIGHT;
+    JkBuffer result = jk_arena_push_buffer(arena, JK_SIZEOF(JkBitmapHeader) + data_size);
+    JkBitmapHeader *bitmap = (JkBitmapHeader *)result.data;
+    jk_memset(bitmap, 0, JK_SIZEOF(*bitmap));
+    bitmap->identifier = 0x4d42;
+    bitmap->size = result.size;
+    bitmap->data_offset = JK_SIZEOF(*bitmap);
+    bitmap->dib_header_size = 108;
+    bitmap->width = TEST_WIDTH;
+    bitmap->height = -TEST_HEIGHT;
+    bitmap->color_plane_count = 1;
+    bitmap->bits_per_pixel = 32;
+    bitmap->compression_method = 3;
+    bitmap->data_size = data_size;
+    bitmap->masks[0] = 0x00ff0000;
+    bitmap->masks[1] = 0x0000ff00;
+    bitmap->masks[2] = 0x000000ff;
+    bitmap->masks[3] = 0xff000000;
+    bitmap->color_space_type = 0x73524742; // 'sRGB' (LCS_sRGB)
+    JkColor *data = (JkColor *)(result.data + bitmap->data_offset);
+    for (int64_t y = 0; y < TEST_HEIGHT; y++) {
+        for (int64_t x = 0; x < TEST_WIDTH; x++) {
+            data[TEST_WIDTH * y + x] = pixels[stride * y + x];
+            data[TEST_WIDTH * y + x].a = 0xff;
+        }
+    }
+    return result;
+}
+
+// Returns the pixels of a BMP written by bitmap_from_pixels, or null if it doesn't match
+static JkColor *bitmap_pixels(JkBuffer file) {
+    if (file.size < JK_SIZEOF(JkBitmapHeader)) {
+        return 0;
+    }
+    JkBitmapHeader *bitmap = (JkBitmapHeader *)file.data;
+    if (bitmap->identifier != 0x4d42 || bitmap->width != TEST_WIDTH
+            || bitmap->height != -TEST_HEIGHT || bitmap->bits_per_pixel != 32
+            || file.size < bitmap->data_offset + JK_SIZEOF(JkColor) * TEST_WIDTH * TEST_HEIGHT) {
+        return 0;
+    }
+    return (JkColor *)(file.data + bitmap->data_offset);
+}
+
+static void render_frame(void) {
+    env.input = (Input){.dimensions = {TEST_WIDTH, TEST_HEIGHT}};
+    render(jk_context, &env);
+}
+
+int32_t jk_platform_entry_point(int32_t argc, char **argv) {
+    program_name = argv[0];
+
+    // Parse command line arguments
+    int32_t tolerance = DEFAULT_TOLERANCE;
+    int64_t max_pixels = DEFAULT_MAX_PIXELS;
+    {
+        jk_options_parse(argc, argv, opts, opt_results, OPT_COUNT, &opts_parse);
+        if (opts_parse.operand_count && !opt_results[OPT_HELP].present) {
+            fprintf(stderr,
+                    "%s: Expected 0 operands, got %lld\n",
+                    program_name,
+                    (long long)opts_parse.operand_count);
+            opts_parse.usage_error = 1;
+        }
+        if (opt_results[OPT_TOLERANCE].present) {
+            tolerance = jk_parse_positive_integer(opt_results[OPT_TOLERANCE].arg);
+            if (tolerance < 0 || 255 < tolerance) {
+                fprintf(stderr,
+                        "%s: Invalid argument for option -t (--tolerance): Expected an integer "
+                        "from 0 to 255, got '%s'\n",
+                        program_name,
+                        opt_results[OPT_TOLERANCE].arg);
+                opts_parse.usage_error = 1;
+            }
+        }
+        if (opt_results[OPT_MAX_PIXELS].present) {
+            max_pixels = jk_parse_positive_integer(opt_results[OPT_MAX_PIXELS].arg);
+            if (max_pixels < 0) {
+                fprintf(stderr,
+                        "%s: Invalid argument for option -m (--max-pixels): Expected a "
+                        "non-negative integer, got '%s'\n",
+                        program_name,
+                        opt_results[OPT_MAX_PIXELS].arg);
+                opts_parse.usage_error = 1;
+            }
+        }
+        if (opt_results[OPT_HELP].present || opts_parse.usage_error) {
+            printf("NAME\n"
+                   "\tgraphics_test - checks rendered frames against reference images\n\n"
+                   "SYNOPSIS\n"
+                   "\tgraphics_test [-u] [-t LEVEL] [-m COUNT] [-e] [-p] [-v]\n\n"
+                   "DESCRIPTION\n"
+                   "\tgraphics_test renders a fixed set of camera poses from graphics_assets\n"
+                   "\tat 384x216 and compares each one against its reference image in\n"
+                   "\t" REFERENCE_DIRECTORY ". For each pose it prints the\n"
+                   "\taverage frame time, how many pixels are out of tolerance, and the\n"
+                   "\tlargest channel difference. A failing pose also writes POSE_diff.bmp\n"
+                   "\tto the working directory, with mismatched pixels in red over a dimmed\n"
+                   "\tcopy of the output. Exits with the number of failing poses.\n\n");
+            jk_options_print_help(stdout, opts, OPT_COUNT);
+            exit(opts_parse.usage_error);
+        }
+    }
+
+    jk_platform_set_working_directory_to_executable_directory();
+
+    JkArena arena = jk_platform_arena_virtual_init(8 * JK_GIGABYTE);
+    env.assets = (Assets *)jk_platform_file_read_full(&arena, "graphics_assets").data;
+    if (!env.assets) {
+        fprintf(stderr, "%s: Failed to read graphics_assets\n", program_name);
+        return 1;
+    }
+    env.draw_buffer = (JkColor *)jk_platform_memory_alloc(JK_ALLOC_COMMIT, DRAW_BUFFER_SIZE).data;
+    env.estimate_cpu_frequency = jk_platform_cpu_timer_frequency_estimate;
+    env.record_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(env.nav_arenas); i++) {
+        env.nav_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    }
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(env.bin_arenas); i++) {
+        env.bin_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    }
+    env.flags = JK_MASK(ENV_FLAG_RUNNING);
+    JK_FLAG_SET(env.flags, ENV_FLAG_EIGHT_LANES, opt_results[OPT_EIGHT_LANES].present);
+    JK_FLAG_SET(env.flags, ENV_FLAG_PIPELINED, opt_results[OPT_PIPELINED].present);
+    JK_FLAG_SET(env.flags, ENV_FLAG_VISIBILITY_BUFFER, opt_results[OPT_VISIBILITY_BUFFER].present);
+
+    b32 update = opt_results[OPT_UPDATE].present;
+    if (update) {
+        jk_platform_ensure_directory_exists(REFERENCE_DIRECTORY);
+    }
+
+    int64_t frequency = jk_platform_os_timer_frequency();
+    int32_t failure_count = 0;
+    printf("%-16s %10s %10s %10s  %s\n", "pose", "ms/frame", "mismatched", "max diff", "result");
+    for (int64_t pose_index = 0; pose_index < JK_ARRAY_COUNT(poses); pose_index++) {
+        Pose *pose = poses + pose_index;
+        JkArenaScope scope = jk_arena_scope_begin(&arena);
+
+        env.sample_count = pose->sample_count;
+        env.state = (State){
+            .flags = JK_MASK(FLAG_INITIALIZED),
+            .camera_yaw = pose->camera_yaw,
+            .camera_pitch = pose->camera_pitch,
+            .player_position = pose->player_position,
+        };
+        for (int64_t i = 0; i < WARMUP_FRAME_COUNT; i++) {
+            render_frame();
+        }
+
+        // Every timed frame renders the same state, so the last one is what gets checked
+        State settled = env.state;
+        uint64_t start = jk_platform_os_timer_get();
+        for (int64_t i = 0; i < TIMED_FRAME_COUNT; i++) {
+            env.state = settled;
+            render_frame();
+        }
+        double ms_per_frame = 1000.0 * (double)(jk_platform_os_timer_get() - start)
+                / ((double)frequency * TIMED_FRAME_COUNT);
+
+        JkBuffer path = JK_FORMAT(
+                &arena, jkfn(REFERENCE_DIRECTORY), jkfn(pose->name), jkfn(".bmp"));
+        if (update) {
+            JkBuffer bitmap = bitmap_from_pixels(&arena, env.draw_buffer, DRAW_BUFFER_SIDE_LENGTH);
+            if (jk_platform_file_write(path, bitmap)) {
+                printf("%-16s %10.2f %10s %10s  updated\n", pose->name, ms_per_frame, "", "");
+            } else {
+                printf("%-16s %10.2f %10s %10s  FAILED TO WRITE\n",
+                        pose->name,
+                        ms_per_frame,
+                        "",
+                        "");
+                failure_count++;
+            }
+        } else {
+            JkColor *reference = bitmap_pixels(jk_platform_file_read(&arena, path));
+            if (!reference) {
+                printf("%-16s %10.2f %10s %10s  MISSING REFERENCE\n",
+                        pose->name,
+                        ms_per_frame,
+                        "",
+                        "");
+                failure_count++;
+            } else {
+                JkColor *diff =
+                        jk_arena_push(&arena, JK_SIZEOF(JkColor) * TEST_WIDTH * TEST_HEIGHT);
+                int64_t mismatched_count = 0;
+                int32_t max_difference = 0;
+                for (int64_t y = 0; y < TEST_HEIGHT; y++) {
+                    for (int64_t x = 0; x < TEST_WIDTH; x++) {
+                        JkColor actual = env.draw_buffer[DRAW_BUFFER_SIDE_LENGTH * y + x];
+                        JkColor expected = reference[TEST_WIDTH * y + x];
+                        int32_t difference = 0;
+                        for (int64_t channel = 0; channel < 3; channel++) {
+                            difference = JK_MAX(difference,
+                                    JK_ABS((int32_t)actual.v[channel] - expected.v[channel]));
+                        }
+                        max_difference = JK_MAX(max_difference, difference);
+                        JkColor *d = diff + TEST_WIDTH * y + x;
+                        if (tolerance < difference) {
+                            mismatched_count++;
+                            *d = (JkColor){.r = 0xff, .a = 0xff};
+                        } else {
+                            for (int64_t channel = 0; channel < 3; channel++) {
+                                d->v[channel] = actual.v[channel] / 4;
+                            }
+                            d->a = 0xff;
+                        }
+                    }
+                }
+
+                b32 passed = mismatched_count <= max_pixels;
+                printf("%-16s %10.2f %10lld %10d  %s\n",
+                        pose->name,
+                        ms_per_frame,
+                        (long long)mismatched_count,
+                        max_difference,
+                        passed ? "ok" : "FAILED");
+                if (!passed) {
+                    failure_count++;
+                    jk_platform_file_write(
+                            JK_FORMAT(&arena, jkfn(pose->name), jkfn("_diff.bmp")),
+                            bitmap_from_pixels(&arena, diff, TEST_WIDTH));
+                }
+            }
+        }
+
+        jk_arena_scope_end(scope);
+    }
+
+    if (!update) {
+        printf("\n%d of %d poses failed\n", failure_count, (int32_t)JK_ARRAY_COUNT(poses));
+    }
+
+    return failure_count;
+}
@@ -0,0 +1,14 @@
+// #jk_build run jk_src/pikuma/graphics/graphics_assets_pack.c
+// #jk_build single_translation_unit
+// #jk_build compiler_arguments -O2
+
+// #jk_build dependencies_begin
+#include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/pikuma/graphics/graphics.h>
+// #jk_build dependencies_end
+
+// graphics_test built at -O2 whatever the build mode. jk_build otherwise only builds at -O0 or -O3,
+// and -O2 is where gcc has kept 16-lane helpers out of line and lost the upper lanes of their
+// results. Run it without -e on an AVX-512 machine to cover the 16-lane rasterizer.
+
+#include "graphics_test.c"
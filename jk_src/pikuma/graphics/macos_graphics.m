@@ -155,7 +155,7 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv)
                     .data;
 
     uint8_t *memory = mmap(NULL,
-            DRAW_BUFFER_SIZE + Z_BUFFER_SIZE + sizeof(*g.env.recording),
+            DRAW_BUFFER_SIZE + sizeof(*g.env.recording),
             PROT_READ | PROT_WRITE,
             MAP_PRIVATE | MAP_ANON,
             -1,
@@ -165,9 +165,15 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv)
         exit(1);
     }
     g.env.draw_buffer = (JkColor *)memory;
-    g.env.z_buffer = (float *)(memory + DRAW_BUFFER_SIZE);
-    g.env.recording = (Recording *)(memory + DRAW_BUFFER_SIZE + Z_BUFFER_SIZE);
+    g.env.sample_count = SAMPLE_COUNT_DEFAULT;
+    g.env.recording = (Recording *)(memory + DRAW_BUFFER_SIZE);
     g.env.estimate_cpu_frequency = jk_platform_cpu_timer_frequency_estimate;
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(g.env.nav_arenas); i++) {
+        g.env.nav_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    }
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(g.env.bin_arenas); i++) {
+        g.env.bin_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+    }
 
     jk_platform_barrier_init(&g.barrier, THREAD_COUNT);
 
@@ -0,0 +1,123 @@
+#include <stdio.h>
+
+// #jk_build single_translation_unit
+
+// #jk_build dependencies_begin
+#include <jk_src/jk_lib/platform/platform.h>
+#include <jk_src/jk_shapes/jk_shapes.h>
+#include <jk_src/pikuma/graphics/graphics.h>
+// #jk_build dependencies_end
+
+// Packs a star as an MSDF at a reduced side length, the way graphics_assets_pack packs its MSDF
+// textures, and checks it against plain SDFs of the same star. Its points and notches are the kind
+// of corners MSDF exists to keep sharp.
+
+#include "svg_texture.c"
+
+#define STAR_PATH "M 32,4 L 39,24 60,24 43,37 49,58 32,45 15,58 21,37 4,24 25,24 Z"
+#define STAR_SVG "<svg><path id=\"0\" d=\"" STAR_PATH "\" /></svg>"
+
+#define MSDF_POW_2 (TEXTURE_POW_2 - 2) // Quarter side length, where a plain SDF rounds off corners
+
+static int64_t failure_count;
+
+static void fail(char *what) {
+    printf("FAIL: %s\n", what);
+    failure_count++;
+}
+
+// Bilinearly samples a channel of a texture's full-size level at p, in its texels
+static float sample(Texture *tex, JkColor *data, int32_t channel, JkVec2 p) {
+    int32_t side_length = 1 << tex->pow_2;
+    JkVec2 base = {jk_floor_f32(p.x - 0.5f), jk_floor_f32(p.y - 0.5f)};
+    JkVec2 frac = {p.x - 0.5f - base.x, p.y - 0.5f - base.y};
+    float rows[2];
+    for (int32_t dy = 0; dy < 2; dy++) {
+        int32_t y = (int32_t)JK_CLAMP(base.y + dy, 0, side_length - 1);
+        float texels[2];
+        for (int32_t dx = 0; dx < 2; dx++) {
+            int32_t x = (int32_t)JK_CLAMP(base.x + dx, 0, side_length - 1);
+            texels[dx] = data[texture_morton_index(x, y)].v[channel];
+        }
+        rows[dy] = jk_f32_lerp(texels[0], texels[1], frac.x);
+    }
+    return jk_f32_lerp(rows[0], rows[1], frac.y);
+}
+
+static float sample_median(Texture *tex, JkColor *data, JkVec2 p) {
+    float r = sample(tex, data, 0, p);
+    float g = sample(tex, data, 1, p);
+    float b = sample(tex, data, 2, p);
+    return JK_MAX(JK_MIN(r, g), JK_MIN(JK_MAX(r, g), b));
+}
+
+int32_t jk_platform_entry_point(int32_t argc, char **argv) {
+    JkArena texel_arena = jk_platform_arena_virtual_init(JK_GIGABYTE);
+
+    Texture reference;
+    Texture msdf;
+    Texture sdf;
+    if (!texture_from_svg(&reference, &texel_arena, JKS(STAR_SVG), TEXTURE_POW_2, 0)
+            || !texture_from_svg(&msdf, &texel_arena, JKS(STAR_SVG), MSDF_POW_2, 1)
+            || !texture_from_svg(&sdf, &texel_arena, JKS(STAR_SVG), MSDF_POW_2, 0)) {
+        fail("star could not be packed");
+        return 1;
+    }
+    JkColor *reference_data = (JkColor *)(texel_arena.memory.data + reference.data.offset);
+    JkColor *msdf_data = (JkColor *)(texel_arena.memory.data + msdf.data.offset);
+    JkColor *sdf_data = (JkColor *)(texel_arena.memory.data + sdf.data.offset);
+
+    if (!JK_FLAG_GET(msdf.flags, TEXTURE_FLAG_MSDF) || JK_FLAG_GET(sdf.flags, TEXTURE_FLAG_MSDF)) {
+        fail("MSDF flag doesn't match what was asked for");
+    }
+    if (msdf.data.size != JK_SIZEOF(JkColor) * TEXTURE_DATA_COUNT(MSDF_POW_2)) {
+        fail("MSDF mip chain isn't sized for its side length");
+    }
+
+    Texture extra;
+    JkBuffer two_shapes = JKS("<svg><path id=\"0\" d=\"" STAR_PATH "\" />"
+                              "<path id=\"1\" d=\"" STAR_PATH "\" /></svg>");
+    if (texture_from_svg(&extra, &texel_arena, two_shapes, MSDF_POW_2, 1)) {
+        fail("MSDF packing accepted a second shape");
+    }
+
+    // Texels farther than this from the outline by the reference must land on the same side in
+    // the MSDF. A full-size texel of distance spans 255 / (2 * SDF_SPREAD) levels, and this is one
+    // MSDF texel.
+    float const margin = (1 << (TEXTURE_POW_2 - MSDF_POW_2)) * 255 / (2 * SDF_SPREAD);
+    float scale = 1.0f / (1 << (TEXTURE_POW_2 - MSDF_POW_2));
+    int64_t side_mismatch_count = 0;
+    int64_t msdf_miss_count = 0;
+    int64_t sdf_miss_count = 0;
+    for (int32_t y = 0; y < TEXTURE_SIDE_LENGTH; y++) {
+        for (int32_t x = 0; x < TEXTURE_SIDE_LENGTH; x++) {
+            JkVec2 p = {x + 0.5f, y + 0.5f};
+            float reference_value = sample(&reference, reference_data, 0, p);
+            b32 inside = 127.5f < reference_value;
+            JkVec2 coarse = jk_vec2_mul(scale, p);
+            b32 msdf_inside = 127.5f < sample_median(&msdf, msdf_data, coarse);
+            if (margin < JK_ABS(reference_value - 127.5f) && inside != msdf_inside) {
+                side_mismatch_count++;
+            }
+            msdf_miss_count += inside != msdf_inside;
+            sdf_miss_count += inside != (127.5f < sample(&sdf, sdf_data, 0, coarse));
+        }
+    }
+    printf("%lld full-size texels misclassified by the MSDF, %lld by a plain SDF\n",
+            (long long)msdf_miss_count,
+            (long long)sdf_miss_count);
+    if (side_mismatch_count) {
+        fail("MSDF puts texels clear of the outline on the wrong side");
+    }
+    if (sdf_miss_count <= msdf_miss_count) {
+        fail("MSDF misclassifies as many texels as a plain SDF");
+    }
+
+    jk_platform_arena_virtual_release(&texel_arena);
+
+    if (failure_count) {
+        printf("%lld failures\n", (long long)failure_count);
+        return 1;
+    }
+    return 0;
+}
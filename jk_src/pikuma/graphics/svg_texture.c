@@ -0,0 +1,636 @@
+// Turns SVG documents into textures. Included by graphics_assets_pack and by msdf_test, which
+// checks the MSDF path against plain SDFs of the same shape.
+
+#define SVG_SIDE_LENGTH 64
+#define SDF_SUBPIXEL_PRECISION (1 / 64.0f)
+
+// ---- SVG begin --------------------------------------------------------------
+
+static b32 is_numeric(int c) {
+    return isdigit(c) || c == '.' || c == '-';
+}
+
+static JkFloatArray svg_parse_numbers(JkArena *arena, JkBuffer shape_string, int64_t *pos) {
+    JkFloatArray result = {.e = jk_arena_pointer_current(arena)};
+    int c;
+    while ((c = jk_buffer_character_get(shape_string, *pos)) != EOF
+            && (is_numeric(c) || jk_is_space(c) || c == ',')) {
+        if (is_numeric(c)) {
+            int64_t start = *pos;
+            while (is_numeric(jk_buffer_character_get(shape_string, *pos))) {
+                (*pos)++;
+            }
+            JkBuffer number_string = {
+                .size = *pos - start,
+                .data = shape_string.data + start,
+            };
+            float *new_number = jk_arena_push(arena, JK_SIZEOF(*new_number));
+            *new_number = (float)jk_parse_double(number_string);
+        } else {
+            (*pos)++;
+        }
+    }
+    result.count = (float *)jk_arena_pointer_current(arena) - result.e;
+    return result;
+}
+
+JkBuffer read_string(JkBuffer buffer, int64_t *cursor, int32_t delim) {
+    int64_t start = *cursor;
+    int c;
+    do {
+        c = jk_buffer_character_next(buffer, cursor);
+    } while (!(c == delim || c == JK_OOB));
+    return c == delim ? (JkBuffer){.data = buffer.data + start, .size = *cursor - start - 1}
+                      : (JkBuffer){0};
+}
+
+b32 is_xml_tag_name_character(int32_t c) {
+    c = jk_char_to_lower(c);
+    return ('a' <= c && c <= 'z') || jk_char_is_digit(c) || c == '-' || c == '_' || c == ':'
+            || c == '.';
+}
+
+b32 is_css_attribute_name_character(int32_t c) {
+    c = jk_char_to_lower(c);
+    return ('a' <= c && c <= 'z') || jk_char_is_digit(c) || c == '-' || c == '_';
+}
+
+uint8_t read_hex_byte(JkBuffer buffer, int64_t *cursor) {
+    uint8_t result = 0;
+    for (int64_t i = 0; i < 2; i++) {
+        result <<= 4;
+        int32_t c = jk_char_to_lower(jk_buffer_character_next(buffer, cursor));
+        if (!jk_char_is_hex_digit(c)) {
+            return 0;
+        }
+        result |= jk_char_hex_value(c);
+    }
+    return result;
+}
+
+b32 svg_iterate_attributes(JkBuffer svg, int64_t *cursor, JkBuffer *key, JkBuffer *value) {
+    // Key
+    jk_buffer_skip_whitespace(svg, cursor);
+    int64_t start = *cursor;
+    int32_t c;
+    while ((c = jk_buffer_character_get(svg, *cursor)) != '=' && !jk_is_space(c) && c != '"'
+            && c != '\'' && c != '/' && c != '>' && c != JK_OOB) {
+        *cursor += 1;
+    }
+    *key = (JkBuffer){.data = svg.data + start, .size = *cursor - start};
+
+    // =
+    jk_buffer_skip_whitespace(svg, cursor);
+    if (jk_buffer_character_get(svg, *cursor) != '=') {
+        return 0;
+    }
+    *cursor += 1;
+
+    // Value
+    jk_buffer_skip_whitespace(svg, cursor);
+    int32_t delim = jk_buffer_character_next(svg, cursor);
+    if (delim != '"' && delim != '\'') {
+        return 0;
+    }
+    *value = read_string(svg, cursor, delim);
+
+    return 1;
+}
+
+// Edge colors are masks of the channels an edge contributes its distance to
+typedef enum MsdfColor {
+    MSDF_YELLOW = 0x3,
+    MSDF_MAGENTA = 0x5,
+    MSDF_CYAN = 0x6,
+    MSDF_WHITE = 0x7,
+} MsdfColor;
+
+// Sine of the smallest turn between consecutive edges that counts as a corner. Flattened curves
+// turn far less than this from one edge to the next, so they keep a single color.
+#define MSDF_CORNER_SIN 0.5f
+
+// Edges store their segment sorted by y, so direction tells which end the outline reached first
+static JkVec2 msdf_edge_start(JkEdge *edge) {
+    return edge->direction < 0 ? edge->segment.p0 : edge->segment.p1;
+}
+
+static JkVec2 msdf_edge_end(JkEdge *edge) {
+    return edge->direction < 0 ? edge->segment.p1 : edge->segment.p0;
+}
+
+// Nonzero winding at p, counted with the same convention as the scanline fill
+static float msdf_winding_get(JkEdgeArray edges, JkVec2 p) {
+    float winding = 0;
+    for (int64_t i = 0; i < edges.count; i++) {
+        JkSegment2d segment = edges.e[i].segment;
+        if (segment.p0.y <= p.y && p.y < segment.p1.y
+                && jk_segment_y_intersection(segment, p.y) <= p.x) {
+            winding += edges.e[i].direction;
+        }
+    }
+    return winding;
+}
+
+// Colors the edges of each contour so the two edges meeting at a corner share only one channel.
+// The median of the three channels then follows both edges' lines right up to the corner point
+// instead of rounding it off.
+static uint8_t *msdf_edge_colors_get(JkArena *arena, JkEdgeArray edges) {
+    uint8_t *colors = jk_arena_push(arena, edges.count * sizeof(*colors));
+    JkVec2 *directions = jk_arena_push(arena, edges.count * sizeof(*directions));
+    int64_t *corners = jk_arena_push(arena, edges.count * sizeof(*corners));
+
+    for (int64_t i = 0; i < edges.count; i++) {
+        JkVec2 delta = jk_vec2_sub(msdf_edge_end(edges.e + i), msdf_edge_start(edges.e + i));
+        float length = jk_vec2_magnitude(delta);
+        directions[i] = length == 0 ? (JkVec2){0} : jk_vec2_mul(1 / length, delta);
+    }
+
+    int64_t contour_start = 0;
+    while (contour_start < edges.count) {
+        int64_t contour_end = contour_start + 1;
+        while (contour_end < edges.count) {
+            JkVec2 end = msdf_edge_end(edges.e + contour_end - 1);
+            JkVec2 start = msdf_edge_start(edges.e + contour_end);
+            if (end.x != start.x || end.y != start.y) {
+                break;
+            }
+            contour_end++;
+        }
+        int64_t count = contour_end - contour_start;
+
+        // An edge starts a corner when the outline turns sharply coming into it. Closed contours
+        // also compare their first edge against their last one.
+        JkVec2 end = msdf_edge_end(edges.e + contour_end - 1);
+        JkVec2 start = msdf_edge_start(edges.e + contour_start);
+        JkVec2 prev = {0};
+        if (end.x == start.x && end.y == start.y) {
+            for (int64_t i = contour_end - 1; i >= contour_start; i--) {
+                if (directions[i].x != 0 || directions[i].y != 0) {
+                    prev = directions[i];
+                    break;
+                }
+            }
+        }
+        int64_t corner_count = 0;
+        for (int64_t i = contour_start; i < contour_end; i++) {
+            JkVec2 dir = directions[i];
+            if (dir.x == 0 && dir.y == 0) {
+                continue;
+            }
+            if ((prev.x != 0 || prev.y != 0)
+                    && (jk_vec2_dot(prev, dir) <= 0
+                            || MSDF_CORNER_SIN < JK_ABS(jk_vec2_cross(prev, dir)))) {
+                corners[corner_count++] = i;
+            }
+            prev = dir;
+        }
+
+        if (corner_count == 0) {
+            for (int64_t i = contour_start; i < contour_end; i++) {
+                colors[i] = MSDF_WHITE;
+            }
+        } else if (corner_count == 1) {
+            // A single corner gets colors that share one channel on either side of it and blend
+            // through white along the rest of the contour
+            uint8_t const thirds[3] = {MSDF_MAGENTA, MSDF_WHITE, MSDF_YELLOW};
+            for (int64_t j = 0; j < count; j++) {
+                int64_t i = contour_start + (corners[0] - contour_start + j) % count;
+                colors[i] = thirds[3 * j / count];
+            }
+        } else {
+            // Cycle through the colors one run per corner. If the last run would match the first,
+            // use the color that matches neither it nor the run before it.
+            uint8_t const cycle[3] = {MSDF_CYAN, MSDF_MAGENTA, MSDF_YELLOW};
+            for (int64_t corner = 0; corner < corner_count; corner++) {
+                uint8_t color = cycle[corner % 3];
+                if (corner == corner_count - 1 && corner % 3 == 0) {
+                    color = MSDF_MAGENTA;
+                }
+                int64_t run_end =
+                        corner + 1 < corner_count ? corners[corner + 1] : corners[0] + count;
+                for (int64_t j = corners[corner]; j < run_end; j++) {
+                    colors[contour_start + (j - contour_start) % count] = color;
+                }
+            }
+        }
+
+        contour_start = contour_end;
+    }
+
+    return colors;
+}
+
+// Whether the inside of the shape lies to the left of each edge, as seen walking from its start to
+// its end. Pseudo-distances take their sign from this rather than assuming a contour orientation.
+static b32 *msdf_edge_sides_get(JkArena *arena, JkEdgeArray edges) {
+    b32 *inside_left = jk_arena_push(arena, edges.count * sizeof(*inside_left));
+    for (int64_t i = 0; i < edges.count; i++) {
+        JkVec2 a = msdf_edge_start(edges.e + i);
+        JkVec2 ab = jk_vec2_sub(msdf_edge_end(edges.e + i), a);
+        float length = jk_vec2_magnitude(ab);
+        if (length == 0) {
+            inside_left[i] = 0;
+            continue;
+        }
+        JkVec2 left = {-ab.y / length, ab.x / length};
+        JkVec2 probe = jk_vec2_add(
+                jk_vec2_add(a, jk_vec2_mul(0.5f, ab)), jk_vec2_mul(SDF_SUBPIXEL_PRECISION, left));
+        inside_left[i] = msdf_winding_get(edges, probe) != 0;
+    }
+    return inside_left;
+}
+
+// Writes channels 0 to 2 of an MSDF texel. Each channel picks the nearest edge carrying it, ties
+// going to the edge p faces most squarely, and stores the signed distance to that edge's line.
+// Channels with no edge within spread saturate on the side the scanline fill found p on.
+static void msdf_texel_write(JkColor *texel,
+        JkVec2 p,
+        float sign,
+        float spread,
+        JkEdgeArray edges,
+        uint8_t *edge_colors,
+        b32 *edge_inside_left,
+        int32_t *candidates,
+        int32_t candidate_count) {
+    float const tie_epsilon = 1e-4f;
+    float best_distance[3] = {jk_infinity_f32.f32, jk_infinity_f32.f32, jk_infinity_f32.f32};
+    float best_orthogonality[3] = {0};
+    int32_t best_edge[3] = {-1, -1, -1};
+
+    for (int32_t i = 0; i < candidate_count; i++) {
+        JkEdge *edge = edges.e + candidates[i];
+        JkVec2 a = msdf_edge_start(edge);
+        JkVec2 ab = jk_vec2_sub(msdf_edge_end(edge), a);
+        float length_sqr = jk_vec2_magnitude_sqr(ab);
+        if (length_sqr == 0) {
+            continue;
+        }
+        float t = JK_CLAMP(jk_vec2_dot(jk_vec2_sub(p, a), ab) / length_sqr, 0, 1);
+        JkVec2 to_p = jk_vec2_sub(p, jk_vec2_add(a, jk_vec2_mul(t, ab)));
+        float distance = jk_vec2_magnitude(to_p);
+        float orthogonality = distance == 0
+                ? 1
+                : JK_ABS(jk_vec2_cross(ab, to_p)) / (jk_sqrt_f32(length_sqr) * distance);
+
+        for (int32_t channel = 0; channel < 3; channel++) {
+            if (!((edge_colors[candidates[i]] >> channel) & 1)) {
+                continue;
+            }
+            float delta = distance - best_distance[channel];
+            if (delta < -tie_epsilon
+                    || (delta <= tie_epsilon && best_orthogonality[channel] < orthogonality)) {
+                best_distance[channel] = distance;
+                best_orthogonality[channel] = orthogonality;
+                best_edge[channel] = candidates[i];
+            }
+        }
+    }
+
+    for (int32_t channel = 0; channel < 3; channel++) {
+        float signed_distance = sign * spread;
+        if (best_distance[channel] <= spread) {
+            JkEdge *edge = edges.e + best_edge[channel];
+            JkVec2 a = msdf_edge_start(edge);
+            JkVec2 ab = jk_vec2_sub(msdf_edge_end(edge), a);
+            float perpendicular = jk_vec2_cross(ab, jk_vec2_sub(p, a)) / jk_vec2_magnitude(ab);
+            b32 inside = (0 < perpendicular) == edge_inside_left[best_edge[channel]];
+            signed_distance = inside ? -JK_ABS(perpendicular) : JK_ABS(perpendicular);
+        }
+        texel->v[channel] =
+                (uint8_t)jk_remap_clamped_f32(signed_distance, spread, -spread, 0, 255);
+    }
+}
+
+// Packs the shapes of an SVG document into tex with a side length of 1 << pow_2, pushing its mip
+// chain onto texel_arena. tex->data's offset is left relative to the start of texel_arena. With
+// msdf set, the document must have nothing but shape 0, which gets channels 0 to 2 as an MSDF.
+// Returns 0 if svg is empty or doesn't fit that.
+static b32 texture_from_svg(
+        Texture *tex, JkArena *texel_arena, JkBuffer svg, int32_t pow_2, b32 msdf) {
+    jk_memset(tex, 0, JK_SIZEOF(*tex));
+    tex->pow_2 = pow_2;
+    JK_FLAG_SET(tex->flags, TEXTURE_FLAG_MSDF, msdf);
+
+    JkBuffer shape_strings[4] = {0};
+    JkShape shapes[4] = {0};
+
+    JkArenaScope scratch = jk_arena_scratch_begin_not(texel_arena);
+
+    b32 error = 0;
+    double page_opacity = -1;
+
+    // Parse SVG data
+    JK_ARENA_SCOPE(texel_arena) {
+        if (svg.size == 0) {
+            error = 1;
+        }
+        int64_t cursor = 0;
+        while (cursor < svg.size) {
+            int first = jk_buffer_character_next(svg, &cursor);
+            switch (first) {
+            case '"':
+            case '\'': {
+                read_string(svg, &cursor, first);
+            } break;
+
+            case '<': {
+                jk_buffer_skip_whitespace(svg, &cursor);
+                int64_t tag_start = cursor;
+                while (is_xml_tag_name_character(jk_buffer_character_get(svg, cursor))) {
+                    cursor++;
+                }
+                JkBuffer tag = {.data = svg.data + tag_start, .size = cursor - tag_start};
+                if (jk_string_equal(tag, JKS("path"))) {
+                    int64_t id = -1;
+                    JkBuffer shape_string = {0};
+                    JkColor color = {.a = 0xff};
+
+                    JkBuffer key;
+                    JkBuffer value;
+                    while (svg_iterate_attributes(svg, &cursor, &key, &value)) {
+                        if (jk_string_equal(key, JKS("d"))) {
+                            shape_string = value;
+                        } else if (jk_string_equal(key, JKS("id"))) {
+                            if (value.size == 1) {
+                                int64_t num = value.data[0] - '0';
+                                if (0 <= num && num < 4) {
+                                    id = num;
+                                }
+                            }
+                        } else if (jk_string_equal(key, JKS("style"))) {
+                            int64_t style_cursor = 0;
+                            while (style_cursor < value.size) {
+                                while (!is_css_attribute_name_character(
+                                               jk_buffer_character_get(value, style_cursor))
+                                        && style_cursor < value.size) {
+                                    style_cursor++;
+                                }
+                                int64_t start = style_cursor;
+                                while (is_css_attribute_name_character(
+                                        jk_buffer_character_get(value, style_cursor))) {
+                                    style_cursor++;
+                                }
+                                JkBuffer attribute_name = {
+                                    .data = value.data + start, .size = style_cursor - start};
+
+                                jk_buffer_skip_whitespace(value, &style_cursor);
+                                if (jk_buffer_character_get(value, style_cursor) != ':') {
+                                    continue;
+                                }
+                                style_cursor++;
+                                jk_buffer_skip_whitespace(value, &style_cursor);
+
+                                if (jk_string_equal(attribute_name, JKS("fill"))) {
+                                    if (jk_buffer_character_get(value, style_cursor) != '#') {
+                                        continue;
+                                    }
+                                    style_cursor++;
+                                    color.r = read_hex_byte(value, &style_cursor);
+                                    color.g = read_hex_byte(value, &style_cursor);
+                                    color.b = read_hex_byte(value, &style_cursor);
+                                } else if (jk_string_equal(attribute_name, JKS("fill-opacity"))) {
+                                    jk_buffer_skip_whitespace(value, &style_cursor);
+                                    int64_t alpha_start = style_cursor;
+                                    while (jk_char_is_digit(
+                                                   jk_buffer_character_get(value, style_cursor))
+                                            || jk_buffer_character_get(value, style_cursor)
+                                                    == '.') {
+                                        style_cursor++;
+                                    }
+                                    JkBuffer number = {
+                                        .data = value.data + alpha_start,
+                                        .size = style_cursor - alpha_start,
+                                    };
+                                    float alpha = jk_parse_double(number);
+                                    color.a = (uint8_t)JK_CLAMP(255 * alpha, 0, 255);
+                                }
+                            }
+                        }
+                    }
+
+                    if (id != -1) {
+                        shape_strings[id] = shape_string;
+                        tex->colors[id] = color;
+                    }
+                } else if (jk_string_equal(tag, JKS("sodipodi:namedview"))) {
+                    JkBuffer key;
+                    JkBuffer value;
+                    while (svg_iterate_attributes(svg, &cursor, &key, &value)) {
+                        if (jk_string_equal(key, JKS("pagecolor"))) {
+                            int64_t value_cursor = 0;
+                            jk_buffer_skip_whitespace(value, &value_cursor);
+                            if (jk_buffer_character_get(value, value_cursor) == '#') {
+                                value_cursor++;
+                                tex->bg.r = read_hex_byte(value, &value_cursor);
+                                tex->bg.g = read_hex_byte(value, &value_cursor);
+                                tex->bg.b = read_hex_byte(value, &value_cursor);
+                                tex->bg.a = 0xff;
+                            }
+                        } else if (jk_string_equal(key, JKS("inkscape:pageopacity"))) {
+                            page_opacity = jk_parse_double(value);
+                        }
+                    }
+                }
+            } break;
+            }
+        }
+
+        if (page_opacity != -1) {
+            tex->bg.a = (uint8_t)JK_CLAMP(255 * page_opacity, 0, 255);
+        }
+
+        // Parse the path data
+        for (int32_t shape_index = 0; shape_index < 4; shape_index++) {
+            JkBuffer piece_string = shape_strings[shape_index];
+            JkShape *shape = shapes + shape_index;
+
+            shape->dimensions.x = 64.0f;
+            shape->dimensions.y = 64.0f;
+            shape->commands.offset = scratch.arena->pos;
+
+            JkVec2 prev_pos = {0};
+
+            JkVec2 first_pos = {0};
+            int64_t pos = 0;
+            int c;
+            while ((c = jk_buffer_token_character_next(piece_string, &pos)) != EOF) {
+                JkArenaScope command_scope = jk_arena_scope_begin(texel_arena);
+
+                switch (c) {
+                case 'M':
+                case 'L': {
+                    JkFloatArray numbers = svg_parse_numbers(texel_arena, piece_string, &pos);
+                    JK_ASSERT(numbers.count && numbers.count % 2 == 0);
+                    for (int64_t i = 0; i < numbers.count; i += 2) {
+                        JkShapesPenCommand *new_command =
+                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
+                        new_command->type =
+                                c == 'M' ? JK_SHAPES_PEN_COMMAND_MOVE : JK_SHAPES_PEN_COMMAND_LINE;
+                        new_command->v[0] = (JkVec2){numbers.e[i], numbers.e[i + 1]};
+                        prev_pos = new_command->v[0];
+
+                        if (c == 'M') {
+                            first_pos = new_command->v[0];
+                        }
+                    }
+                } break;
+
+                case 'H':
+                case 'V': {
+                    JkFloatArray numbers = svg_parse_numbers(texel_arena, piece_string, &pos);
+                    JK_ASSERT(numbers.count);
+                    for (int64_t i = 0; i < numbers.count; i++) {
+                        JkShapesPenCommand *new_command =
+                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
+                        new_command->type = JK_SHAPES_PEN_COMMAND_LINE;
+                        new_command->v[0] = c == 'H' ? (JkVec2){numbers.e[i], prev_pos.y}
+                                                     : (JkVec2){prev_pos.x, numbers.e[i]};
+                        prev_pos = new_command->v[0];
+                    }
+                } break;
+
+                case 'Q': {
+                    JkFloatArray numbers = svg_parse_numbers(texel_arena, piece_string, &pos);
+                    JK_ASSERT(numbers.count && numbers.count % 4 == 0);
+                    for (int64_t i = 0; i < numbers.count; i += 4) {
+                        JkShapesPenCommand *new_command =
+                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
+                        new_command->type = JK_SHAPES_PEN_COMMAND_CURVE_QUADRATIC;
+                        for (int32_t j = 0; j < 2; j++) {
+                            new_command->v[j] =
+                                    (JkVec2){numbers.e[i + (j * 2)], numbers.e[i + (j * 2) + 1]};
+                        }
+                        prev_pos = new_command->v[1];
+                    }
+                } break;
+
+                case 'C': {
+                    JkFloatArray numbers = svg_parse_numbers(texel_arena, piece_string, &pos);
+                    JK_ASSERT(numbers.count && numbers.count % 6 == 0);
+                    for (int64_t i = 0; i < numbers.count; i += 6) {
+                        JkShapesPenCommand *new_command =
+                                jk_arena_push(scratch.arena, JK_SIZEOF(*new_command));
+                        new_command->type = JK_SHAPES_PEN_COMMAND_CURVE_CUBIC;
+                        for (int32_t j = 0; j < 3; j++) {
+                            new_command->v[j] =
+                                    (JkVec2){numbers.e[i + (j * 2)], numbers.e[i + (j * 2) + 1]};
+                        }
+                        prev_pos = new_command->v[2];
+                    }
+                } break;
+
+                case 'A': {
+                    JkFloatArray numbers = svg_parse_numbers(texel_arena, piece_string, &pos);
+                    JK_ASSERT(numbers.count && numbers.count % 7 == 0);
+                    for (int64_t i = 0; i < numbers.count; i += 7) {
+                        JkShapesPenCommand *new_command =
+                                jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
+                        new_command->type = JK_SHAPES_PEN_COMMAND_ARC;
+                        new_command->arc.dimensions.x = numbers.e[i];
+                        new_command->arc.dimensions.y = numbers.e[i + 1];
+                        new_command->arc.rotation = numbers.e[i + 2] * (float)JK_PI / 180.0f;
+                        if (numbers.e[i + 3]) {
+                            new_command->arc.flags |= JK_SHAPES_ARC_FLAG_LARGE;
+                        }
+                        if (numbers.e[i + 4]) {
+                            new_command->arc.flags |= JK_SHAPES_ARC_FLAG_SWEEP;
+                        }
+                        new_command->arc.point_end.x = numbers.e[i + 5];
+                        new_command->arc.point_end.y = numbers.e[i + 6];
+                        prev_pos = new_command->arc.point_end;
+                    }
+                } break;
+
+                case 'z':
+                case 'Z': {
+                    JkShapesPenCommand *new_command =
+                            jk_arena_push_zero(scratch.arena, JK_SIZEOF(*new_command));
+                    new_command->type = JK_SHAPES_PEN_COMMAND_LINE;
+                    new_command->v[0] = first_pos;
+                } break;
+
+                default: {
+                    JK_ASSERT(0 && "Unknown SVG shape command character");
+                } break;
+                }
+
+                jk_arena_scope_end(command_scope);
+            }
+
+            shape->commands.size = scratch.arena->pos - shape->commands.offset;
+        }
+    }
+
+    if (msdf && (shape_strings[1].size || shape_strings[2].size || shape_strings[3].size)) {
+        jk_log(JK_LOG_ERROR, JKS("texture_from_svg: An MSDF texture can only have shape 0\n"));
+        error = 1;
+    }
+
+    int32_t side_length = 1 << pow_2;
+    tex->data.offset = texel_arena->pos;
+    tex->data.size = JK_SIZEOF(JkColor) * TEXTURE_DATA_COUNT(pow_2);
+    JkColor *data = jk_arena_push_zero(texel_arena, tex->data.size);
+
+    // Distances span the same fraction of the texture at every side length
+    float spread = SDF_SPREAD * side_length / TEXTURE_SIDE_LENGTH;
+    float pixels_per_unit = (float)side_length / SVG_SIDE_LENGTH;
+    for (int64_t shape_index = 0; shape_index < (msdf ? 1 : 4); shape_index++) {
+        JkArenaScope shape_scope = jk_arena_scope_begin(scratch.arena);
+
+        JkShape *shape = shapes + shape_index;
+
+        JkShapesPenCommandArray commands;
+        commands.count = shape->commands.size / JK_SIZEOF(commands.e[0]);
+        commands.e = (JkShapesPenCommand *)(scratch.arena->memory.data + shape->commands.offset);
+        JkEdgeArray edges = jk_shapes_edges_get(
+                scratch.arena, commands, (JkVec2){0}, pixels_per_unit, SDF_SUBPIXEL_PRECISION, 0);
+
+        JkIntVec2 dimensions = {side_length, side_length};
+        uint8_t *sdf = jk_arena_push(scratch.arena, side_length * side_length);
+        jk_shapes_sdf_from_edges(scratch.arena, edges, dimensions, spread, sdf, side_length);
+
+        JkShapesSdfCells cells = {0};
+        uint8_t *edge_colors = 0;
+        b32 *edge_inside_left = 0;
+        if (msdf) {
+            cells = jk_shapes_sdf_cells_get(scratch.arena, edges, dimensions, spread);
+            edge_colors = msdf_edge_colors_get(scratch.arena, edges);
+            edge_inside_left = msdf_edge_sides_get(scratch.arena, edges);
+        }
+
+        // Texture rows go from the bottom up
+        for (JkIntVec2 pos = {0}; pos.y < side_length; pos.y++) {
+            for (pos.x = 0; pos.x < side_length; pos.x++) {
+                uint8_t value = sdf[side_length * pos.y + pos.x];
+                JkColor *texel = data + texture_morton_index(pos.x, side_length - pos.y - 1);
+                if (msdf) {
+                    // The plain SDF is brighter inside the shape
+                    float sign = value < 128 ? 1 : -1;
+                    JkVec2 posf = jk_vec2_add(jk_vec2_from_i32(pos), (JkVec2){0.5f, 0.5f});
+                    int32_t cell_index = jk_shapes_sdf_cell_index_get(&cells, pos);
+                    msdf_texel_write(texel,
+                            posf,
+                            sign,
+                            spread,
+                            edges,
+                            edge_colors,
+                            edge_inside_left,
+                            cells.edge_indexes + cells.starts[cell_index],
+                            cells.starts[cell_index + 1] - cells.starts[cell_index]);
+                } else {
+                    texel->v[shape_index] = value;
+                }
+            }
+        }
+
+        jk_arena_scope_end(shape_scope);
+    }
+
+    jk_arena_scope_end(scratch);
+
+    texture_mips_generate(data, pow_2);
+
+    return !error;
+}
+
+// ---- SVG end ----------------------------------------------------------------
@@ -0,0 +1,656 @@
+// Triangle rasterization, generic over the vector width. graphics.c includes this file once per
+// width after defining the parameters below, and everything here gets a lane count suffix through
+// LANE_NAME so that the instantiations can share a translation unit.
+//
+// LANES                          Pixels per vector
+// LANE_TARGET                    Attributes every function is compiled with
+// LANE_INLINE                    Attributes of the helpers that pass vectors around. Must force
+//                                inlining for widths beyond the build's baseline (see
+//                                JK_FORCE_INLINE), so only the entry points stay out of line.
+// LANE_NAME(name)                name with the lane count suffix appended
+// F32xN, I32xN                   float and int32_t vector types
+// f32xn(op), i32xn(op)           The jk_lib function implementing op at this width
+// f32xn_from_i32xn               Conversions between the two vector types, named after their
+// f32xn_from_i32xn_reinterpret   jk_lib counterparts
+// i32xn_from_f32xn_reinterpret
+// i32xn_from_f32xn_truncate
+// I32XN_SHIFT_LEFT               Shifts by a constant bit count
+// I32XN_SHIFT_RIGHT_ZERO_FILL
+
+#define SampleInterpolants LANE_NAME(SampleInterpolants)
+#define PixelInterpolants LANE_NAME(PixelInterpolants)
+#define ColorF32xNx4 LANE_NAME(ColorF32xNx4)
+#define channel_extract LANE_NAME(channel_extract)
+#define morton_spread LANE_NAME(morton_spread)
+#define bilerp LANE_NAME(bilerp)
+#define color_broadcast LANE_NAME(color_broadcast)
+#define color_blend LANE_NAME(color_blend)
+#define TexturePalette LANE_NAME(TexturePalette)
+#define texture_palette LANE_NAME(texture_palette)
+#define pixel_shade LANE_NAME(pixel_shade)
+#define color_pack LANE_NAME(color_pack)
+#define sample_interpolants_init LANE_NAME(sample_interpolants_init)
+#define sample_interpolants_at LANE_NAME(sample_interpolants_at)
+#define lane_x_offsets LANE_NAME(lane_x_offsets)
+#define triangle_fill LANE_NAME(triangle_fill)
+#define triangle_fill_visibility LANE_NAME(triangle_fill_visibility)
+#define tile_shade LANE_NAME(tile_shade)
+
+typedef struct SampleInterpolants {
+    F32xN e[SAMPLE_INTERPOLANT_COUNT];
+} SampleInterpolants;
+
+typedef struct PixelInterpolants {
+    F32xN e[PIXEL_INTERPOLANT_COUNT];
+} PixelInterpolants;
+
+typedef struct ColorF32xNx4 {
+    F32xN e[4];
+} ColorF32xNx4;
+
+typedef struct TexturePalette {
+    ColorF32xNx4 bg;
+    ColorF32xNx4 colors[4];
+} TexturePalette;
+
+static LANE_TARGET LANE_INLINE F32xN channel_extract(I32xN color, int32_t channel_index) {
+    switch (channel_index) {
+    case 1: {
+        color = I32XN_SHIFT_RIGHT_ZERO_FILL(color, 8);
+    } break;
+
+    case 2: {
+        color = I32XN_SHIFT_RIGHT_ZERO_FILL(color, 16);
+    } break;
+
+    case 3: {
+        color = I32XN_SHIFT_RIGHT_ZERO_FILL(color, 24);
+    } break;
+
+    default: {
+    } break;
+    }
+    return f32xn_from_i32xn(i32xn(and)(color, i32xn(broadcast_i32)(0xff)));
+}
+
+// Spreads the low 8 bits of each lane into the even bits, for building Morton texel indexes
+static LANE_TARGET LANE_INLINE I32xN morton_spread(I32xN x) {
+    x = i32xn(and)(i32xn(or)(x, I32XN_SHIFT_LEFT(x, 4)), i32xn(broadcast_i32)(0x0f0f));
+    x = i32xn(and)(i32xn(or)(x, I32XN_SHIFT_LEFT(x, 2)), i32xn(broadcast_i32)(0x3333));
+    x = i32xn(and)(i32xn(or)(x, I32XN_SHIFT_LEFT(x, 1)), i32xn(broadcast_i32)(0x5555));
+    return x;
+}
+
+static LANE_TARGET LANE_INLINE F32xN bilerp(
+        I32xN *colors, int32_t channel_index, F32xN xfrac, F32xN yfrac) {
+    F32xN colorsf[4];
+    for (int64_t i = 0; i < 4; i++) {
+        colorsf[i] = channel_extract(colors[i], channel_index);
+    }
+    F32xN top = f32xn(lerp)(colorsf[0], colorsf[1], xfrac);
+    F32xN bottom = f32xn(lerp)(colorsf[2], colorsf[3], xfrac);
+    return f32xn(lerp)(top, bottom, yfrac);
+}
+
+static LANE_TARGET LANE_INLINE ColorF32xNx4 color_broadcast(JkColor color) {
+    ColorF32xNx4 result;
+    for (int64_t i = 0; i < 4; i++) {
+        result.e[i] = f32xn(broadcast)(color.v[i]);
+    }
+    result.e[3] = f32xn(div)(result.e[3], f32xn(broadcast)(255));
+    return result;
+}
+
+static LANE_TARGET LANE_INLINE void color_blend(ColorF32xNx4 *fg, ColorF32xNx4 bg) {
+    F32xN complement = f32xn(sub)(f32xn(broadcast)(1), fg->e[3]);
+    fg->e[3] = f32xn(add)(fg->e[3], f32xn(mul)(bg.e[3], complement));
+    for (int64_t i = 0; i < 3; i++) {
+        fg->e[i] = f32xn(add)(fg->e[i], f32xn(mul)(f32xn(mul)(bg.e[i], bg.e[3]), complement));
+    }
+}
+
+static LANE_TARGET LANE_INLINE TexturePalette texture_palette(Texture *texture) {
+    TexturePalette result;
+    result.bg = color_broadcast(texture->bg);
+    for (int64_t i = 0; i < 4; i++) {
+        result.colors[i] = color_broadcast(texture->colors[i]);
+    }
+    return result;
+}
+
+// Shades LANES pixels of a triangle given the depth and per-pixel interpolants at their centers.
+// Color channels come out in [0, 255] and alpha in [0, 1].
+static LANE_TARGET LANE_INLINE ColorF32xNx4 pixel_shade(TriangleSetup *setup,
+        Texture *texture,
+        TexturePalette *palette,
+        F32xN z,
+        PixelInterpolants *p_interpolants) {
+    ColorF32xNx4 pixel_color = color_broadcast((JkColor){0});
+    float *inv_deriv_z = setup->inv_deriv_z;
+    float *inv_deriv = setup->inv_deriv;
+
+    F32xN inv_z = f32xn(div)(f32xn(broadcast)(1), z);
+
+    F32xN uv[2];
+    for (int32_t axis = 0; axis < 2; axis++) {
+        uv[axis] = f32xn(mul)(p_interpolants->e[P_U + axis], inv_z);
+    }
+
+    F32xN pixel_size = f32xn(broadcast)(0);
+    for (int32_t axis = 0; axis < 2; axis++) {
+        for (int32_t tex_axis = 0; tex_axis < 2; tex_axis++) {
+            F32xN dUV = f32xn(broadcast)(inv_deriv[2 * axis + tex_axis]);
+            F32xN dZ = f32xn(broadcast)(inv_deriv_z[axis]);
+            F32xN deriv = f32xn(mul)(inv_z, f32xn(sub)(dUV, f32xn(mul)(uv[tex_axis], dZ)));
+            pixel_size = f32xn(add)(pixel_size, f32xn(abs)(deriv));
+        }
+    }
+    pixel_size = f32xn(mul)(pixel_size, f32xn(broadcast)(0.5));
+    pixel_size = f32xn(min)(pixel_size, f32xn(broadcast)(18.4f / TEXTURE_SIDE_LENGTH));
+
+    // Levels of a full-size chain that this texture's chain starts below
+    int32_t first_level = TEXTURE_POW_2 - texture->pow_2;
+
+    // Mip level is floor(log2(texels per pixel)), read off the float exponent. The level's side
+    // length is built the same way.
+    I32xN exponent = i32xn(sub_i32)(
+            I32XN_SHIFT_RIGHT_ZERO_FILL(
+                    i32xn_from_f32xn_reinterpret(f32xn(mul)(
+                            pixel_size, f32xn(broadcast)((float)(1 << texture->pow_2)))),
+                    23),
+            i32xn(broadcast_i32)(127));
+    F32xN level_float = f32xn(max)(f32xn_from_i32xn(exponent), f32xn(broadcast)(0));
+    level_float =
+            f32xn(min)(level_float, f32xn(broadcast)((float)(TEXTURE_MIP_COUNT - 1 - first_level)));
+    I32xN level = i32xn_from_f32xn_truncate(level_float);
+    F32xN side_length = f32xn_from_i32xn_reinterpret(I32XN_SHIFT_LEFT(
+            i32xn(sub_i32)(i32xn(broadcast_i32)(127 + texture->pow_2), level), 23));
+    I32xN mask = i32xn(sub_i32)(i32xn_from_f32xn_truncate(side_length), i32xn(broadcast_i32)(1));
+    I32xN level_offset = i32xn(sub_i32)(
+            i32xn_from_f32xn_reinterpret(f32xn(gather)(texture_mip_offsets + first_level, level)),
+            i32xn(broadcast_i32)(texture_mip_offsets[first_level]));
+
+    F32xN frac[2];
+    I32xN coords[2][2];
+    for (int32_t axis = 0; axis < 2; axis++) {
+        F32xN tex = f32xn(mul)(side_length, f32xn(sub)(uv[axis], f32xn(floor)(uv[axis])));
+        frac[axis] = f32xn(sub)(tex, f32xn(floor)(tex));
+        coords[axis][0] = i32xn(and)(i32xn_from_f32xn_truncate(tex), mask);
+        coords[axis][1] =
+                i32xn(and)(i32xn(add_i32)(coords[axis][0], i32xn(broadcast_i32)(1)), mask);
+        for (int32_t i = 0; i < 2; i++) {
+            coords[axis][i] = morton_spread(coords[axis][i]);
+        }
+    }
+    for (int32_t i = 0; i < 2; i++) {
+        coords[1][i] = I32XN_SHIFT_LEFT(coords[1][i], 1);
+    }
+
+    JkColor *data = texture_data_get(texture);
+    I32xN dist[4];
+    for (int32_t row_i = 0; row_i < 2; row_i++) {
+        I32xN row = i32xn(add_i32)(level_offset, coords[1][row_i]);
+        for (int32_t col_i = 0; col_i < 2; col_i++) {
+            dist[2 * row_i + col_i] = i32xn_from_f32xn_reinterpret(
+                    f32xn(gather)(data, i32xn(or)(row, coords[0][col_i])));
+        }
+    }
+
+    // An MSDF texture holds a single shape whose distance is the median of channels 0 to 2. Every
+    // texture's distances span SDF_SPREAD full-size texels, whatever its own side length.
+    b32 msdf = JK_FLAG_GET(texture->flags, TEXTURE_FLAG_MSDF);
+    F32xN spread_pixels =
+            f32xn(div)(f32xn(broadcast)(SDF_SPREAD / TEXTURE_SIDE_LENGTH), pixel_size);
+    for (int64_t channel_index = 0;
+            f32xn(any)(f32xn(less_than)(pixel_color.e[3], f32xn(broadcast)(1)))
+            && channel_index < (msdf ? 1 : 4);
+            channel_index++) {
+        F32xN distance;
+        if (msdf) {
+            F32xN r = bilerp(dist, 0, frac[0], frac[1]);
+            F32xN g = bilerp(dist, 1, frac[0], frac[1]);
+            F32xN b = bilerp(dist, 2, frac[0], frac[1]);
+            distance = f32xn(max)(f32xn(min)(r, g), f32xn(min)(f32xn(max)(r, g), b));
+        } else {
+            distance = bilerp(dist, channel_index, frac[0], frac[1]);
+        }
+        F32xN dir = f32xn(sub)(
+                f32xn(mul)(f32xn(broadcast)(2.0f / 255), distance), f32xn(broadcast)(1));
+        F32xN coverage = f32xn(add)(f32xn(broadcast)(0.5), f32xn(mul)(dir, spread_pixels));
+        coverage = f32xn(max)(coverage, f32xn(broadcast)(0));
+        coverage = f32xn(min)(coverage, f32xn(broadcast)(1));
+        ColorF32xNx4 color = palette->colors[channel_index];
+        color.e[3] = f32xn(mul)(color.e[3], coverage);
+        color_blend(&pixel_color, color);
+    }
+    if (f32xn(any)(f32xn(less_than)(pixel_color.e[3], f32xn(broadcast)(1)))) {
+        color_blend(&pixel_color, palette->bg);
+    }
+    F32xN translucent = f32xn(less_than)(pixel_color.e[3], f32xn(broadcast)(0.95));
+    if (f32xn(any)(translucent)) {
+        // Only the translucent lanes, so a pixel's color doesn't depend on its neighbors
+        F32xN inv = f32xn(blend)(f32xn(broadcast)(1),
+                f32xn(div)(f32xn(broadcast)(1), pixel_color.e[3]),
+                translucent);
+        for (int64_t i = 0; i < 3; i++) {
+            pixel_color.e[i] = f32xn(mul)(pixel_color.e[i], inv);
+        }
+    }
+    F32xN light = f32xn(blend)(f32xn(broadcast)(1),
+            f32xn(broadcast)(1.05),
+            f32xn(less_than)(f32xn(broadcast)(0.65), p_interpolants->e[P_LIGHT]));
+    light = f32xn(blend)(light,
+            f32xn(broadcast)(0.92),
+            f32xn(less_than)(p_interpolants->e[P_LIGHT], f32xn(broadcast)(-0.25)));
+    for (int64_t i = 0; i < 3; i++) {
+        pixel_color.e[i] = f32xn(mul)(pixel_color.e[i], light);
+        pixel_color.e[i] = f32xn(max)(pixel_color.e[i], f32xn(broadcast)(0));
+        pixel_color.e[i] = f32xn(min)(pixel_color.e[i], f32xn(broadcast)(255));
+    }
+
+    return pixel_color;
+}
+
+static LANE_TARGET LANE_INLINE I32xN color_pack(ColorF32xNx4 color) {
+    I32xN result = i32xn_from_f32xn_truncate(color.e[0]);
+    result = i32xn(or)(result, I32XN_SHIFT_LEFT(i32xn_from_f32xn_truncate(color.e[1]), 8));
+    result = i32xn(or)(result, I32XN_SHIFT_LEFT(i32xn_from_f32xn_truncate(color.e[2]), 16));
+    return result;
+}
+
+// Evaluates each sample's barycentrics and depth at the origin pixel, the same in every lane
+static LANE_TARGET LANE_INLINE void sample_interpolants_init(SampleInterpolants *s_interpolants_row,
+        TileSamples *samples,
+        TriangleSetup *setup,
+        JkIntVec2 origin) {
+    int32_t sample_count = samples->sample_count;
+    float (*offsets)[SAMPLE_COUNT_MAX] = sample_offsets[samples->sample_count_log2];
+
+    F32xN init_pos[2][SAMPLE_COUNT_MAX];
+    for (int64_t axis_index = 0; axis_index < 2; axis_index++) {
+        F32xN pixel_coord = f32xn(broadcast)(origin.v[axis_index]);
+        for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+            init_pos[axis_index][sample_index] = f32xn(add)(
+                    pixel_coord, f32xn(broadcast)(offsets[axis_index][sample_index]));
+        }
+    }
+
+    // Evaluate the edge functions at this tile's starting positions
+    for (int64_t i = 0; i < 3; i++) {
+        F32xN cross_wide = f32xn(broadcast)(setup->edges[i][0]);
+        F32xN x_delta_wide = f32xn(broadcast)(setup->edges[i][1]);
+        F32xN y_delta_wide = f32xn(broadcast)(setup->edges[i][2]);
+        for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+            F32xN coord =
+                    f32xn(add)(cross_wide, f32xn(mul)(x_delta_wide, init_pos[0][sample_index]));
+            coord = f32xn(add)(coord, f32xn(mul)(y_delta_wide, init_pos[1][sample_index]));
+            s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i] = coord;
+        }
+    }
+
+    F32xN barycentric_divisor_wide = f32xn(broadcast)(setup->barycentric_divisor);
+    for (int64_t i = 0; i < 3; i++) {
+        for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+            s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i] =
+                    f32xn(div)(s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i],
+                            barycentric_divisor_wide);
+            s_interpolants_row[sample_index].e[S_Z] =
+                    f32xn(add)(s_interpolants_row[sample_index].e[S_Z],
+                            f32xn(mul)(s_interpolants_row[sample_index].e[S_BARYCENTRIC_0 + i],
+                                    f32xn(broadcast)(setup->z[i])));
+        }
+    }
+}
+
+// Each lane's distance along x, in pixels, from origin_x to the vector starting at x. Interpolants
+// are stepped out by these whole-pixel distances from the row's value at the origin rather than
+// accumulated a vector at a time, so every lane width computes the same value for a pixel.
+static LANE_TARGET LANE_INLINE F32xN lane_x_offsets(int32_t x, int32_t origin_x) {
+    return f32xn(add)(f32xn(broadcast)((float)(x - origin_x)), f32xn(load)(lane_offsets));
+}
+
+static LANE_TARGET LANE_INLINE SampleInterpolants sample_interpolants_at(
+        SampleInterpolants *s_interpolants_row, F32xN x_offsets, float *x_deltas) {
+    SampleInterpolants result;
+    for (int64_t i = 0; i < SAMPLE_INTERPOLANT_COUNT; i++) {
+        result.e[i] = f32xn(add)(s_interpolants_row->e[i],
+                f32xn(mul)(x_offsets, f32xn(broadcast)(x_deltas[i])));
+    }
+    return result;
+}
+
+// Depth tests and shades a triangle's samples within bounding_box. Shading happens once per vector
+// of pixels the triangle wins any sample in, so overdraw repeats it. Returns how many vectors it
+// shaded.
+static LANE_TARGET int64_t triangle_fill(
+        TileSamples *samples, TriangleSetup *setup, Texture *texture, JkIntRect bounding_box) {
+    int64_t shade_count = 0;
+    JkIntRect bounds = jk_int_rect_intersect(bounding_box, setup->bounding_box);
+    if (!(bounds.min.x < bounds.max.x && bounds.min.y < bounds.max.y)) {
+        return shade_count;
+    }
+    JkIntVec2 origin = bounds.min;
+    bounds.min.x &= ~(LANES - 1);
+
+    TexturePalette palette = texture_palette(texture);
+
+    int32_t sample_count = samples->sample_count;
+    float alpha_step = 0.9375f / sample_count;
+
+    SampleInterpolants s_interpolants_row[SAMPLE_COUNT_MAX] = {0};
+    PixelInterpolants p_interpolants_row = {0};
+    float (*deltas)[SAMPLE_INTERPOLANT_COUNT + PIXEL_INTERPOLANT_COUNT] = setup->deltas;
+
+    sample_interpolants_init(s_interpolants_row, samples, setup, origin);
+    for (int64_t i = 0; i < 3; i++) {
+        p_interpolants_row.e[P_U] = f32xn(add)(p_interpolants_row.e[P_U],
+                f32xn(mul)(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
+                        f32xn(broadcast)(setup->t[i].x)));
+        p_interpolants_row.e[P_V] = f32xn(add)(p_interpolants_row.e[P_V],
+                f32xn(mul)(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
+                        f32xn(broadcast)(setup->t[i].y)));
+        p_interpolants_row.e[P_LIGHT] = f32xn(add)(p_interpolants_row.e[P_LIGHT],
+                f32xn(mul)(s_interpolants_row[0].e[S_BARYCENTRIC_0 + i],
+                        f32xn(broadcast)(setup->light[i])));
+    }
+
+    for (int32_t y = bounds.min.y; y < bounds.max.y; y++) {
+        for (int32_t x = bounds.min.x; x < bounds.max.x; x += LANES) {
+            int32_t pixel_index = tile_samples_index(samples, x, y);
+            F32xN x_offsets = lane_x_offsets(x, origin.x);
+            F32xN drawn_all = f32xn_from_i32xn_reinterpret(i32xn(broadcast_i32)(-1));
+            F32xN drawn_any = f32xn(zero)();
+            b32 found_color = 0;
+            ColorF32xNx4 pixel_color = color_broadcast((JkColor){0});
+            for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+                SampleInterpolants s_interpolants = sample_interpolants_at(
+                        s_interpolants_row + sample_index, x_offsets, deltas[0]);
+                F32xN outside_triangle =
+                        f32xn(to_mask)(f32xn(or)(s_interpolants.e[S_BARYCENTRIC_0],
+                                f32xn(or)(s_interpolants.e[S_BARYCENTRIC_1],
+                                        s_interpolants.e[S_BARYCENTRIC_2])));
+                F32xN should_draw = f32xn(zero)();
+                if (!f32xn(all)(outside_triangle)) {
+                    int32_t index = TILE_PIXEL_COUNT * sample_index + pixel_index;
+                    F32xN z_buffer = f32xn(load)(samples->z + index);
+                    F32xN in_front = f32xn(less_than)(z_buffer, s_interpolants.e[S_Z]);
+                    F32xN visible = f32xn(andnot)(outside_triangle, in_front);
+                    if (f32xn(any)(visible)) {
+                        f32xn(store)(samples->z + index,
+                                f32xn(blend)(z_buffer, s_interpolants.e[S_Z], visible));
+
+                        if (!found_color) {
+                            found_color = 1;
+                            // Shade at sample 0, whichever sample turned out visible first
+                            F32xN z = f32xn(add)(s_interpolants_row[0].e[S_Z],
+                                    f32xn(mul)(x_offsets, f32xn(broadcast)(deltas[0][S_Z])));
+                            PixelInterpolants p_interpolants;
+                            for (int64_t i = 0; i < PIXEL_INTERPOLANT_COUNT; i++) {
+                                p_interpolants.e[i] = f32xn(add)(p_interpolants_row.e[i],
+                                        f32xn(mul)(x_offsets,
+                                                f32xn(broadcast)(
+                                                        deltas[0][SAMPLE_INTERPOLANT_COUNT + i])));
+                            }
+                            pixel_color =
+                                    pixel_shade(setup, texture, &palette, z, &p_interpolants);
+                            shade_count++;
+                        }
+
+                        F32xN alpha_threshold = f32xn(broadcast)(alpha_step * sample_index);
+                        should_draw = f32xn(and)(
+                                visible, f32xn(less_than)(alpha_threshold, pixel_color.e[3]));
+
+                        F32xN color_buffer = f32xn(load)((float *)(samples->color + index));
+                        f32xn(store)((float *)(samples->color + index),
+                                f32xn(blend)(color_buffer,
+                                        f32xn_from_i32xn_reinterpret(color_pack(pixel_color)),
+                                        should_draw));
+                        if (samples->triangle_ids) {
+                            // Already shaded, so tile_shade must leave these samples alone
+                            F32xN ids = f32xn(load)(samples->triangle_ids + index);
+                            f32xn(store)(samples->triangle_ids + index,
+                                    f32xn(blend)(ids, f32xn(broadcast)(-1), should_draw));
+                        }
+                    }
+                }
+                drawn_all = f32xn(and)(drawn_all, should_draw);
+                drawn_any = f32xn(or)(drawn_any, should_draw);
+            }
+
+            // Every sample receives the same pixel color, so a pixel stays uniform if this
+            // triangle wrote all of its samples or none of them
+            if (f32xn(any)(drawn_any)) {
+                F32xN uniform = f32xn(load)(samples->uniform + pixel_index);
+                f32xn(store)(samples->uniform + pixel_index,
+                        f32xn(blend)(uniform, drawn_all, drawn_any));
+            }
+        }
+
+        for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+            for (int64_t i = 0; i < SAMPLE_INTERPOLANT_COUNT; i++) {
+                s_interpolants_row[sample_index].e[i] = f32xn(add)(
+                        s_interpolants_row[sample_index].e[i], f32xn(broadcast)(deltas[1][i]));
+            }
+        }
+        for (int64_t i = 0; i < PIXEL_INTERPOLANT_COUNT; i++) {
+            p_interpolants_row.e[i] = f32xn(add)(p_interpolants_row.e[i],
+                    f32xn(broadcast)(deltas[1][SAMPLE_INTERPOLANT_COUNT + i]));
+        }
+    }
+
+    return shade_count;
+}
+
+// First pass of the visibility buffer. Depth tests a triangle's samples like triangle_fill, but
+// records triangle_index in the samples it wins instead of shading them. Every sample it wins is
+// drawn, so it is only for triangles whose texture is opaque; triangle_fill handles the rest.
+static LANE_TARGET void triangle_fill_visibility(TileSamples *samples,
+        TriangleSetup *setup,
+        int32_t triangle_index,
+        JkIntRect bounding_box) {
+    JkIntRect bounds = jk_int_rect_intersect(bounding_box, setup->bounding_box);
+    if (!(bounds.min.x < bounds.max.x && bounds.min.y < bounds.max.y)) {
+        return;
+    }
+    JkIntVec2 origin = bounds.min;
+    bounds.min.x &= ~(LANES - 1);
+
+    int32_t sample_count = samples->sample_count;
+    F32xN triangle_id = f32xn(broadcast)((float)triangle_index);
+
+    SampleInterpolants s_interpolants_row[SAMPLE_COUNT_MAX] = {0};
+    float (*deltas)[SAMPLE_INTERPOLANT_COUNT + PIXEL_INTERPOLANT_COUNT] = setup->deltas;
+
+    sample_interpolants_init(s_interpolants_row, samples, setup, origin);
+
+    for (int32_t y = bounds.min.y; y < bounds.max.y; y++) {
+        for (int32_t x = bounds.min.x; x < bounds.max.x; x += LANES) {
+            int32_t pixel_index = tile_samples_index(samples, x, y);
+            F32xN x_offsets = lane_x_offsets(x, origin.x);
+            for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+                SampleInterpolants s_interpolants = sample_interpolants_at(
+                        s_interpolants_row + sample_index, x_offsets, deltas[0]);
+                F32xN outside_triangle =
+                        f32xn(to_mask)(f32xn(or)(s_interpolants.e[S_BARYCENTRIC_0],
+                                f32xn(or)(s_interpolants.e[S_BARYCENTRIC_1],
+                                        s_interpolants.e[S_BARYCENTRIC_2])));
+                if (!f32xn(all)(outside_triangle)) {
+                    int32_t index = TILE_PIXEL_COUNT * sample_index + pixel_index;
+                    F32xN z_buffer = f32xn(load)(samples->z + index);
+                    F32xN in_front = f32xn(less_than)(z_buffer, s_interpolants.e[S_Z]);
+                    F32xN visible = f32xn(andnot)(outside_triangle, in_front);
+                    if (f32xn(any)(visible)) {
+                        f32xn(store)(samples->z + index,
+                                f32xn(blend)(z_buffer, s_interpolants.e[S_Z], visible));
+                        F32xN ids = f32xn(load)(samples->triangle_ids + index);
+                        f32xn(store)(samples->triangle_ids + index,
+                                f32xn(blend)(ids, triangle_id, visible));
+                    }
+                }
+            }
+        }
+
+        for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+            for (int64_t i = 0; i < SAMPLE_INTERPOLANT_COUNT; i++) {
+                s_interpolants_row[sample_index].e[i] = f32xn(add)(
+                        s_interpolants_row[sample_index].e[i], f32xn(broadcast)(deltas[1][i]));
+            }
+        }
+    }
+}
+
+// Second pass of the visibility buffer. Shades each vector of pixels once per distinct triangle
+// left visible in it, evaluating that triangle's interpolants directly at the pixel centers.
+// Samples without a triangle keep the color already in them. Returns how many vectors it shaded.
+static LANE_TARGET int64_t tile_shade(TileSamples *samples,
+        TriangleSetupArray triangle_setups,
+        TextureArray textures,
+        JkIntRect bounding_box) {
+    int64_t shade_count = 0;
+    int32_t sample_count = samples->sample_count;
+    float (*offsets)[SAMPLE_COUNT_MAX] = sample_offsets[samples->sample_count_log2];
+    float alpha_step = 0.9375f / sample_count;
+    F32xN all_set = f32xn_from_i32xn_reinterpret(i32xn(broadcast_i32)(-1));
+
+    for (int32_t y = bounding_box.min.y; y < bounding_box.max.y; y++) {
+        F32xN pixel_y = f32xn(broadcast)(y + offsets[1][0]);
+        for (int32_t x = bounding_box.min.x; x < bounding_box.max.x; x += LANES) {
+            int32_t pixel_index = tile_samples_index(samples, x, y);
+            F32xN pixel_x = f32xn(add)(
+                    f32xn(broadcast)(x + offsets[0][0]), f32xn(load)(lane_offsets));
+
+            F32xN ids[SAMPLE_COUNT_MAX];
+            F32xN pending[SAMPLE_COUNT_MAX];
+            for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+                ids[sample_index] = f32xn(load)(
+                        samples->triangle_ids + TILE_PIXEL_COUNT * sample_index + pixel_index);
+                pending[sample_index] = f32xn(andnot)(
+                        f32xn(less_than)(ids[sample_index], f32xn(zero)()), all_set);
+            }
+
+            // Starts from what triangle_fill left for translucent triangles
+            F32xN uniform = f32xn(load)(samples->uniform + pixel_index);
+            for (;;) {
+                // Take the next triangle from the first lane still waiting on one
+                int32_t triangle_index = -1;
+                for (int64_t sample_index = 0; triangle_index == -1 && sample_index < sample_count;
+                        sample_index++) {
+                    if (f32xn(any)(pending[sample_index])) {
+                        _Alignas(64) float lane_ids[LANES];
+                        _Alignas(64) int32_t lane_pending[LANES];
+                        f32xn(store)(lane_ids, ids[sample_index]);
+                        f32xn(store)((float *)lane_pending, pending[sample_index]);
+                        for (int64_t lane = 0; triangle_index == -1 && lane < LANES; lane++) {
+                            if (lane_pending[lane]) {
+                                triangle_index = (int32_t)lane_ids[lane];
+                            }
+                        }
+                    }
+                }
+                if (triangle_index == -1) {
+                    break;
+                }
+
+                TriangleSetup *setup = triangle_setups.e + triangle_index;
+                Texture *texture = textures.e + setup->texture_id;
+                F32xN triangle_id = f32xn(broadcast)((float)triangle_index);
+                F32xN matches[SAMPLE_COUNT_MAX];
+                F32xN match_all = all_set;
+                F32xN match_any = f32xn(zero)();
+                for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+                    F32xN differs = f32xn(or)(f32xn(less_than)(ids[sample_index], triangle_id),
+                            f32xn(less_than)(triangle_id, ids[sample_index]));
+                    matches[sample_index] = f32xn(andnot)(differs, all_set);
+                    match_all = f32xn(and)(match_all, matches[sample_index]);
+                    match_any = f32xn(or)(match_any, matches[sample_index]);
+                    pending[sample_index] =
+                            f32xn(andnot)(matches[sample_index], pending[sample_index]);
+                }
+
+                F32xN barycentrics[3];
+                F32xN barycentric_divisor_wide = f32xn(broadcast)(setup->barycentric_divisor);
+                for (int64_t i = 0; i < 3; i++) {
+                    F32xN coord = f32xn(add)(f32xn(broadcast)(setup->edges[i][0]),
+                            f32xn(mul)(f32xn(broadcast)(setup->edges[i][1]), pixel_x));
+                    coord = f32xn(add)(
+                            coord, f32xn(mul)(f32xn(broadcast)(setup->edges[i][2]), pixel_y));
+                    barycentrics[i] = f32xn(div)(coord, barycentric_divisor_wide);
+                }
+                F32xN z = f32xn(zero)();
+                PixelInterpolants p_interpolants = {0};
+                for (int64_t i = 0; i < 3; i++) {
+                    z = f32xn(add)(z, f32xn(mul)(barycentrics[i], f32xn(broadcast)(setup->z[i])));
+                    p_interpolants.e[P_U] = f32xn(add)(p_interpolants.e[P_U],
+                            f32xn(mul)(barycentrics[i], f32xn(broadcast)(setup->t[i].x)));
+                    p_interpolants.e[P_V] = f32xn(add)(p_interpolants.e[P_V],
+                            f32xn(mul)(barycentrics[i], f32xn(broadcast)(setup->t[i].y)));
+                    p_interpolants.e[P_LIGHT] = f32xn(add)(p_interpolants.e[P_LIGHT],
+                            f32xn(mul)(barycentrics[i], f32xn(broadcast)(setup->light[i])));
+                }
+
+                TexturePalette palette = texture_palette(texture);
+                ColorF32xNx4 pixel_color =
+                        pixel_shade(setup, texture, &palette, z, &p_interpolants);
+                F32xN color_packed = f32xn_from_i32xn_reinterpret(color_pack(pixel_color));
+                shade_count++;
+
+                F32xN drawn_all = all_set;
+                F32xN drawn_any = f32xn(zero)();
+                for (int64_t sample_index = 0; sample_index < sample_count; sample_index++) {
+                    int32_t index = TILE_PIXEL_COUNT * sample_index + pixel_index;
+                    F32xN alpha_threshold = f32xn(broadcast)(alpha_step * sample_index);
+                    F32xN should_draw = f32xn(and)(matches[sample_index],
+                            f32xn(less_than)(alpha_threshold, pixel_color.e[3]));
+                    F32xN color_buffer = f32xn(load)((float *)(samples->color + index));
+                    f32xn(store)((float *)(samples->color + index),
+                            f32xn(blend)(color_buffer, color_packed, should_draw));
+                    drawn_all = f32xn(and)(drawn_all, should_draw);
+                    drawn_any = f32xn(or)(drawn_any, should_draw);
+                }
+
+                // A pixel split between triangles, or only partly drawn by this one, needs
+                // averaging in resolve
+                uniform = f32xn(andnot)(f32xn(andnot)(match_all, match_any), uniform);
+                uniform = f32xn(andnot)(f32xn(andnot)(drawn_all, drawn_any), uniform);
+            }
+
+            f32xn(store)(samples->uniform + pixel_index, uniform);
+        }
+    }
+
+    return shade_count;
+}
+
+#undef SampleInterpolants
+#undef PixelInterpolants
+#undef ColorF32xNx4
+#undef channel_extract
+#undef morton_spread
+#undef bilerp
+#undef color_broadcast
+#undef color_blend
+#undef TexturePalette
+#undef texture_palette
+#undef pixel_shade
+#undef color_pack
+#undef sample_interpolants_init
+#undef sample_interpolants_at
+#undef lane_x_offsets
+#undef triangle_fill
+#undef triangle_fill_visibility
+#undef tile_shade
+
+#undef LANES
+#undef LANE_TARGET
+#undef LANE_INLINE
+#undef LANE_NAME
+#undef F32xN
+#undef I32xN
+#undef f32xn
+#undef i32xn
+#undef f32xn_from_i32xn
+#undef f32xn_from_i32xn_reinterpret
+#undef i32xn_from_f32xn_reinterpret
+#undef i32xn_from_f32xn_truncate
+#undef I32XN_SHIFT_LEFT
+#undef I32XN_SHIFT_RIGHT_ZERO_FILL
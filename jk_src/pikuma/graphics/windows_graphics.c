@@ -20,6 +20,22 @@
 #define THREAD_COUNT 8
 #define FRAME_RATE 60
 #define MOUSE_SENSITIVITY 0.6f
+#define CAPTURE_SLOT_COUNT 4
+
+// Frames on their way to the capture file. The app thread copies each frame into the slot at head
+// and the writer thread drains slots from tail, so capturing costs the frame a single copy. When
+// the writer falls behind, frames are dropped rather than stalling the render loop. Each BMP's
+// reserved field holds its frame index, counting dropped frames, so gaps show where drops were.
+typedef struct Capture {
+    HANDLE file;
+    HANDLE thread;
+    HANDLE filled_semaphore;
+    uint8_t *slots[CAPTURE_SLOT_COUNT]; // JkBitmapHeader followed by pixels
+    volatile LONG64 head;
+    volatile LONG64 tail;
+    int64_t frame_index;
+    int64_t dropped_count;
+} Capture;
 
 typedef struct Global {
     JkArena arena;
@@ -39,6 +55,8 @@ typedef struct Global {
     _Alignas(64) SRWLOCK mouse_lock;
     _Alignas(64) JkMouse mouse;
     HCURSOR cursor;
+
+    _Alignas(64) Capture capture;
 } Global;
 
 static Global g = {.keyboard_lock = SRWLOCK_INIT};
@@ -98,6 +116,108 @@ static void copy_draw_buffer_to_window(HWND window, HDC device_context) {
             SRCCOPY);
 }
 
+// ---- Capture begin ----------------------------------------------------------
+
+static DWORD capture_thread(LPVOID param) {
+    Capture *c = &g.capture;
+    for (;;) {
+        WaitForSingleObject(c->filled_semaphore, INFINITE);
+        if (c->tail == c->head) {
+            return 0; // Woken to shut down with nothing left to write
+        }
+        uint8_t *slot = c->slots[c->tail % CAPTURE_SLOT_COUNT];
+        DWORD size = ((JkBitmapHeader *)slot)->size;
+        DWORD written;
+        if (!WriteFile(c->file, slot, size, &written, 0) || written != size) {
+            jk_log(JK_LOG_ERROR, JKS("Failed to write captured frame\n"));
+        }
+        InterlockedIncrement64(&c->tail);
+    }
+}
+
+// Logs and returns 0 if capturing can't be set up
+static b32 capture_begin(char *path) {
+    Capture *c = &g.capture;
+    c->file = CreateFileA(path, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (c->file == INVALID_HANDLE_VALUE) {
+        c->file = 0;
+        JK_LOGF(JK_LOG_FATAL, jkfn("Failed to open capture file '"), jkfn(path), jkfn("'"));
+        return 0;
+    }
+    for (int64_t i = 0; i < CAPTURE_SLOT_COUNT; i++) {
+        c->slots[i] = VirtualAlloc(
+                0, JK_SIZEOF(JkBitmapHeader) + DRAW_BUFFER_SIZE, MEM_COMMIT, PAGE_READWRITE);
+        if (!c->slots[i]) {
+            jk_log(JK_LOG_FATAL, JKS("Failed to allocate capture buffers\n"));
+            CloseHandle(c->file);
+            c->file = 0;
+            return 0;
+        }
+    }
+    c->filled_semaphore = CreateSemaphoreA(0, 0, CAPTURE_SLOT_COUNT + 1, 0);
+    c->thread = c->filled_semaphore ? CreateThread(0, 0, capture_thread, 0, 0, 0) : 0;
+    if (!c->thread) {
+        jk_log(JK_LOG_FATAL, JKS("Failed to start capture thread\n"));
+        CloseHandle(c->file);
+        c->file = 0;
+        return 0;
+    }
+    return 1;
+}
+
+// Appends the frame to the capture file as a top-down 32-bit BMP
+static void capture_frame(void) {
+    Capture *c = &g.capture;
+    int64_t frame_index = c->frame_index++;
+    if (CAPTURE_SLOT_COUNT <= c->head - c->tail) {
+        c->dropped_count++;
+        return;
+    }
+
+    JkIntVec2 dimensions = g.env.input.dimensions;
+    int64_t row_size = JK_SIZEOF(JkColor) * dimensions.x;
+    uint8_t *slot = c->slots[c->head % CAPTURE_SLOT_COUNT];
+    JkBitmapHeader *bitmap = (JkBitmapHeader *)slot;
+    jk_memset(bitmap, 0, JK_SIZEOF(*bitmap));
+    bitmap->identifier = 0x4d42;
+    bitmap->size = JK_SIZEOF(*bitmap) + row_size * dimensions.y;
+    bitmap->reserved = (uint32_t)frame_index;
+    bitmap->data_offset = JK_SIZEOF(*bitmap);
+    bitmap->dib_header_size = 108;
+    bitmap->width = dimensions.x;
+    bitmap->height = -dimensions.y;
+    bitmap->color_plane_count = 1;
+    bitmap->bits_per_pixel = 32;
+    bitmap->compression_method = 3;
+    bitmap->data_size = row_size * dimensions.y;
+    bitmap->masks[0] = 0x00ff0000;
+    bitmap->masks[1] = 0x0000ff00;
+    bitmap->masks[2] = 0x000000ff;
+    bitmap->masks[3] = 0; // The draw buffer's alpha is always 0, so mark the image opaque
+    bitmap->color_space_type = 0x73524742; // 'sRGB' (LCS_sRGB)
+    uint8_t *pixels = slot + bitmap->data_offset;
+    for (int64_t y = 0; y < dimensions.y; y++) {
+        jk_memcpy(pixels + row_size * y, g.env.draw_buffer + DRAW_BUFFER_SIDE_LENGTH * y, row_size);
+    }
+
+    InterlockedIncrement64(&c->head);
+    ReleaseSemaphore(c->filled_semaphore, 1, 0);
+}
+
+static void capture_end(void) {
+    Capture *c = &g.capture;
+    ReleaseSemaphore(c->filled_semaphore, 1, 0);
+    WaitForSingleObject(c->thread, INFINITE);
+    CloseHandle(c->file);
+    JK_LOGF(JK_LOG_INFO,
+            jkfn("Captured "),
+            jkfi(c->head),
+            jkfn(" frames, dropped "),
+            jkfi(c->dropped_count));
+}
+
+// ---- Capture end ------------------------------------------------------------
+
 // clang-format off
 static JkKey make_code_map[] = {
     0x00, 0x29, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23,
@@ -393,6 +513,10 @@ static DWORD app_thread_main(LPVOID param) {
         g.render(jk_context, &g.env);
         jk_channel_sync();
 
+        if (g.capture.file) {
+            capture_frame();
+        }
+
         time++;
 
         uint64_t counter_work = jk_platform_os_timer_get();
@@ -487,6 +611,11 @@ static DWORD app_thread_auxiliary(LPVOID param) {
 
 typedef enum Option {
     OPT_RECORDING,
+    OPT_SAMPLES,
+    OPT_PIPELINED,
+    OPT_DYNAMIC_RESOLUTION,
+    OPT_VISIBILITY_BUFFER,
+    OPT_CAPTURE,
     OPT_COUNT,
 } Option;
 
@@ -497,6 +626,37 @@ static JkOption opts[OPT_COUNT] = {
         .arg_name = "FILE",
         .description = "Load a recording from FILE",
     },
+    {
+        .flag = 's',
+        .long_name = "samples",
+        .arg_name = "COUNT",
+        .description = "Number of MSAA samples per pixel: 1, 2, 4 (default), or 8",
+    },
+    {
+        .flag = 'p',
+        .long_name = "pipelined",
+        .description = "Bin the next frame while rasterizing the current one, adding a frame of "
+                       "latency",
+    },
+    {
+        .flag = 'd',
+        .long_name = "dynamic-resolution",
+        .description = "Lower the render resolution and MSAA samples as needed to hold the frame "
+                       "rate, logging the choice each frame",
+    },
+    {
+        .flag = 'v',
+        .long_name = "visibility-buffer",
+        .description = "Rasterize triangle IDs and depth first, then shade each visible pixel once",
+    },
+    {
+        .flag = 'c',
+        .long_name = "capture",
+        .arg_name = "FILE",
+        .description = "Append every frame to FILE as a BMP image, writing on a background thread. "
+                       "Frames are dropped if the disk can't keep up. Each BMP's reserved header "
+                       "field holds its frame index.",
+    },
 };
 
 static JkOptionResult opt_results[OPT_COUNT];
@@ -521,13 +681,33 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
     g.env.assets = (Assets *)jk_platform_file_read_full(&g.arena, "graphics_assets").data;
 #endif
 
-    uint8_t *memory = VirtualAlloc(0, DRAW_BUFFER_SIZE + Z_BUFFER_SIZE, MEM_COMMIT, PAGE_READWRITE);
+    uint8_t *memory = VirtualAlloc(0, DRAW_BUFFER_SIZE, MEM_COMMIT, PAGE_READWRITE);
     if (!memory) {
         jk_log(JK_LOG_FATAL, JKS("Failed to allocate memory\n"));
         exit(1);
     }
     g.env.draw_buffer = (JkColor *)memory;
-    g.env.z_buffer = (float *)(memory + DRAW_BUFFER_SIZE);
+
+    g.env.sample_count = SAMPLE_COUNT_DEFAULT;
+    if (opt_results[OPT_SAMPLES].present) {
+        int32_t sample_count = jk_parse_positive_integer(opt_results[OPT_SAMPLES].arg);
+        if (sample_count == 1 || sample_count == 2 || sample_count == 4 || sample_count == 8) {
+            g.env.sample_count = sample_count;
+        } else {
+            JK_LOGF(JK_LOG_ERROR,
+                    jkfn("Invalid argument for option -s (--samples): Expected 1, 2, 4, or 8, "
+                         "got '"),
+                    jkfn(opt_results[OPT_SAMPLES].arg),
+                    jkfn("'"));
+        }
+    }
+    JK_FLAG_SET(g.env.flags, ENV_FLAG_PIPELINED, opt_results[OPT_PIPELINED].present);
+    JK_FLAG_SET(g.env.flags,
+            ENV_FLAG_DYNAMIC_RESOLUTION,
+            opt_results[OPT_DYNAMIC_RESOLUTION].present);
+    JK_FLAG_SET(g.env.flags,
+            ENV_FLAG_VISIBILITY_BUFFER,
+            opt_results[OPT_VISIBILITY_BUFFER].present);
     g.env.estimate_cpu_frequency = jk_platform_cpu_timer_frequency_estimate;
 
     g.env.record_arena = jk_platform_arena_virtual_init(32 * JK_GIGABYTE);
@@ -535,6 +715,20 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
         jk_log(JK_LOG_FATAL, JKS("Failed to initialize arena\n"));
         exit(1);
     }
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(g.env.nav_arenas); i++) {
+        g.env.nav_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+        if (!g.env.nav_arenas[i].memory.size) {
+            jk_log(JK_LOG_FATAL, JKS("Failed to initialize arena\n"));
+            exit(1);
+        }
+    }
+    for (int64_t i = 0; i < JK_ARRAY_COUNT(g.env.bin_arenas); i++) {
+        g.env.bin_arenas[i] = jk_platform_arena_virtual_init(JK_GIGABYTE);
+        if (!g.env.bin_arenas[i].memory.size) {
+            jk_log(JK_LOG_FATAL, JKS("Failed to initialize arena\n"));
+            exit(1);
+        }
+    }
 
     if (opt_results[OPT_RECORDING].present && opt_results[OPT_RECORDING].buf.size) {
         JK_DEBUG_ASSERT(g.env.record_arena.pos == 0);
@@ -542,6 +736,10 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
         JK_DEBUG_ASSERT((g.env.record_arena.pos - sizeof(Recording)) % sizeof(RecordedFrame) == 0);
     }
 
+    if (opt_results[OPT_CAPTURE].present && !capture_begin(opt_results[OPT_CAPTURE].arg)) {
+        exit(1);
+    }
+
     WNDCLASSA window_class = {
         .style = CS_OWNDC | CS_HREDRAW | CS_VREDRAW,
         .lpfnWndProc = window_proc,
@@ -622,6 +820,10 @@ int32_t jk_platform_entry_point(int32_t argc, char **argv) {
         jk_log(JK_LOG_FATAL, JKS("CreateWindowExA failed\n"));
     }
 
+    if (g.capture.file) {
+        capture_end();
+    }
+
     JkBuffer recording = jk_buffer_from_arena(&g.env.record_arena);
     if (JK_SIZEOF(Recording) < recording.size) {
         jk_platform_file_write(JKS("recording"), recording);